@@ -12,16 +12,15 @@
 #include "../../lib/BattleState.h"
 
 const TBonusListPtr StackWithBonuses::getAllBonuses(const CSelector &selector, const CSelector &limit,
-						    const CBonusSystemNode *root /*= nullptr*/, const std::string &cachingStr /*= ""*/) const
+						    const CBonusSystemNode *root /*= nullptr*/, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
-	TBonusListPtr ret = std::make_shared<BonusList>();
-	const TBonusListPtr originalList = stack->getAllBonuses(selector, limit, root, cachingStr);
+	TBonusListPtr ret = CBonusPool::makeList();
+	const TBonusListPtr originalList = stack->getAllBonuses(selector, limit, root, cachingKey);
 	range::copy(*originalList, std::back_inserter(*ret));
 	for(auto &bonus : bonusesToAdd)
 	{
-		auto b = std::make_shared<Bonus>(bonus);
-		if(selector(b.get())  &&  (!limit || !limit(b.get())))
-			ret->push_back(b);
+		if(selector(&bonus)  &&  (!limit || !limit(&bonus)))
+			ret->push_back(CBonusPool::makeBonus(bonus));
 	}
 	//TODO limiters?
 	return ret;
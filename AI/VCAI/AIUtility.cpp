@@ -181,13 +181,13 @@ std::string strFromInt3(int3 pos)
 
 bool CDistanceSorter::operator ()(const CGObjectInstance *lhs, const CGObjectInstance *rhs)
 {
-	const CGPathNode *ln = ai->myCb->getPathsInfo(hero)->getPathInfo(lhs->visitablePos()),
-	                 *rn = ai->myCb->getPathsInfo(hero)->getPathInfo(rhs->visitablePos());
+	const CGPathNode ln = ai->myCb->getPathsInfo(hero)->getPathInfo(lhs->visitablePos()),
+	                 rn = ai->myCb->getPathsInfo(hero)->getPathInfo(rhs->visitablePos());
 
-	if(ln->turns != rn->turns)
-		return ln->turns < rn->turns;
+	if(ln.turns != rn.turns)
+		return ln.turns < rn.turns;
 
-	return (ln->moveRemains > rn->moveRemains);
+	return (ln.moveRemains > rn.moveRemains);
 }
 
 bool compareMovement(HeroPtr lhs, HeroPtr rhs)
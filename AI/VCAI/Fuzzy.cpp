@@ -6,6 +6,7 @@
 #include "../../lib/mapObjects/CommonConstructors.h"
 #include "../../lib/CCreatureHandler.h"
 #include "../../lib/CPathfinder.h"
+#include "../../lib/CHierarchicalPathfinder.h"
 #include "../../lib/CGameStateFwd.h"
 #include "../../lib/VCMI_Lib.h"
 #include "../../CCallback.h"
@@ -422,7 +423,10 @@ float FuzzyHelper::evaluate (Goals::VisitTile & g)
 
 	//assert(cb->isInTheMap(g.tile));
 	float turns = 0;
-	float distance = CPathfinderHelper::getMovementCost(g.hero.h, g.tile);
+	/// Tile may be far away, so estimate distance using clusters instead of running pathfinder for every goal
+	float distance = ai->getHierarchicalPathfinder()->getDistance(g.hero->visitablePos(), g.tile);
+	if(distance < 0) //no known way, likely tile is on fog of war border
+		distance = CPathfinderHelper::getMovementCost(g.hero.h, g.tile);
 	if (!distance) //we stand on that tile
 		turns = 0;
 	else
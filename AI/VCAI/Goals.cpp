@@ -908,18 +908,6 @@ TSubgoal GatherTroops::whatToDoToAchieve()
 	{
 		typedef std::map<const CGHeroInstance *, const CGDwelling *> TDwellMap;
 
-		// sorted helper
-		auto comparator = [](const TDwellMap::value_type & a, const TDwellMap::value_type & b) -> bool
-		{
-			const CGPathNode *ln = ai->myCb->getPathsInfo(a.first)->getPathInfo(a.second->visitablePos()),
-			                 *rn = ai->myCb->getPathsInfo(b.first)->getPathInfo(b.second->visitablePos());
-
-			if(ln->turns != rn->turns)
-				return ln->turns < rn->turns;
-
-			return (ln->moveRemains > rn->moveRemains);
-		};
-
 		// for all owned heroes generate map <hero -> nearest dwelling>
 		TDwellMap nearestDwellings;
 		for (const CGHeroInstance * hero : cb->getHeroesInfo(true))
@@ -927,6 +915,25 @@ TSubgoal GatherTroops::whatToDoToAchieve()
 			nearestDwellings[hero] = *boost::range::min_element(dwellings, CDistanceSorter(hero));
 		}
 
+		// client keeps paths of one hero only, so query every hero once instead of switching between them in comparator
+		std::map<const CGHeroInstance *, CGPathNode> nodes;
+		for (auto & elem : nearestDwellings)
+		{
+			nodes.insert(std::make_pair(elem.first, ai->myCb->getPathsInfo(elem.first)->getPathInfo(elem.second->visitablePos())));
+		}
+
+		// sorted helper
+		auto comparator = [&](const TDwellMap::value_type & a, const TDwellMap::value_type & b) -> bool
+		{
+			const CGPathNode & ln = nodes.at(a.first),
+			                 & rn = nodes.at(b.first);
+
+			if(ln.turns != rn.turns)
+				return ln.turns < rn.turns;
+
+			return (ln.moveRemains > rn.moveRemains);
+		};
+
 		// find hero who is nearest to a dwelling
 		const CGDwelling * nearest = boost::range::min_element(nearestDwellings, comparator)->second;
 
@@ -6,6 +6,7 @@
 #include "../../lib/mapObjects/MapObjects.h"
 #include "../../lib/CConfigHandler.h"
 #include "../../lib/CHeroHandler.h"
+#include "../../lib/CHierarchicalPathfinder.h"
 #include "../../lib/CModHandler.h"
 #include "../../lib/CGameState.h"
 #include "../../lib/NetPacks.h"
@@ -120,6 +121,7 @@ void VCAI::heroMoved(const TryMoveHero & details)
 	validateObject(details.id); //enemy hero may have left visible area
 	auto hero = cb->getHero(details.id);
 	cachedSectorMaps.clear();
+	hierarchicalPathfinder.reset();
 
 	const int3 from = CGHeroInstance::convertPosition(details.start, false),
 		to = CGHeroInstance::convertPosition(details.end, false);
@@ -404,6 +406,7 @@ void VCAI::newObject(const CGObjectInstance * obj)
 		addVisitableObj(obj);
 
 	cachedSectorMaps.clear();
+	hierarchicalPathfinder.reset();
 }
 
 void VCAI::objectRemoved(const CGObjectInstance *obj)
@@ -431,6 +434,7 @@ void VCAI::objectRemoved(const CGObjectInstance *obj)
 	}
 
 	cachedSectorMaps.clear(); //invalidate all paths
+	hierarchicalPathfinder.reset();
 
 	//TODO
 	//there are other places where CGObjectinstance ptrs are stored...
@@ -1721,6 +1725,7 @@ void VCAI::clearPathsInfo()
 {
 	heroesUnableToExplore.clear();
 	cachedSectorMaps.clear();
+	hierarchicalPathfinder.reset();
 }
 
 void VCAI::validateVisitableObjs()
@@ -1860,7 +1865,7 @@ bool VCAI::isAccessibleForHero(const int3 & pos, HeroPtr h, bool includeAllies /
 				return false;
 		}
 	}
-	return cb->getPathsInfo(h.get())->getPathInfo(pos)->reachable();
+	return cb->getPathsInfo(h.get())->getPathInfo(pos).reachable();
 }
 
 bool VCAI::moveHeroToTile(int3 dst, HeroPtr h)
@@ -2564,9 +2569,9 @@ int3 VCAI::explorationBestNeighbour(int3 hpos, int radius, HeroPtr h)
 	auto best = dstToRevealedTiles.begin();
 	for (auto i = dstToRevealedTiles.begin(); i != dstToRevealedTiles.end(); i++)
 	{
-		const CGPathNode *pn = cb->getPathsInfo(h.get())->getPathInfo(i->first);
+		const CGPathNode pn = cb->getPathsInfo(h.get())->getPathInfo(i->first);
 		//const TerrainTile *t = cb->getTile(i->first);
-		if(best->second < i->second && pn->reachable() && pn->accessible == CGPathNode::ACCESSIBLE)
+		if(best->second < i->second && pn.reachable() && pn.accessible == CGPathNode::ACCESSIBLE)
 			best = i;
 	}
 
@@ -2604,7 +2609,7 @@ int3 VCAI::explorationNewPoint(HeroPtr h)
 		{
 			if (tile == ourPos) //shouldn't happen, but it does
 				continue;
-			if (!cb->getPathsInfo(hero)->getPathInfo(tile)->reachable()) //this will remove tiles that are guarded by monsters (or removable objects)
+			if (!cb->getPathsInfo(hero)->getPathInfo(tile).reachable()) //this will remove tiles that are guarded by monsters (or removable objects)
 				continue;
 
 			CGPath path;
@@ -2853,6 +2858,14 @@ std::shared_ptr<SectorMap> VCAI::getCachedSectorMap(HeroPtr h)
 	}
 }
 
+std::shared_ptr<CHierarchicalPathfinder> VCAI::getHierarchicalPathfinder()
+{
+	if(!hierarchicalPathfinder)
+		hierarchicalPathfinder = std::make_shared<CHierarchicalPathfinder>(myCb.get(), playerID);
+
+	return hierarchicalPathfinder;
+}
+
 AIStatus::AIStatus()
 {
 	battle = NO_BATTLE;
@@ -3426,7 +3439,7 @@ int3 SectorMap::findFirstVisitableTile (HeroPtr h, crint3 dst)
 			logAi->warnStream() << ("Another allied hero stands in our way");
 			return ret;
 		}
-		if(ai->myCb->getPathsInfo(h.get())->getPathInfo(curtile)->reachable())
+		if(ai->myCb->getPathsInfo(h.get())->getPathInfo(curtile).reachable())
 		{
 			return curtile;
 		}
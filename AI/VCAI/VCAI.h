@@ -17,6 +17,7 @@
 #include "../../lib/CondSh.h"
 
 struct QuestInfo;
+class CHierarchicalPathfinder;
 
 /*
  * VCAI.h, part of VCMI engine
@@ -147,6 +148,7 @@ public:
 	std::set<const CGObjectInstance *> reservedObjs; //to be visited by specific hero
 
 	std::map <HeroPtr, std::shared_ptr<SectorMap>> cachedSectorMaps; //TODO: serialize? not necessary
+	std::shared_ptr<CHierarchicalPathfinder> hierarchicalPathfinder; //for distance estimations to far-away targets, rebuilt after map changes
 
 	TResources saving;
 
@@ -299,6 +301,7 @@ public:
 	bool isAccessibleForHero(const int3 & pos, HeroPtr h, bool includeAllies = false) const;
 	//optimization - use one SM for every hero call
 	std::shared_ptr<SectorMap> getCachedSectorMap(HeroPtr h);
+	std::shared_ptr<CHierarchicalPathfinder> getHierarchicalPathfinder();
 
 	const CGTownInstance *findTownWithTavern() const;
 	bool canRecruitAnyHero(const CGTownInstance * t = NULL) const;
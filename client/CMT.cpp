@@ -39,6 +39,7 @@
 #include "../lib/CScriptingModule.h"
 #include "../lib/GameConstants.h"
 #include "gui/CGuiHandler.h"
+#include "gui/CAnimation.h"
 #include "../lib/logging/CBasicLogConfigurator.h"
 #include "../lib/CondSh.h"
 #include "../lib/StringConstants.h"
@@ -690,6 +691,12 @@ void processCommand(const std::string &message)
 			std::cout << "\nBonuses from " << typeid(*parent).name() << std::endl << parent->getBonusList() << std::endl;
 		}
 	}
+	else if(cn == "imagecache")
+	{
+		auto stats = CImageCache::get().getStats();
+		std::cout << "Image cache: " << stats.images << " frames, " << stats.bytes / 1024 << " KB, "
+			<< stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions << " evictions" << std::endl;
+	}
 	else if(cn == "not dialog")
 	{
 		LOCPLINT->showingDialog->setn(false);
@@ -934,6 +941,7 @@ void dispose()
 		CCS->soundh->release();
 	}
 	CMessage::dispose();
+	CImageCache::get().clear();
 
 	vstd::clear_pointer(graphics);
 
@@ -826,11 +826,24 @@ void CClient::invalidatePaths()
 	pathInfo->hero = nullptr;
 }
 
+void CClient::invalidatePaths(const std::set<int3> & tiles)
+{
+	boost::unique_lock<boost::mutex> pathLock(pathInfo->pathMx);
+	pathInfo->invalidateTiles(tiles);
+}
+
+void CClient::invalidatePaths(const CGObjectInstance * obj)
+{
+	auto tiles = obj->getBlockedPos();
+	tiles.insert(obj->visitablePos());
+	invalidatePaths(tiles);
+}
+
 const CPathsInfo * CClient::getPathsInfo(const CGHeroInstance *h)
 {
 	assert(h);
 	boost::unique_lock<boost::mutex> pathLock(pathInfo->pathMx);
-	if (pathInfo->hero != h)
+	if (pathInfo->hero != h || pathInfo->needsRepair())
 	{
 		gs->calculatePaths(h, *pathInfo.get());
 	}
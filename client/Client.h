@@ -161,6 +161,8 @@ public:
 	void proposeNextMission(std::shared_ptr<CCampaignState> camp);
 
 	void invalidatePaths();
+	void invalidatePaths(const std::set<int3> & tiles); //only given tiles changed, paths may be repaired
+	void invalidatePaths(const CGObjectInstance * obj);
 	const CPathsInfo * getPathsInfo(const CGHeroInstance *h);
 
 	bool terminate;	// tell to terminate
@@ -177,6 +177,18 @@ void Graphics::loadHeroAnims()
 		{2,14}, {3,15}
 	};
 
+	std::vector<std::string> boats = {"AB01_.DEF", "AB02_.DEF", "AB03_.DEF"};
+	std::vector<ResourceID> files;
+	for(auto & elem : CGI->heroh->classes.heroClasses)
+	{
+		for(auto & templ : VLC->objtypeh->getHandlerFor(Obj::HERO, elem->id)->getTemplates())
+			files.push_back(ResourceID("SPRITES/" + templ.animationFile, EResType::ANIMATION));
+	}
+	for(auto & name : boats)
+		files.push_back(ResourceID("SPRITES/" + name, EResType::ANIMATION));
+	//decompress all animations at once, they are decoded one by one below, unused ones are freed on return
+	auto prefetched = CResourceHandler::get()->prefetch(files);
+
 	for(auto & elem : CGI->heroh->classes.heroClasses)
 	{
 		for (auto & templ : VLC->objtypeh->getHandlerFor(Obj::HERO, elem->id)->getTemplates())
@@ -186,9 +198,8 @@ void Graphics::loadHeroAnims()
 		}
 	}
 
-	boatAnims.push_back(loadHeroAnim("AB01_.DEF", rotations));
-	boatAnims.push_back(loadHeroAnim("AB02_.DEF", rotations));
-	boatAnims.push_back(loadHeroAnim("AB03_.DEF", rotations));
+	for(auto & name : boats)
+		boatAnims.push_back(loadHeroAnim(name, rotations));
 }
 
 CDefEssential * Graphics::loadHeroAnim( const std::string &name, const std::vector<std::pair<int,int> > &rotations)
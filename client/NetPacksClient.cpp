@@ -288,6 +288,8 @@ void ChangeObjPos::applyFirstCl(CClient *cl)
 	CGObjectInstance *obj = GS(cl)->getObjInstance(objid);
 	if(flags & 1)
 		CGI->mh->hideObject(obj);
+
+	cl->invalidatePaths(obj);
 }
 void ChangeObjPos::applyCl(CClient *cl)
 {
@@ -295,7 +297,7 @@ void ChangeObjPos::applyCl(CClient *cl)
 	if(flags & 1)
 		CGI->mh->printObject(obj);
 
-	cl->invalidatePaths();
+	cl->invalidatePaths(obj);
 }
 
 void PlayerEndsGame::applyCl(CClient *cl)
@@ -339,6 +341,8 @@ void RemoveObject::applyFirstCl(CClient *cl)
 	const CGObjectInstance *o = cl->getObj(id);
 
 	CGI->mh->hideObject(o, true);
+	objectTiles = o->getBlockedPos();
+	objectTiles.insert(o->visitablePos());
 
 	//notify interfaces about removal
 	for(auto i=cl->playerint.begin(); i!=cl->playerint.end(); i++)
@@ -350,7 +354,8 @@ void RemoveObject::applyFirstCl(CClient *cl)
 
 void RemoveObject::applyCl(CClient *cl)
 {
-	cl->invalidatePaths();
+	//object is gone from map only now, paths computed by interfaces above still include it
+	cl->invalidatePaths(objectTiles);
 }
 
 void TryMoveHero::applyFirstCl(CClient *cl)
@@ -379,7 +384,11 @@ void TryMoveHero::applyFirstCl(CClient *cl)
 void TryMoveHero::applyCl(CClient *cl)
 {
 	const CGHeroInstance *h = cl->getHero(id);
-	cl->invalidatePaths();
+
+	std::set<int3> changedTiles(fowRevealed.begin(), fowRevealed.end());
+	changedTiles.insert(CGHeroInstance::convertPosition(start, false));
+	changedTiles.insert(CGHeroInstance::convertPosition(end, false));
+	cl->invalidatePaths(changedTiles);
 
 	if(result == TELEPORTATION  ||  result == EMBARK  ||  result == DISEMBARK)
 	{
@@ -816,7 +825,7 @@ void SaveGame::applyCl(CClient *cl)
 
 	try
 	{
-		CSaveFile save(*CResourceHandler::get()->getResourceName(ResourceID(stem.to_string(), EResType::CLIENT_SAVEGAME)));
+		CSaveFile save(*CResourceHandler::get()->getResourceName(ResourceID(stem.to_string(), EResType::CLIENT_SAVEGAME)), settings["general"]["compressSaves"].Bool());
 		cl->saveCommonState(save);
 		save << *cl;
 	}
@@ -924,9 +933,9 @@ void CenterView::applyCl(CClient *cl)
 
 void NewObject::applyCl(CClient *cl)
 {
-	cl->invalidatePaths();
-
 	const CGObjectInstance *obj = cl->getObj(id);
+	cl->invalidatePaths(obj);
+
 	CGI->mh->printObject(obj, true);
 
 	for(auto i=cl->playerint.begin(); i!=cl->playerint.end(); i++)
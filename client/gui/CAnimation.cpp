@@ -12,6 +12,7 @@
 #include "../lib/filesystem/ISimpleResourceLoader.h"
 #include "../lib/JsonNode.h"
 #include "../lib/CRandomGenerator.h"
+#include "../lib/CConfigHandler.h"
 
 /*
  * CAnimation.cpp, part of VCMI engine
@@ -567,11 +568,17 @@ CompImageLoader::~CompImageLoader()
  *************************************************************************/
 
 IImage::IImage():
-	refCount(1)
+	refCount(1),
+	recolored(false)
 {
 
 }
 
+bool IImage::isRecolored() const
+{
+	return recolored;
+}
+
 bool IImage::decreaseRef()
 {
 	refCount--;
@@ -664,6 +671,7 @@ void SDLImage::draw(SDL_Surface *where, int posX, int posY, Rect *src, ui8 alpha
 
 void SDLImage::playerColored(PlayerColor player)
 {
+	recolored = true;
 	graphics->blueToPlayersAdv(surf, player);
 }
 
@@ -677,6 +685,14 @@ int SDLImage::height() const
 	return fullSize.y;
 }
 
+size_t SDLImage::memoryUsage() const
+{
+	if (!surf)
+		return sizeof(*this);
+	size_t paletteSize = surf->format->palette ? surf->format->palette->ncolors * sizeof(SDL_Color) : 0;
+	return sizeof(*this) + surf->h * surf->pitch + paletteSize;
+}
+
 SDLImage::~SDLImage()
 {
 	SDL_FreeSurface(surf);
@@ -877,6 +893,7 @@ void CompImage::playerColored(PlayerColor player)
 	else
 		assert(0);
 
+	recolored = true;
 	for(int i=0; i<32; ++i)
 	{
 		CSDL_Ext::colorAssign(palette[224+i],pal[i]);
@@ -893,6 +910,14 @@ int CompImage::height() const
 	return fullSize.y;
 }
 
+size_t CompImage::memoryUsage() const
+{
+	if (!surf)
+		return sizeof(*this);
+	//last line offset is size of whole RLE data
+	return sizeof(*this) + line[sprite.h] + (sprite.h + 1) * sizeof(ui32) + 256 * sizeof(SDL_Color);
+}
+
 CompImage::~CompImage()
 {
 	free(surf);
@@ -900,6 +925,160 @@ CompImage::~CompImage()
 	delete [] palette;
 }
 
+/*************************************************************************
+ *  CImageCache, keeps decoded frames released by animations             *
+ *************************************************************************/
+
+bool CImageCache::Key::operator==(const Key & other) const
+{
+	return frame == other.frame && group == other.group && compressed == other.compressed && animation == other.animation;
+}
+
+size_t CImageCache::KeyHash::operator()(const Key & key) const
+{
+	size_t ret = std::hash<std::string>()(key.animation);
+	boost::hash_combine(ret, key.group);
+	boost::hash_combine(ret, key.frame);
+	boost::hash_combine(ret, key.compressed);
+	return ret;
+}
+
+CImageCache::Shard::Shard():
+	bytes(0),
+	hits(0),
+	misses(0),
+	evictions(0)
+{
+
+}
+
+void CImageCache::Shard::evict(size_t budget)
+{
+	while (bytes > budget && !lru.empty())
+	{
+		IImage * image = lru.back().second;
+		bytes -= image->memoryUsage();
+		index.erase(lru.back().first);
+		lru.pop_back();
+		delete image;
+		evictions++;
+	}
+}
+
+CImageCache::CImageCache():
+	budget(settings["video"]["imageCacheSize"].Float() * 1024 * 1024),
+	budgetListener(settings.listen["video"]["imageCacheSize"])
+{
+	budgetListener([this](const JsonNode & size)
+	{
+		setBudget(size.Float() * 1024 * 1024);
+	});
+}
+
+CImageCache::~CImageCache()
+{
+	clear();
+}
+
+CImageCache & CImageCache::get()
+{
+	static CImageCache instance;
+	return instance;
+}
+
+CImageCache::Shard & CImageCache::getShard(const Key & key)
+{
+	return shards[KeyHash()(key) % SHARDS_COUNT];
+}
+
+IImage * CImageCache::acquire(const std::string & animation, size_t group, size_t frame, bool compressed)
+{
+	const Key key = {animation, group, frame, compressed};
+	Shard & shard = getShard(key);
+	boost::unique_lock<boost::mutex> lock(shard.mx);
+
+	auto iter = shard.index.find(key);
+	if (iter == shard.index.end())
+	{
+		shard.misses++;
+		return nullptr;
+	}
+	shard.hits++;
+
+	IImage * image = iter->second->second;
+	shard.bytes -= image->memoryUsage();
+	shard.lru.erase(iter->second);
+	shard.index.erase(iter);
+
+	//image was released with no references left
+	image->increaseRef();
+	return image;
+}
+
+void CImageCache::release(const std::string & animation, size_t group, size_t frame, bool compressed, IImage * image)
+{
+	const Key key = {animation, group, frame, compressed};
+	const size_t shardBudget = budget / SHARDS_COUNT;
+
+	//recolored image can't be given to another animation, same frame may be already released by another one
+	if (image->isRecolored() || image->memoryUsage() > shardBudget)
+	{
+		delete image;
+		return;
+	}
+
+	Shard & shard = getShard(key);
+	boost::unique_lock<boost::mutex> lock(shard.mx);
+	if (shard.index.count(key))
+	{
+		delete image;
+		return;
+	}
+
+	shard.lru.push_front(std::make_pair(key, image));
+	shard.index[key] = shard.lru.begin();
+	shard.bytes += image->memoryUsage();
+	shard.evict(shardBudget);
+}
+
+void CImageCache::setBudget(size_t bytes)
+{
+	budget = bytes;
+	for (auto & shard : shards)
+	{
+		boost::unique_lock<boost::mutex> lock(shard.mx);
+		shard.evict(bytes / SHARDS_COUNT);
+	}
+}
+
+CImageCache::Stats CImageCache::getStats() const
+{
+	Stats ret = {0, 0, 0, 0, 0};
+	for (auto & shard : shards)
+	{
+		boost::unique_lock<boost::mutex> lock(shard.mx);
+		ret.hits += shard.hits;
+		ret.misses += shard.misses;
+		ret.evictions += shard.evictions;
+		ret.images += shard.lru.size();
+		ret.bytes += shard.bytes;
+	}
+	return ret;
+}
+
+void CImageCache::clear()
+{
+	for (auto & shard : shards)
+	{
+		boost::unique_lock<boost::mutex> lock(shard.mx);
+		for (auto & entry : shard.lru)
+			delete entry.second;
+		shard.lru.clear();
+		shard.index.clear();
+		shard.bytes = 0;
+	}
+}
+
 /*************************************************************************
  *  CAnimation for animations handling, can load part of file if needed  *
  *************************************************************************/
@@ -925,7 +1104,7 @@ IImage * CAnimation::getFromExtraDef(std::string filename)
 	return ret;
 }
 
-bool CAnimation::loadFrame(CDefFile * file, size_t frame, size_t group)
+bool CAnimation::loadFrame(size_t frame, size_t group)
 {
 	if (size(group) <= frame)
 	{
@@ -943,6 +1122,14 @@ bool CAnimation::loadFrame(CDefFile * file, size_t frame, size_t group)
 	//try to get image from def
 	if (source[group][frame].getType() == JsonNode::DATA_NULL)
 	{
+		image = CImageCache::get().acquire(name, group, frame, compressed);
+		if (image)
+		{
+			images[group][frame] = image;
+			return true;
+		}
+
+		CDefFile * file = getDefFile();
 		if (file)
 		{
 			auto frameList = file->getEntries();
@@ -980,10 +1167,13 @@ bool CAnimation::unloadFrame(size_t frame, size_t group)
 	IImage *image = getImage(frame, group, false);
 	if (image)
 	{
-		//decrease ref count for image and delete if needed
+		//decrease ref count for image and give it to cache or delete if needed
 		if (image->decreaseRef())
 		{
-			delete image;
+			if (!name.empty() && frame < size(group) && source[group][frame].getType() == JsonNode::DATA_NULL)
+				CImageCache::get().release(name, group, frame, compressed, image);
+			else
+				delete image;
 			images[group].erase(frame);
 		}
 		if (images[group].empty())
@@ -1063,6 +1253,22 @@ CDefFile * CAnimation::getFile() const
 	return nullptr;
 }
 
+CDefFile * CAnimation::getDefFile()
+{
+	if (!defFileOpened)
+	{
+		defFile.reset(getFile());
+		defFileOpened = true;
+	}
+	return defFile.get();
+}
+
+void CAnimation::closeDefFile()
+{
+	defFile.reset();
+	defFileOpened = false;
+}
+
 void CAnimation::printError(size_t frame, size_t group, std::string type) const
 {
 	logGlobal->errorStream() << type << " error: Request for frame not present in CAnimation! "
@@ -1072,7 +1278,8 @@ void CAnimation::printError(size_t frame, size_t group, std::string type) const
 CAnimation::CAnimation(std::string Name, bool Compressed):
 	name(Name),
 	compressed(Compressed),
-	preloaded(false)
+	preloaded(false),
+	defFileOpened(false)
 {
 	size_t dotPos = name.find_last_of('.');
 	if ( dotPos!=-1 )
@@ -1086,7 +1293,8 @@ CAnimation::CAnimation(std::string Name, bool Compressed):
 CAnimation::CAnimation():
 	name(""),
 	compressed(false),
-	preloaded(false)
+	preloaded(false),
+	defFileOpened(false)
 {
 	init(nullptr);
 }
@@ -1129,13 +1337,11 @@ IImage * CAnimation::getImage(size_t frame, size_t group, bool verbose) const
 
 void CAnimation::load()
 {
-	CDefFile * file = getFile();
-
 	for (auto & elem : source)
 		for (size_t image=0; image < elem.second.size(); image++)
-			loadFrame(file, image, elem.first);
+			loadFrame(image, elem.first);
 
-	delete file;
+	closeDefFile();
 }
 
 void CAnimation::unload()
@@ -1154,13 +1360,11 @@ void CAnimation::preload()
 
 void CAnimation::loadGroup(size_t group)
 {
-	CDefFile * file = getFile();
-
 	if (vstd::contains(source, group))
 		for (size_t image=0; image < source[group].size(); image++)
-			loadFrame(file, image, group);
+			loadFrame(image, group);
 
-	delete file;
+	closeDefFile();
 }
 
 void CAnimation::unloadGroup(size_t group)
@@ -1172,9 +1376,8 @@ void CAnimation::unloadGroup(size_t group)
 
 void CAnimation::load(size_t frame, size_t group)
 {
-	CDefFile * file = getFile();
-	loadFrame(file, frame, group);
-	delete file;
+	loadFrame(frame, group);
+	closeDefFile();
 }
 
 void CAnimation::unload(size_t frame, size_t group)
@@ -3,6 +3,9 @@
 #include "../../lib/vcmi_endian.h"
 #include "gui/Geometries.h"
 #include "../../lib/GameConstants.h"
+#include "../../lib/CConfigHandler.h"
+
+#include <atomic>
 
 /*
  * CAnimation.h, part of VCMI engine
@@ -59,6 +62,9 @@ public:
 class IImage
 {
 	int refCount;
+protected:
+	//true if palette was changed by playerColored, such image differs from one loaded from file
+	bool recolored;
 public:
 
 	//draws image on surface "where" at position
@@ -72,6 +78,9 @@ public:
 	virtual void playerColored(PlayerColor player)=0;
 	virtual int width() const=0;
 	virtual int height() const=0;
+	//approximate amount of memory taken by decoded image, in bytes
+	virtual size_t memoryUsage() const=0;
+	bool isRecolored() const;
 	IImage();
 	virtual ~IImage() {};
 };
@@ -103,6 +112,7 @@ public:
 	void playerColored(PlayerColor player) override;
 	int width() const override;
 	int height() const override;
+	size_t memoryUsage() const override;
 
 	friend class SDLImageLoader;
 };
@@ -149,10 +159,82 @@ public:
 	void playerColored(PlayerColor player) override;
 	int width() const override;
 	int height() const override;
+	size_t memoryUsage() const override;
 
 	friend class CompImageLoader;
 };
 
+/// Process-wide cache of decoded def frames that are not used by any animation at the moment.
+/// Animations pass frames to cache on unload and take them back on next load instead of decoding def again.
+/// Least recently released frames are deleted when total size exceeds budget ("video"/"imageCacheSize" setting).
+/// Cache is split into independently locked shards, each one with its own part of the budget.
+class CImageCache
+{
+public:
+	struct Stats
+	{
+		ui64 hits;
+		ui64 misses;
+		ui64 evictions;
+		size_t images;
+		size_t bytes;
+	};
+
+	static CImageCache & get();
+
+	//returns cached frame with single reference, or nullptr on miss
+	IImage * acquire(const std::string & animation, size_t group, size_t frame, bool compressed);
+	//takes ownership of frame that is not referenced anymore, frame may be deleted right away
+	void release(const std::string & animation, size_t group, size_t frame, bool compressed, IImage * image);
+
+	void setBudget(size_t bytes);
+	Stats getStats() const;
+	//deletes all cached frames
+	void clear();
+
+private:
+	static const size_t SHARDS_COUNT = 8;
+
+	struct Key
+	{
+		std::string animation;
+		size_t group;
+		size_t frame;
+		bool compressed;
+
+		bool operator==(const Key & other) const;
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key & key) const;
+	};
+
+	typedef std::list<std::pair<Key, IImage *>> TLruList;
+
+	struct Shard
+	{
+		mutable boost::mutex mx;
+		TLruList lru; //most recently released frames first
+		std::unordered_map<Key, TLruList::iterator, KeyHash> index;
+		size_t bytes;
+		ui64 hits;
+		ui64 misses;
+		ui64 evictions;
+
+		Shard();
+		void evict(size_t budget);
+	};
+
+	std::array<Shard, SHARDS_COUNT> shards;
+	std::atomic<size_t> budget;
+	SettingsListener budgetListener;
+
+	CImageCache();
+	~CImageCache();
+	Shard & getShard(const Key & key);
+};
+
 
 /// Class for handling animation
 class CAnimation
@@ -172,8 +254,12 @@ private:
 
 	bool preloaded;
 
-	//loader, will be called by load(), require opened def file for loading from it. Returns true if image is loaded
-	bool loadFrame(CDefFile * file, size_t frame, size_t group);
+	//def file, opened on first frame that is not found in image cache
+	std::unique_ptr<CDefFile> defFile;
+	bool defFileOpened;
+
+	//loader, will be called by load(), opens def file if needed. Returns true if image is loaded
+	bool loadFrame(size_t frame, size_t group);
 
 	//unloadFrame, returns true if image has been unloaded ( either deleted or decreased refCount)
 	bool unloadFrame(size_t frame, size_t group);
@@ -184,6 +270,8 @@ private:
 
 	//try to open def file
 	CDefFile * getFile() const;
+	CDefFile * getDefFile();
+	void closeDefFile();
 
 	//to get rid of copy-pasting error message :]
 	void printError(size_t frame, size_t group, std::string type) const;
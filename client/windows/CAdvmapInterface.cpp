@@ -1452,13 +1452,13 @@ void CAdvMapInt::tileLClicked(const int3 &mapPos)
 	}
 	else if(const CGHeroInstance * currentHero = curHero()) //hero is selected
 	{
-		const CGPathNode *pn = LOCPLINT->cb->getPathsInfo(currentHero)->getPathInfo(mapPos);
+		const CGPathNode pn = LOCPLINT->cb->getPathsInfo(currentHero)->getPathInfo(mapPos);
 		if(currentHero == topBlocking) //clicked selected hero
 		{
 			LOCPLINT->openHeroWindow(currentHero);
 			return;
 		}
-		else if(canSelect && pn->turns == 255 ) //selectable object at inaccessible tile
+		else if(canSelect && pn.turns == 255 ) //selectable object at inaccessible tile
 		{
 			select(static_cast<const CArmedInstance*>(topBlocking), false);
 			return;
@@ -1566,16 +1566,15 @@ void CAdvMapInt::tileHovered(const int3 &mapPos)
 	else if(const CGHeroInstance * h = curHero())
 	{
 		int3 mapPosCopy = mapPos;
-		const CGPathNode * pnode = LOCPLINT->cb->getPathsInfo(h)->getPathInfo(mapPosCopy);
-		assert(pnode);
+		const CGPathNode pnode = LOCPLINT->cb->getPathsInfo(h)->getPathInfo(mapPosCopy);
 
-		int turns = pnode->turns;
+		int turns = pnode.turns;
 		vstd::amin(turns, 3);
-		switch(pnode->action)
+		switch(pnode.action)
 		{
 		case CGPathNode::NORMAL:
 		case CGPathNode::TELEPORT_NORMAL:
-			if(pnode->layer == EPathfindingLayer::LAND)
+			if(pnode.layer == EPathfindingLayer::LAND)
 				CCS->curh->changeGraphic(ECursor::ADVENTURE, 4 + turns*6);
 			else
 				CCS->curh->changeGraphic(ECursor::ADVENTURE, 28 + turns);
@@ -1591,7 +1590,7 @@ void CAdvMapInt::tileHovered(const int3 &mapPos)
 				else
 					CCS->curh->changeGraphic(ECursor::ADVENTURE, 8 + turns*6);
 			}
-			else if(pnode->layer == EPathfindingLayer::LAND)
+			else if(pnode.layer == EPathfindingLayer::LAND)
 				CCS->curh->changeGraphic(ECursor::ADVENTURE, 9 + turns*6);
 			else
 				CCS->curh->changeGraphic(ECursor::ADVENTURE, 28 + turns);
@@ -1869,6 +1869,7 @@ void CGameState::initMapObjects()
 	CGSubterraneanGate::postInit(); //pairing subterranean gates
 
 	map->calculateGuardingGreaturePositions(); //calculate once again when all the guards are placed and initialized
+	map->initMovementInfo();
 }
 
 void CGameState::initVisitingAndGarrisonedHeroes()
@@ -0,0 +1,357 @@
+#include "StdInc.h"
+#include "CHierarchicalPathfinder.h"
+
+#include "CGameInfoCallback.h"
+#include "CHeroHandler.h"
+#include "VCMI_Lib.h"
+#include "mapping/CMap.h"
+#include "mapObjects/CGTownInstance.h"
+#include "mapObjects/MiscObjects.h"
+
+/*
+ * CHierarchicalPathfinder.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+const CHierarchicalPathfinder::TRegionId CHierarchicalPathfinder::INVALID_REGION = -1;
+const int CHierarchicalPathfinder::CLUSTER_SIZE = 16;
+
+static const int3 dirs[] = {
+	int3(-1, +1, +0),	int3(0, +1, +0),	int3(+1, +1, +0),
+	int3(-1, +0, +0),	/* source pos */	int3(+1, +0, +0),
+	int3(-1, -1, +0),	int3(0, -1, +0),	int3(+1, -1, +0)
+};
+
+CHierarchicalPathfinder::CHierarchicalPathfinder(const CGameInfoCallback * cb, PlayerColor player)
+	: sizes(cb->getMapSize())
+{
+	std::vector<const TerrainTile *> tiles(sizes.x * sizes.y * sizes.z, nullptr);
+	int3 pos;
+	for(pos.x = 0; pos.x < sizes.x; ++pos.x)
+	{
+		for(pos.y = 0; pos.y < sizes.y; ++pos.y)
+		{
+			for(pos.z = 0; pos.z < sizes.z; ++pos.z)
+				tiles[getIndex(pos)] = cb->getTile(pos, false);
+		}
+	}
+
+	tileRegions.resize(tiles.size(), INVALID_REGION);
+	initializeRegions(tiles);
+	linkNeighbours(tiles);
+	linkObjects(cb, player, tiles);
+}
+
+CHierarchicalPathfinder::TRegionId CHierarchicalPathfinder::getRegion(const int3 & tile) const
+{
+	if(tile.x < 0 || tile.y < 0 || tile.z < 0 || tile.x >= sizes.x || tile.y >= sizes.y || tile.z >= sizes.z)
+		return INVALID_REGION;
+
+	return tileRegions[getIndex(tile)];
+}
+
+const CHierarchicalPathfinder::Region & CHierarchicalPathfinder::getRegionInfo(TRegionId region) const
+{
+	return regions.at(region);
+}
+
+size_t CHierarchicalPathfinder::regionsCount() const
+{
+	return regions.size();
+}
+
+int CHierarchicalPathfinder::getDistance(const int3 & src, const int3 & dst) const
+{
+	const TRegionId from = getRegion(src), to = getRegion(dst);
+	if(from == INVALID_REGION || to == INVALID_REGION)
+		return -1;
+
+	if(from == to)
+		return estimateCost(src, dst, regions[from].tileCost);
+
+	if(getDistances(from)[to] == std::numeric_limits<int>::max())
+		return -1;
+
+	//first and last step leave and enter regions through portals instead of region centers,
+	//otherwise tiles close to cluster border would be estimated several times further than they are
+	const Region & source = regions[from], & target = regions[to];
+	int best = std::numeric_limits<int>::max();
+	for(auto & elem : source.portals)
+	{
+		const TRegionId next = elem.first;
+		const Region & middle = regions[next];
+		if(next == to)
+		{
+			for(auto & out : elem.second)
+				vstd::amin(best, estimateCost(src, out.exit, source.tileCost) + out.transitionCost + estimateCost(out.entry, dst, target.tileCost));
+			continue;
+		}
+
+		int toMiddle = std::numeric_limits<int>::max();
+		for(auto & out : elem.second)
+			vstd::amin(toMiddle, estimateCost(src, out.exit, source.tileCost) + out.transitionCost + estimateCost(out.entry, middle.center, middle.tileCost));
+
+		const std::vector<int> & fromMiddle = getDistances(next);
+		for(TRegionId last : target.incoming)
+		{
+			if(fromMiddle[last] == std::numeric_limits<int>::max())
+				continue;
+
+			for(auto & in : regions[last].portals.at(to))
+			{
+				const int enter = in.transitionCost + estimateCost(in.entry, dst, target.tileCost);
+				if(next == last) //only one region between, go straight from portal to portal
+				{
+					for(auto & out : elem.second)
+						vstd::amin(best, estimateCost(src, out.exit, source.tileCost) + out.transitionCost + estimateCost(out.entry, in.exit, middle.tileCost) + enter);
+				}
+				else
+				{
+					vstd::amin(best, toMiddle + fromMiddle[last] + estimateCost(regions[last].center, in.exit, regions[last].tileCost) + enter);
+				}
+			}
+		}
+	}
+	return best;
+}
+
+int CHierarchicalPathfinder::getIndex(const int3 & tile) const
+{
+	return (tile.z * sizes.y + tile.y) * sizes.x + tile.x;
+}
+
+bool CHierarchicalPathfinder::isPassable(const TerrainTile * tile) const
+{
+	//tiles of visitable objects are considered passable, as in VCAI sectors
+	return tile && tile->terType != ETerrainType::ROCK && (!tile->blocked || tile->visitable);
+}
+
+void CHierarchicalPathfinder::initializeRegions(const std::vector<const TerrainTile *> & tiles)
+{
+	std::vector<int3> queue, members;
+	for(int z = 0; z < sizes.z; z++)
+	{
+		for(int cx = 0; cx < sizes.x; cx += CLUSTER_SIZE)
+		{
+			for(int cy = 0; cy < sizes.y; cy += CLUSTER_SIZE)
+			{
+				const int maxX = std::min(cx + CLUSTER_SIZE, sizes.x), maxY = std::min(cy + CLUSTER_SIZE, sizes.y);
+				for(int x = cx; x < maxX; x++)
+				{
+					for(int y = cy; y < maxY; y++)
+					{
+						const int3 start(x, y, z);
+						const TerrainTile * startTile = tiles[getIndex(start)];
+						if(!isPassable(startTile) || tileRegions[getIndex(start)] != INVALID_REGION)
+							continue;
+
+						//flood fill all tiles of same layer within this cluster
+						const TRegionId id = regions.size();
+						const bool water = startTile->isWater();
+						queue.clear();
+						members.clear();
+						queue.push_back(start);
+						tileRegions[getIndex(start)] = id;
+						while(!queue.empty())
+						{
+							const int3 pos = queue.back();
+							queue.pop_back();
+							members.push_back(pos);
+							for(auto & dir : dirs)
+							{
+								const int3 n = pos + dir;
+								if(n.x < cx || n.y < cy || n.x >= maxX || n.y >= maxY)
+									continue;
+
+								const TerrainTile * t = tiles[getIndex(n)];
+								if(!isPassable(t) || t->isWater() != water || tileRegions[getIndex(n)] != INVALID_REGION)
+									continue;
+
+								tileRegions[getIndex(n)] = id;
+								queue.push_back(n);
+							}
+						}
+
+						Region region;
+						region.water = water;
+						int3 sum;
+						int costSum = 0;
+						for(auto & pos : members)
+						{
+							const TerrainTile * t = tiles[getIndex(pos)];
+							sum += pos;
+							if(t->roadType != ERoadType::NO_ROAD)
+								costSum += 75; //same as dirt road, most common one
+							else
+								costSum += VLC->heroh->terrCosts[t->terType];
+						}
+						const int count = members.size();
+						region.tileCost = costSum / count;
+
+						const int3 centroid(sum.x / count, sum.y / count, z);
+						region.center = *boost::min_element(members, [&](const int3 & lhs, const int3 & rhs)
+						{
+							return lhs.dist2dSQ(centroid) < rhs.dist2dSQ(centroid);
+						});
+						regions.push_back(region);
+					}
+				}
+			}
+		}
+	}
+}
+
+void CHierarchicalPathfinder::linkNeighbours(const std::vector<const TerrainTile *> & tiles)
+{
+	int3 pos;
+	for(pos.z = 0; pos.z < sizes.z; ++pos.z)
+	{
+		for(pos.x = 0; pos.x < sizes.x; ++pos.x)
+		{
+			for(pos.y = 0; pos.y < sizes.y; ++pos.y)
+			{
+				const TRegionId from = tileRegions[getIndex(pos)];
+				if(from == INVALID_REGION)
+					continue;
+
+				for(auto & dir : dirs)
+				{
+					const int3 n = pos + dir;
+					const TRegionId to = getRegion(n);
+					if(to == INVALID_REGION || to == from)
+						continue;
+
+					/// Hero can always disembark, but to embark he need a boat which is handled with objects
+					if(!regions[from].water && regions[to].water)
+						continue;
+
+					addEdge(from, pos, to, n, estimateCost(pos, n, (regions[from].tileCost + regions[to].tileCost) / 2));
+				}
+			}
+		}
+	}
+}
+
+void CHierarchicalPathfinder::linkObjects(const CGameInfoCallback * cb, PlayerColor player, const std::vector<const TerrainTile *> & tiles)
+{
+	for(auto tile : tiles)
+	{
+		if(!tile)
+			continue;
+
+		for(auto obj : tile->visitableObjects)
+		{
+			const int3 pos = obj->visitablePos();
+			const TRegionId region = getRegion(pos);
+			if(region == INVALID_REGION)
+				continue;
+
+			if(obj->ID == Obj::BOAT)
+			{
+				for(auto & dir : dirs)
+				{
+					const int3 n = pos + dir;
+					const TRegionId from = getRegion(n);
+					if(from != INVALID_REGION && !regions[from].water)
+						addEdge(from, n, region, pos, GameConstants::BASE_MOVEMENT_COST);
+				}
+			}
+			else if(obj->ID == Obj::SHIPYARD
+				|| (obj->ID == Obj::TOWN && static_cast<const CGTownInstance *>(obj)->hasBuilt(BuildingID::SHIPYARD)))
+			{
+				const int3 boatPos = IShipyard::castFrom(obj)->bestLocation();
+				const TRegionId to = getRegion(boatPos);
+				if(to != INVALID_REGION && regions[to].water)
+					addEdge(region, pos, to, boatPos, GameConstants::BASE_MOVEMENT_COST);
+			}
+			else if(CGTeleport::isTeleport(obj))
+			{
+				auto teleport = dynamic_cast<const CGTeleport *>(obj);
+				if(!teleport->isEntrance() || cb->isTeleportChannelImpassable(teleport->channel, player))
+					continue;
+
+				for(auto exitId : cb->getTeleportChannelExits(teleport->channel, player))
+				{
+					auto exit = cb->getObj(exitId, false);
+					if(!exit || exit == obj)
+						continue;
+
+					const TRegionId to = getRegion(exit->visitablePos());
+					if(to != INVALID_REGION)
+						addEdge(region, pos, to, exit->visitablePos(), 0);
+				}
+			}
+		}
+	}
+}
+
+void CHierarchicalPathfinder::addEdge(TRegionId from, const int3 & exit, TRegionId to, const int3 & entry, int transitionCost)
+{
+	const int cost = estimateCost(regions[from].center, exit, regions[from].tileCost)
+		+ transitionCost
+		+ estimateCost(entry, regions[to].center, regions[to].tileCost);
+
+	Portal portal;
+	portal.exit = exit;
+	portal.entry = entry;
+	portal.transitionCost = transitionCost;
+
+	regions[from].portals[to].push_back(portal);
+
+	auto it = regions[from].edges.find(to);
+	if(it == regions[from].edges.end())
+	{
+		regions[from].edges[to] = cost;
+		regions[to].incoming.push_back(from);
+	}
+	else
+		vstd::amin(it->second, cost);
+}
+
+const std::vector<int> & CHierarchicalPathfinder::getDistances(TRegionId source) const
+{
+	boost::unique_lock<boost::mutex> lock(distancesMx);
+
+	auto it = distances.find(source);
+	if(it != distances.end())
+		return it->second;
+
+	std::vector<int> & result = distances[source];
+	result.resize(regions.size(), std::numeric_limits<int>::max());
+
+	typedef std::pair<int, TRegionId> TQueueEntry;
+	std::priority_queue<TQueueEntry, std::vector<TQueueEntry>, std::greater<TQueueEntry>> pq;
+	result[source] = 0;
+	pq.push(std::make_pair(0, source));
+	while(!pq.empty())
+	{
+		const TQueueEntry top = pq.top();
+		pq.pop();
+		if(top.first > result[top.second])
+			continue;
+
+		for(auto & edge : regions[top.second].edges)
+		{
+			const int cost = top.first + edge.second;
+			if(cost < result[edge.first])
+			{
+				result[edge.first] = cost;
+				pq.push(std::make_pair(cost, edge.first));
+			}
+		}
+	}
+	return result;
+}
+
+int CHierarchicalPathfinder::estimateCost(const int3 & src, const int3 & dst, int tileCost)
+{
+	//octile distance, diagonal steps cost same as in CPathfinderHelper::getMovementCost
+	const int dx = std::abs(src.x - dst.x), dy = std::abs(src.y - dst.y);
+	const int diagonal = std::min(dx, dy), straight = std::max(dx, dy) - diagonal;
+	return straight * tileCost + static_cast<int>(diagonal * tileCost * 1.414213);
+}
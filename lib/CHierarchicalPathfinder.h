@@ -0,0 +1,75 @@
+#pragma once
+
+#include "int3.h"
+#include "GameConstants.h"
+
+/*
+ * CHierarchicalPathfinder.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+class CGameInfoCallback;
+struct TerrainTile;
+
+/// Coarse graph of adventure map used to estimate distances between far-away tiles without full CPathfinder pass.
+/// Map is cut into square clusters and every cluster is split into regions of connected passable tiles of same layer.
+/// Regions are connected with their neighbours across cluster borders, with teleports and with boats or shipyards.
+/// Distances are only estimations: guards, hero specific bonuses and exact tile costs are ignored.
+class DLL_LINKAGE CHierarchicalPathfinder
+{
+public:
+	typedef si32 TRegionId;
+	static const TRegionId INVALID_REGION;
+	static const int CLUSTER_SIZE;
+
+	struct Portal
+	{
+		int3 exit; //last tile in source region
+		int3 entry; //first tile in destination region
+		int transitionCost;
+	};
+
+	struct Region
+	{
+		int3 center; //region tile closest to region centroid
+		bool water;
+		int tileCost; //average cost of region tiles
+		std::map<TRegionId, int> edges; //cheapest known cost to every reachable neighbour region
+		std::map<TRegionId, std::vector<Portal>> portals; //all tile pairs connecting region with every neighbour region
+		std::vector<TRegionId> incoming; //regions with edge to this region
+	};
+
+	/// Only tiles and objects visible through callback are used, so graph doesn't reveal anything to player
+	CHierarchicalPathfinder(const CGameInfoCallback * cb, PlayerColor player);
+
+	TRegionId getRegion(const int3 & tile) const;
+	const Region & getRegionInfo(TRegionId region) const;
+	size_t regionsCount() const;
+
+	/// Estimated movement points needed to get from src to dst or -1 if there is no known way
+	int getDistance(const int3 & src, const int3 & dst) const;
+
+private:
+	int3 sizes;
+	std::vector<TRegionId> tileRegions;
+	std::vector<Region> regions;
+
+	mutable boost::mutex distancesMx;
+	mutable std::map<TRegionId, std::vector<int>> distances; //distances from region to all other regions, filled on demand
+
+	int getIndex(const int3 & tile) const;
+	bool isPassable(const TerrainTile * tile) const;
+
+	void initializeRegions(const std::vector<const TerrainTile *> & tiles);
+	void linkNeighbours(const std::vector<const TerrainTile *> & tiles);
+	void linkObjects(const CGameInfoCallback * cb, PlayerColor player, const std::vector<const TerrainTile *> & tiles);
+	void addEdge(TRegionId from, const int3 & exit, TRegionId to, const int3 & entry, int transitionCost);
+
+	const std::vector<int> & getDistances(TRegionId source) const;
+	static int estimateCost(const int3 & src, const int3 & dst, int tileCost);
+};
@@ -4,6 +4,7 @@
 #include "filesystem/FileStream.h"
 #include "filesystem/AdapterLoaders.h"
 #include "filesystem/CFilesystemLoader.h"
+#include "filesystem/CResourceIndexCache.h"
 
 #include "CCreatureHandler.h"
 #include "CArtHandler.h"
@@ -14,6 +15,9 @@
 #include "CStopWatch.h"
 #include "IHandlerBase.h"
 #include "spells/CSpellHandler.h"
+#include "CThreadHelper.h"
+
+#include <zlib.h>
 
 /*
  * CModHandler.cpp, part of VCMI engine
@@ -451,6 +455,17 @@ void CContentHandler::preloadData(CModInfo & mod)
 		mod.validation = CModInfo::FAILED;
 }
 
+std::vector<ResourceID> CContentHandler::getDataFiles(const CModInfo & mod) const
+{
+	std::vector<ResourceID> ret;
+	for(auto & handler : handlers)
+	{
+		for(auto & file : mod.config[handler.first].convertTo<std::vector<std::string> >())
+			ret.push_back(ResourceID(file, EResType::TEXT));
+	}
+	return ret;
+}
+
 void CContentHandler::load(CModInfo & mod)
 {
 	bool validate = (mod.validation != CModInfo::PASSED);
@@ -507,6 +522,17 @@ JsonNode CModInfo::saveLocalData() const
 	conf["active"].Bool() = enabled;
 	conf["validated"].Bool() = validation != FAILED;
 	conf["checksum"].String() = stream.str();
+
+	for(auto & file : fileChecksums)
+	{
+		std::ostringstream fileStream;
+		fileStream << std::noshowbase << std::hex << std::setw(8) << std::setfill('0') << file.second.checksum;
+
+		JsonNode & entry = conf["files"][file.first];
+		entry["modified"].Float() = file.second.modified;
+		entry["size"].Float() = file.second.size;
+		entry["checksum"].String() = fileStream.str();
+	}
 	return conf;
 }
 
@@ -544,6 +570,15 @@ void CModInfo::loadLocalData(const JsonNode & data)
 		enabled   = data["active"].Bool();
 		validated = data["validated"].Bool();
 		checksum  = strtol(data["checksum"].String().c_str(), nullptr, 16);
+
+		for(auto & file : data["files"].Struct())
+		{
+			FileChecksum entry;
+			entry.modified = file.second["modified"].Float();
+			entry.size = file.second["size"].Float();
+			entry.checksum = strtoul(file.second["checksum"].String().c_str(), nullptr, 16);
+			fileChecksums[file.first] = entry;
+		}
 	}
 
 	if (enabled)
@@ -818,7 +853,14 @@ static ISimpleResourceLoader * genModFilesystem(const std::string & modName, con
 		return CResourceHandler::createFileSystem(CModInfo::getModDir(modName), defaultFS);
 }
 
-static ui32 calculateModChecksum(const std::string modName, ISimpleResourceLoader * filesystem)
+static ui32 calculateFileChecksum(ISimpleResourceLoader * filesystem, const ResourceID & file)
+{
+	// zlib implementation gives same result as boost::crc_32_type but is several times faster
+	auto data = filesystem->load(file)->readAll();
+	return crc32(0, data.first.get(), data.second);
+}
+
+static ui32 calculateModChecksum(const std::string modName, ISimpleResourceLoader * filesystem, std::map<std::string, CModInfo::FileChecksum> & fileChecksums)
 {
 	boost::crc_32_type modChecksum;
 	// first - add current VCMI version into checksum to force re-validation on VCMI updates
@@ -840,10 +882,56 @@ static ui32 calculateModChecksum(const std::string modName, ISimpleResourceLoade
 				 boost::starts_with(resID.getName(), "CONFIG"));
 	});
 
-	for (const ResourceID & file : files)
+	// files on disk with same modification time and size as on previous launch are not read,
+	// files modified within the last second are neither taken from nor put into cache,
+	// all other files are read and hashed in parallel. Order of files in checksum stays the same
+	std::vector<ResourceID> fileList(files.begin(), files.end());
+	std::vector<CModInfo::FileChecksum> checksums(fileList.size());
+	std::vector<ui8> onDisk(fileList.size(), false);
+	const std::time_t now = std::time(nullptr);
+	std::vector<Task> tasks;
+	for (size_t i = 0; i < fileList.size(); i++)
 	{
-		ui32 fileChecksum = filesystem->load(file)->calculateCRC32();
-		modChecksum.process_bytes(reinterpret_cast<const void *>(&fileChecksum), sizeof(fileChecksum));
+		tasks.push_back([&, i]()
+		{
+			const ResourceID & file = fileList[i];
+			CModInfo::FileChecksum & result = checksums[i];
+			auto path = filesystem->getResourceName(file);
+			boost::system::error_code ec;
+			if (path)
+			{
+				result.modified = boost::filesystem::last_write_time(*path, ec);
+				if (!ec)
+					result.size = boost::filesystem::file_size(*path, ec);
+				//timestamps have one second resolution, so change made in same second as hashing may go unnoticed
+				onDisk[i] = !ec && result.modified + 1 < now;
+			}
+
+			auto cached = fileChecksums.find(file.getName());
+			if (onDisk[i] && cached != fileChecksums.end()
+				&& cached->second.modified == result.modified && cached->second.size == result.size)
+			{
+				result.checksum = cached->second.checksum;
+			}
+			else
+			{
+				result.checksum = calculateFileChecksum(filesystem, file);
+			}
+		});
+	}
+	const int threads = std::min<int>(tasks.size(), std::max<ui32>(1, boost::thread::hardware_concurrency()));
+	if (threads > 0)
+	{
+		CThreadHelper helper(&tasks, threads);
+		helper.run();
+	}
+
+	fileChecksums.clear();
+	for (size_t i = 0; i < fileList.size(); i++)
+	{
+		modChecksum.process_bytes(reinterpret_cast<const void *>(&checksums[i].checksum), sizeof(checksums[i].checksum));
+		if (onDisk[i])
+			fileChecksums[fileList[i].getName()] = checksums[i];
 	}
 	return modChecksum.checksum();
 }
@@ -852,13 +940,14 @@ void CModHandler::loadModFilesystems()
 {
 	activeMods = resolveDependencies(activeMods);
 
-	coreMod.updateChecksum(calculateModChecksum("core", CResourceHandler::get("core")));
+	coreMod.updateChecksum(calculateModChecksum("core", CResourceHandler::get("core"), coreMod.fileChecksums));
 
 	for(std::string & modName : activeMods)
 	{
 		CModInfo & mod = allMods[modName];
 		CResourceHandler::addFilesystem("data", modName, genModFilesystem(modName, mod.config));
 	}
+	CResourceIndexCache::get().save();
 }
 
 CModInfo & CModHandler::getModData(TModID modId)
@@ -882,7 +971,7 @@ void CModHandler::initializeConfig()
 
 void CModHandler::load()
 {
-	CStopWatch totalTime, timer;
+	CWallClockStopWatch totalTime, timer; //prefetching runs on several threads, CPU time of process would be misleading
 
 	CContentHandler content;
 	logGlobal->infoStream() << "\tInitializing content handler: " << timer.getDiff() << " ms";
@@ -890,14 +979,24 @@ void CModHandler::load()
 	for(const TModID & modName : activeMods)
 	{
 		logGlobal->traceStream() << "Generating checksum for " << modName;
-		allMods[modName].updateChecksum(calculateModChecksum(modName, CResourceHandler::get(modName)));
+		CModInfo & mod = allMods[modName];
+		mod.updateChecksum(calculateModChecksum(modName, CResourceHandler::get(modName), mod.fileChecksums));
 	}
+	logGlobal->infoStream() << "\tCalculating mod checksums: " << timer.getDiff() << " ms";
+
+	// read and decompress all data files in parallel, parsing below will take them from memory
+	std::vector<ResourceID> dataFiles = content.getDataFiles(coreMod);
+	for(const TModID & modName : activeMods)
+		boost::range::copy(content.getDataFiles(allMods[modName]), std::back_inserter(dataFiles));
+	auto prefetched = CResourceHandler::get()->prefetch(dataFiles);
+	logGlobal->infoStream() << "\tPrefetching " << dataFiles.size() << " mod data files: " << timer.getDiff() << " ms";
 
 	// first - load virtual "core" mod that contains all data
 	// TODO? move all data into real mods? RoE, AB, SoD, WoG
 	content.preloadData(coreMod);
 	for(const TModID & modName : activeMods)
 		content.preloadData(allMods[modName]);
+	prefetched.reset();
 	logGlobal->infoStream() << "\tParsing mod data: " << timer.getDiff() << " ms";
 
 	content.load(coreMod);
@@ -928,8 +1027,22 @@ void CModHandler::afterLoad()
 	}
 	modSettings["core"] = coreMod.saveLocalData();
 
-	FileStream file(*CResourceHandler::get()->getResourceName(ResourceID("config/modSettings.json")), std::ofstream::out | std::ofstream::trunc);
-	file << modSettings;
+	//several processes (client and server, workers of map generator) may write it at the same time,
+	//so every one writes its own temporary file and replaces settings with complete file at once
+	const boost::filesystem::path path = *CResourceHandler::get()->getResourceName(ResourceID("config/modSettings.json"));
+	const boost::filesystem::path tmpPath = path.string() + "." + boost::filesystem::unique_path().string() + ".tmp";
+	{
+		FileStream file(tmpPath, std::ofstream::out | std::ofstream::trunc);
+		file << modSettings;
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::rename(tmpPath, path, ec);
+	if(ec)
+	{
+		logGlobal->errorStream() << "Failed to save " << path << ": " << ec.message();
+		boost::filesystem::remove(tmpPath, ec);
+	}
 }
 
 std::string CModHandler::normalizeIdentifier(const std::string & scope, const std::string & remoteScope, const std::string & identifier) const
@@ -152,6 +152,9 @@ public:
 	/// actually loads data in mod
 	void load(CModInfo & mod);
 
+	/// lists all data files of mod, e.g. to prefetch them before preloadData
+	std::vector<ResourceID> getDataFiles(const CModInfo & mod) const;
+
 	/// all data was loaded, time for final validation / integration
 	void afterLoadFinalization();
 };
@@ -184,6 +187,16 @@ public:
 	/// CRC-32 checksum of the mod
 	ui32 checksum;
 
+	struct FileChecksum
+	{
+		si64 modified;
+		si64 size;
+		ui32 checksum;
+	};
+	/// checksums of mod files with their modification time and size, files that were not changed are not read again
+	/// kept only in local mod settings, not in saved games
+	std::map<std::string, FileChecksum> fileChecksums;
+
 	/// true if mod is enabled
 	bool enabled;
 
@@ -35,16 +35,23 @@ CPathfinder::PathfinderOptions::PathfinderOptions()
 	lightweightFlyingMode = settings["pathfinder"]["lightweightFlyingMode"].Bool();
 	oneTurnSpecialLayersLimit = settings["pathfinder"]["oneTurnSpecialLayersLimit"].Bool();
 	originalMovementRules = settings["pathfinder"]["originalMovementRules"].Bool();
+
+	incrementalUpdates = settings["pathfinder"]["incrementalUpdates"].Bool();
+	verifyIncrementalUpdates = settings["pathfinder"]["verifyIncrementalUpdates"].Bool();
 }
 
 CPathfinder::CPathfinder(CPathsInfo & _out, CGameState * _gs, const CGHeroInstance * _hero)
-	: CGameInfoCallback(_gs, boost::optional<PlayerColor>()), out(_out), hero(_hero), FoW(getPlayerTeam(hero->tempOwner)->fogOfWarMap), patrolTiles({})
+	: CGameInfoCallback(_gs, boost::optional<PlayerColor>()), out(_out), hero(_hero), FoW(getPlayerTeam(hero->tempOwner)->fogOfWarMap), patrolTiles({}), pq(NodeComparer(&_out))
 {
 	assert(hero);
 	assert(hero == getHero(hero->id));
 
+	repairPossible = options.incrementalUpdates && out.needsRepair()
+		&& out.hero == hero && out.hpos == hero->getPosition(false) && out.heroMovement == hero->movement;
+
 	out.hero = hero;
 	out.hpos = hero->getPosition(false);
+	out.heroMovement = hero->movement;
 	if(!isInTheMap(out.hpos)/* || !gs->map->isInTheMap(dest)*/) //check input
 	{
 		logGlobal->errorStream() << "CGameState::calculatePaths: Hero outside the gs->map? How dare you...";
@@ -54,7 +61,6 @@ CPathfinder::CPathfinder(CPathsInfo & _out, CGameState * _gs, const CGHeroInstan
 	hlp = make_unique<CPathfinderHelper>(hero, options);
 
 	initializePatrol();
-	initializeGraph();
 	neighbourTiles.reserve(8);
 	neighbours.reserve(16);
 }
@@ -66,11 +72,11 @@ void CPathfinder::calculatePaths()
 		if(!options.oneTurnSpecialLayersLimit)
 			return true;
 
-		if(cp->layer == ELayer::WATER)
+		if(cpLayer == ELayer::WATER)
 			return false;
-		if(cp->layer == ELayer::AIR)
+		if(cpLayer == ELayer::AIR)
 		{
-			if(options.originalMovementRules && cp->accessible == CGPathNode::ACCESSIBLE)
+			if(options.originalMovementRules && out.accessible[cp] == CGPathNode::ACCESSIBLE)
 				return true;
 			else
 				return false;
@@ -81,11 +87,11 @@ void CPathfinder::calculatePaths()
 
 	auto isBetterWay = [&](int remains, int turn) -> bool
 	{
-		if(dp->turns == 0xff) //we haven't been here before
+		if(out.turns[dp] == 0xff) //we haven't been here before
 			return true;
-		else if(dp->turns > turn)
+		else if(out.turns[dp] > turn)
 			return true;
-		else if(dp->turns >= turn && dp->moveRemains < remains) //this route is faster
+		else if(out.turns[dp] >= turn && out.moveRemains[dp] < remains) //this route is faster
 			return true;
 
 		return false;
@@ -93,30 +99,43 @@ void CPathfinder::calculatePaths()
 
 	//logGlobal->infoStream() << boost::format("Calculating paths for hero %s (adress  %d) of player %d") % hero->name % hero % hero->tempOwner;
 
-	//initial tile - set cost on 0 and add to the queue
-	CGPathNode * initialNode = out.getNode(out.hpos, hero->boat ? ELayer::SAIL : ELayer::LAND);
-	initialNode->turns = 0;
-	initialNode->moveRemains = hero->movement;
-	if(isHeroPatrolLocked())
-		return;
+	if(repairPossible)
+		repairPossible = initializeRepair();
+
+	out.invalidTiles.clear();
+	if(!repairPossible)
+	{
+		initializeGraph();
+
+		//initial tile - set cost on 0 and add to the queue
+		const TNodeIndex initialNode = out.getIndex(out.hpos, hero->boat ? ELayer::SAIL : ELayer::LAND);
+		out.turns[initialNode] = 0;
+		out.moveRemains[initialNode] = hero->movement;
+		if(isHeroPatrolLocked())
+			return;
+
+		pq.push(initialNode);
+	}
 
-	pq.push(initialNode);
 	while(!pq.empty())
 	{
 		cp = pq.top();
 		pq.pop();
-		cp->locked = true;
+		out.locked[cp] = true;
+		cpCoord = out.getCoord(cp);
+		cpLayer = out.getLayer(cp);
 
-		int movement = cp->moveRemains, turn = cp->turns;
+		int movement = out.moveRemains[cp], turn = out.turns[cp];
 		hlp->updateTurnInfo(turn);
 		if(!movement)
 		{
 			hlp->updateTurnInfo(++turn);
-			movement = hlp->getMaxMovePoints(cp->layer);
+			movement = hlp->getMaxMovePoints(cpLayer);
 			if(!passOneTurnLimitCheck())
 				continue;
 		}
-		ct = &gs->map->getTile(cp->coord);
+		ct = &gs->map->getTile(cpCoord);
+		ctInfo = &gs->map->getMovementInfo(cpCoord);
 		ctObj = ct->topVisitableObj(isSourceInitialPosition());
 
 		//add accessible neighbouring nodes to the queue
@@ -127,6 +146,7 @@ void CPathfinder::calculatePaths()
 				continue;
 
 			dt = &gs->map->getTile(neighbour);
+			dtInfo = &gs->map->getMovementInfo(neighbour);
 			dtObj = dt->topVisitableObj();
 			for(ELayer i = ELayer::LAND; i <= ELayer::AIR; i.advance(1))
 			{
@@ -134,18 +154,20 @@ void CPathfinder::calculatePaths()
 					continue;
 
 				/// Check transition without tile accessability rules
-				if(cp->layer != i && !isLayerTransitionPossible(i))
+				if(cpLayer != i && !isLayerTransitionPossible(i))
 					continue;
 
-				dp = out.getNode(neighbour, i);
-				if(dp->locked)
+				dp = out.getIndex(neighbour, i);
+				dpCoord = neighbour;
+				dpLayer = i;
+				if(out.locked[dp])
 					continue;
 
-				if(dp->accessible == CGPathNode::NOT_SET)
+				if(out.accessible[dp] == CGPathNode::NOT_SET)
 					continue;
 
 				/// Check transition using tile accessability rules
-				if(cp->layer != i && !isLayerTransitionPossible())
+				if(cpLayer != i && !isLayerTransitionPossible())
 					continue;
 
 				if(!isMovementToDestPossible())
@@ -153,14 +175,14 @@ void CPathfinder::calculatePaths()
 
 				destAction = getDestAction();
 				int turnAtNextTile = turn, moveAtNextTile = movement;
-				int cost = CPathfinderHelper::getMovementCost(hero, cp->coord, dp->coord, ct, dt, moveAtNextTile, hlp->getTurnInfo());
+				int cost = CPathfinderHelper::getMovementCost(hero, cpCoord, dpCoord, ctInfo, dtInfo, moveAtNextTile, hlp->getTurnInfo());
 				int remains = moveAtNextTile - cost;
 				if(remains < 0)
 				{
 					//occurs rarely, when hero with low movepoints tries to leave the road
 					hlp->updateTurnInfo(++turnAtNextTile);
 					moveAtNextTile = hlp->getMaxMovePoints(i);
-					cost = CPathfinderHelper::getMovementCost(hero, cp->coord, dp->coord, ct, dt, moveAtNextTile, hlp->getTurnInfo()); //cost must be updated, movement points changed :(
+					cost = CPathfinderHelper::getMovementCost(hero, cpCoord, dpCoord, ctInfo, dtInfo, moveAtNextTile, hlp->getTurnInfo()); //cost must be updated, movement points changed :(
 					remains = moveAtNextTile - cost;
 				}
 				if(destAction == CGPathNode::EMBARK || destAction == CGPathNode::DISEMBARK)
@@ -172,13 +194,13 @@ void CPathfinder::calculatePaths()
 				}
 
 				if(isBetterWay(remains, turnAtNextTile) &&
-					((cp->turns == turnAtNextTile && remains) || passOneTurnLimitCheck()))
+					((out.turns[cp] == turnAtNextTile && remains) || passOneTurnLimitCheck()))
 				{
-					assert(dp != cp->theNodeBefore); //two tiles can't point to each other
-					dp->moveRemains = remains;
-					dp->turns = turnAtNextTile;
-					dp->theNodeBefore = cp;
-					dp->action = destAction;
+					assert(dp != out.parents[cp]); //two tiles can't point to each other
+					out.moveRemains[dp] = remains;
+					out.turns[dp] = turnAtNextTile;
+					out.parents[dp] = cp;
+					out.actions[dp] = destAction;
 
 					if(isMovementAfterDestPossible())
 						pq.push(dp);
@@ -190,37 +212,42 @@ void CPathfinder::calculatePaths()
 		addTeleportExits();
 		for(auto & neighbour : neighbours)
 		{
-			dp = out.getNode(neighbour, cp->layer);
-			if(dp->locked)
+			dp = out.getIndex(neighbour, cpLayer);
+			dpCoord = neighbour;
+			dpLayer = cpLayer;
+			if(out.locked[dp])
 				continue;
 			/// TODO: We may consider use invisible exits on FoW border in future
 			/// Useful for AI when at least one tile around exit is visible and passable
 			/// Objects are usually visible on FoW border anyway so it's not cheating.
 			///
 			/// For now it's disabled as it's will cause crashes in movement code.
-			if(dp->accessible == CGPathNode::BLOCKED)
+			if(out.accessible[dp] == CGPathNode::BLOCKED)
 				continue;
 
 			if(isBetterWay(movement, turn))
 			{
 				dtObj = gs->map->getTile(neighbour).topVisitableObj();
 
-				dp->moveRemains = movement;
-				dp->turns = turn;
-				dp->theNodeBefore = cp;
-				dp->action = getTeleportDestAction();
-				if(dp->action == CGPathNode::TELEPORT_NORMAL)
+				out.moveRemains[dp] = movement;
+				out.turns[dp] = turn;
+				out.parents[dp] = cp;
+				out.actions[dp] = getTeleportDestAction();
+				if(out.actions[dp] == CGPathNode::TELEPORT_NORMAL)
 					pq.push(dp);
 			}
 		}
 	} //queue loop
+
+	if(repairPossible)
+		finalizeRepair();
 }
 
 void CPathfinder::addNeighbours()
 {
 	neighbours.clear();
 	neighbourTiles.clear();
-	CPathfinderHelper::getNeighbours(gs->map, *ct, cp->coord, neighbourTiles, boost::logic::indeterminate, cp->layer == ELayer::SAIL);
+	CPathfinderHelper::getNeighbours(gs->map, *ctInfo, cpCoord, neighbourTiles, boost::logic::indeterminate, cpLayer == ELayer::SAIL);
 	if(isSourceVisitableObj())
 	{
 		for(int3 tile: neighbourTiles)
@@ -298,10 +325,10 @@ bool CPathfinder::isPatrolMovementAllowed(const int3 & dst) const
 bool CPathfinder::isLayerTransitionPossible(const ELayer destLayer) const
 {
 	/// No layer transition allowed when previous node action is BATTLE
-	if(cp->action == CGPathNode::BATTLE)
+	if(out.actions[cp] == CGPathNode::BATTLE)
 		return false;
 
-	switch(cp->layer)
+	switch(cpLayer)
 	{
 	case ELayer::LAND:
 		if(destLayer == ELayer::AIR)
@@ -343,13 +370,13 @@ bool CPathfinder::isLayerTransitionPossible(const ELayer destLayer) const
 
 bool CPathfinder::isLayerTransitionPossible() const
 {
-	switch(cp->layer)
+	switch(cpLayer)
 	{
 	case ELayer::LAND:
-		if(dp->layer == ELayer::SAIL)
+		if(dpLayer == ELayer::SAIL)
 		{
 			/// Cannot enter empty water tile from land -> it has to be visitable
-			if(dp->accessible == CGPathNode::ACCESSIBLE)
+			if(out.accessible[dp] == CGPathNode::ACCESSIBLE)
 				return false;
 		}
 
@@ -357,7 +384,7 @@ bool CPathfinder::isLayerTransitionPossible() const
 
 	case ELayer::SAIL:
 		//tile must be accessible -> exception: unblocked blockvis tiles -> clear but guarded by nearby monster coast
-		if((dp->accessible != CGPathNode::ACCESSIBLE && (dp->accessible != CGPathNode::BLOCKVIS || dt->blocked))
+		if((out.accessible[dp] != CGPathNode::ACCESSIBLE && (out.accessible[dp] != CGPathNode::BLOCKVIS || dt->blocked))
 			|| dt->visitable)  //TODO: passableness problem -> town says it's passable (thus accessible) but we obviously can't disembark onto town gate
 		{
 			return false;
@@ -368,15 +395,15 @@ bool CPathfinder::isLayerTransitionPossible() const
 	case ELayer::AIR:
 		if(options.originalMovementRules)
 		{
-			if((cp->accessible != CGPathNode::ACCESSIBLE &&
-				cp->accessible != CGPathNode::VISITABLE) &&
-				(dp->accessible != CGPathNode::VISITABLE &&
-				 dp->accessible != CGPathNode::ACCESSIBLE))
+			if((out.accessible[cp] != CGPathNode::ACCESSIBLE &&
+				out.accessible[cp] != CGPathNode::VISITABLE) &&
+				(out.accessible[dp] != CGPathNode::VISITABLE &&
+				 out.accessible[dp] != CGPathNode::ACCESSIBLE))
 			{
 				return false;
 			}
 		}
-		else if(cp->accessible != CGPathNode::ACCESSIBLE &&	dp->accessible != CGPathNode::ACCESSIBLE)
+		else if(out.accessible[cp] != CGPathNode::ACCESSIBLE &&	out.accessible[dp] != CGPathNode::ACCESSIBLE)
 		{
 			/// Hero that fly can only land on accessible tiles
 			return false;
@@ -385,7 +412,7 @@ bool CPathfinder::isLayerTransitionPossible() const
 		break;
 
 	case ELayer::WATER:
-		if(dp->accessible != CGPathNode::ACCESSIBLE && dp->accessible != CGPathNode::VISITABLE)
+		if(out.accessible[dp] != CGPathNode::ACCESSIBLE && out.accessible[dp] != CGPathNode::VISITABLE)
 		{
 			/// Hero that walking on water can transit to accessible and visitable tiles
 			/// Though hero can't interact with blocking visit objects while standing on water
@@ -400,17 +427,17 @@ bool CPathfinder::isLayerTransitionPossible() const
 
 bool CPathfinder::isMovementToDestPossible() const
 {
-	if(dp->accessible == CGPathNode::BLOCKED)
+	if(out.accessible[dp] == CGPathNode::BLOCKED)
 		return false;
 
-	switch(dp->layer)
+	switch(dpLayer)
 	{
 	case ELayer::LAND:
-		if(!canMoveBetween(cp->coord, dp->coord))
+		if(!canMoveBetween(cpCoord, dpCoord))
 			return false;
 		if(isSourceGuarded())
 		{
-			if(!(options.originalMovementRules && cp->layer == ELayer::AIR) &&
+			if(!(options.originalMovementRules && cpLayer == ELayer::AIR) &&
 				!isDestinationGuardian()) // Can step into tile of guard
 			{
 				return false;
@@ -420,16 +447,16 @@ bool CPathfinder::isMovementToDestPossible() const
 		break;
 
 	case ELayer::SAIL:
-		if(!canMoveBetween(cp->coord, dp->coord))
+		if(!canMoveBetween(cpCoord, dpCoord))
 			return false;
 		if(isSourceGuarded())
 		{
 			// Hero embarked a boat standing on a guarded tile -> we must allow to move away from that tile
-			if(cp->action != CGPathNode::EMBARK && !isDestinationGuardian())
+			if(out.actions[cp] != CGPathNode::EMBARK && !isDestinationGuardian())
 				return false;
 		}
 
-		if(cp->layer == ELayer::LAND)
+		if(cpLayer == ELayer::LAND)
 		{
 			if(!isDestVisitableObj())
 				return false;
@@ -446,7 +473,7 @@ bool CPathfinder::isMovementToDestPossible() const
 		break;
 
 	case ELayer::WATER:
-		if(!canMoveBetween(cp->coord, dp->coord) || dp->accessible != CGPathNode::ACCESSIBLE)
+		if(!canMoveBetween(cpCoord, dpCoord) || out.accessible[dp] != CGPathNode::ACCESSIBLE)
 			return false;
 		if(isDestinationGuarded())
 			return false;
@@ -512,10 +539,10 @@ bool CPathfinder::isMovementAfterDestPossible() const
 CGPathNode::ENodeAction CPathfinder::getDestAction() const
 {
 	CGPathNode::ENodeAction action = CGPathNode::NORMAL;
-	switch(dp->layer)
+	switch(dpLayer)
 	{
 	case ELayer::LAND:
-		if(cp->layer == ELayer::SAIL)
+		if(cpLayer == ELayer::SAIL)
 		{
 			// TODO: Handle dismebark into guarded areaa
 			action = CGPathNode::DISEMBARK;
@@ -604,12 +631,12 @@ CGPathNode::ENodeAction CPathfinder::getTeleportDestAction() const
 
 bool CPathfinder::isSourceInitialPosition() const
 {
-	return cp->coord == out.hpos;
+	return cpCoord == out.hpos;
 }
 
 bool CPathfinder::isSourceVisitableObj() const
 {
-	return isVisitableObj(ctObj, cp->layer);
+	return isVisitableObj(ctObj, cpLayer);
 }
 
 bool CPathfinder::isSourceGuarded() const
@@ -619,7 +646,7 @@ bool CPathfinder::isSourceGuarded() const
 	/// - Map start with hero on guarded tile
 	/// - Dimention door used
 	/// TODO: check what happen when there is several guards
-	if(gs->guardingCreaturePosition(cp->coord).valid() && !isSourceInitialPosition())
+	if(gs->guardingCreaturePosition(cpCoord).valid() && !isSourceInitialPosition())
 	{
 		return true;
 	}
@@ -629,15 +656,15 @@ bool CPathfinder::isSourceGuarded() const
 
 bool CPathfinder::isDestVisitableObj() const
 {
-	return isVisitableObj(dtObj, dp->layer);
+	return isVisitableObj(dtObj, dpLayer);
 }
 
 bool CPathfinder::isDestinationGuarded(const bool ignoreAccessibility) const
 {
 	/// isDestinationGuarded is exception needed for garrisons.
 	/// When monster standing behind garrison it's visitable and guarded at the same time.
-	if(gs->guardingCreaturePosition(dp->coord).valid()
-		&& (ignoreAccessibility || dp->accessible == CGPathNode::BLOCKVIS))
+	if(gs->guardingCreaturePosition(dpCoord).valid()
+		&& (ignoreAccessibility || out.accessible[dp] == CGPathNode::BLOCKVIS))
 	{
 		return true;
 	}
@@ -647,7 +674,7 @@ bool CPathfinder::isDestinationGuarded(const bool ignoreAccessibility) const
 
 bool CPathfinder::isDestinationGuardian() const
 {
-	return gs->guardingCreaturePosition(cp->coord) == dp->coord;
+	return gs->guardingCreaturePosition(cpCoord) == dpCoord;
 }
 
 void CPathfinder::initializePatrol()
@@ -669,12 +696,7 @@ void CPathfinder::initializePatrol()
 
 void CPathfinder::initializeGraph()
 {
-	auto updateNode = [&](int3 pos, ELayer layer, const TerrainTile * tinfo)
-	{
-		auto node = out.getNode(pos, layer);
-		auto accessibility = evaluateAccessibility(pos, tinfo, layer);
-		node->update(pos, layer, accessibility);
-	};
+	out.resetNodes();
 
 	int3 pos;
 	for(pos.x=0; pos.x < out.sizes.x; ++pos.x)
@@ -682,30 +704,207 @@ void CPathfinder::initializeGraph()
 		for(pos.y=0; pos.y < out.sizes.y; ++pos.y)
 		{
 			for(pos.z=0; pos.z < out.sizes.z; ++pos.z)
+				initializeTile(pos);
+		}
+	}
+}
+
+void CPathfinder::initializeTile(const int3 & pos)
+{
+	auto updateNode = [&](ELayer layer, const TerrainTile * tinfo)
+	{
+		auto accessibility = evaluateAccessibility(pos, tinfo, layer);
+		out.updateNode(out.getIndex(pos, layer), accessibility);
+	};
+
+	const TerrainTile * tinfo = &gs->map->getTile(pos);
+	switch(tinfo->terType)
+	{
+	case ETerrainType::ROCK:
+		break;
+
+	case ETerrainType::WATER:
+		updateNode(ELayer::SAIL, tinfo);
+		if(options.useFlying)
+			updateNode(ELayer::AIR, tinfo);
+		if(options.useWaterWalking)
+			updateNode(ELayer::WATER, tinfo);
+		break;
+
+	default:
+		updateNode(ELayer::LAND, tinfo);
+		if(options.useFlying)
+			updateNode(ELayer::AIR, tinfo);
+		break;
+	}
+}
+
+bool CPathfinder::initializeRepair()
+{
+	enum ERepairState : ui8
+	{
+		UNKNOWN_STATE = 0,
+		AFFECTED, //path to node goes through changed tile, node must be recalculated
+		UNAFFECTED
+	};
+
+	if(patrolState != PATROL_NONE || options.useCastleGate)
+		return false;
+
+	auto isTeleportTile = [&](const int3 & pos) -> bool
+	{
+		for(auto obj : gs->map->getTile(pos).visitableObjects)
+		{
+			if(dynamic_cast<const CGTeleport *>(obj))
+				return true;
+		}
+		return false;
+	};
+
+	/// Guarded zones and visitable directions affect movement up to one tile around changed object
+	std::unordered_set<int3, ShashInt3> changedTiles;
+	for(auto & tile : out.invalidTiles)
+	{
+		for(int dx = -1; dx <= 1; dx++)
+		{
+			for(int dy = -1; dy <= 1; dy++)
 			{
-				const TerrainTile * tinfo = &gs->map->getTile(pos);
-				switch(tinfo->terType)
+				const int3 pos = tile + int3(dx, dy, 0);
+				if(isInTheMap(pos))
+					changedTiles.insert(pos);
+			}
+		}
+	}
+
+	for(auto & tile : changedTiles)
+	{
+		/// Teleporters connect distant tiles so changes around them are not local
+		if(tile == out.hpos || isTeleportTile(tile))
+			return false;
+	}
+
+	const size_t nodesCount = out.nodesCount();
+	std::vector<ui8> state(nodesCount, UNKNOWN_STATE);
+	for(auto & tile : changedTiles)
+	{
+		for(ELayer i = ELayer::LAND; i < ELayer::NUM_LAYERS; i.advance(1))
+			state[out.getIndex(tile, i)] = AFFECTED;
+	}
+
+	/// Node is affected when changed tile is somewhere on its path
+	std::vector<TNodeIndex> chain;
+	for(TNodeIndex i = 0; i < nodesCount; i++)
+	{
+		TNodeIndex node = i;
+		while(node != CPathsInfo::INVALID_NODE && state[node] == UNKNOWN_STATE)
+		{
+			chain.push_back(node);
+			node = out.parents[node];
+		}
+
+		const ui8 result = node != CPathsInfo::INVALID_NODE ? state[node] : static_cast<ui8>(UNAFFECTED);
+		for(auto elem : chain)
+			state[elem] = result;
+		chain.clear();
+	}
+
+	for(TNodeIndex i = 0; i < nodesCount; i++)
+	{
+		if(state[i] != AFFECTED || !out.reachable(i))
+			continue;
+
+		if(out.actions[i] >= CGPathNode::TELEPORT_NORMAL || isTeleportTile(out.getCoord(i)))
+			return false;
+	}
+
+	lockedBeforeRepair.assign(nodesCount, false);
+	for(TNodeIndex i = 0; i < nodesCount; i++)
+	{
+		lockedBeforeRepair[i] = out.locked[i] && state[i] == UNAFFECTED;
+		out.locked[i] = false;
+		if(state[i] == AFFECTED)
+			out.updateNode(i, out.accessible[i]);
+	}
+
+	for(auto & tile : changedTiles)
+		initializeTile(tile);
+
+	/// Search continue from every expanded node that border with reset ones
+	std::vector<bool> queued(nodesCount, false);
+	for(TNodeIndex i = 0; i < nodesCount; i++)
+	{
+		if(state[i] != AFFECTED || out.accessible[i] == CGPathNode::NOT_SET)
+			continue;
+
+		const int3 coord = out.getCoord(i);
+		for(int dx = -1; dx <= 1; dx++)
+		{
+			for(int dy = -1; dy <= 1; dy++)
+			{
+				const int3 pos = coord + int3(dx, dy, 0);
+				if(!isInTheMap(pos))
+					continue;
+
+				for(ELayer layer = ELayer::LAND; layer < ELayer::NUM_LAYERS; layer.advance(1))
 				{
-				case ETerrainType::ROCK:
-					break;
-
-				case ETerrainType::WATER:
-					updateNode(pos, ELayer::SAIL, tinfo);
-					if(options.useFlying)
-						updateNode(pos, ELayer::AIR, tinfo);
-					if(options.useWaterWalking)
-						updateNode(pos, ELayer::WATER, tinfo);
-					break;
-
-				default:
-					updateNode(pos, ELayer::LAND, tinfo);
-					if(options.useFlying)
-						updateNode(pos, ELayer::AIR, tinfo);
-					break;
+					const TNodeIndex node = out.getIndex(pos, layer);
+					if(state[node] == UNAFFECTED && lockedBeforeRepair[node] && !queued[node])
+					{
+						queued[node] = true;
+						pq.push(node);
+					}
 				}
 			}
 		}
 	}
+
+	return true;
+}
+
+void CPathfinder::finalizeRepair()
+{
+	for(TNodeIndex i = 0; i < lockedBeforeRepair.size(); i++)
+	{
+		if(lockedBeforeRepair[i])
+			out.locked[i] = true;
+	}
+
+	if(options.verifyIncrementalUpdates)
+		verifyRepair();
+}
+
+void CPathfinder::verifyRepair()
+{
+	CPathsInfo reference(out.sizes);
+	CPathfinder pathfinder(reference, gs, hero);
+	pathfinder.calculatePaths();
+
+	int costMismatches = 0, parentMismatches = 0;
+	for(TNodeIndex i = 0; i < out.nodesCount(); i++)
+	{
+		if(out.accessible[i] != reference.accessible[i] || out.turns[i] != reference.turns[i]
+			|| out.moveRemains[i] != reference.moveRemains[i] || out.actions[i] != reference.actions[i])
+		{
+			costMismatches++;
+		}
+		else if(out.parents[i] != reference.parents[i])
+			parentMismatches++; //path of same cost found through other node
+	}
+
+	if(!costMismatches && !parentMismatches)
+		return;
+
+	if(costMismatches)
+		logGlobal->errorStream() << boost::format("Repaired paths of hero %s differ from full recalculation in %d nodes") % hero->name % costMismatches;
+	else
+		logGlobal->debugStream() << boost::format("Repaired paths of hero %s use different equal cost paths in %d nodes") % hero->name % parentMismatches;
+
+	out.moveRemains = reference.moveRemains;
+	out.turns = reference.turns;
+	out.parents = reference.parents;
+	out.accessible = reference.accessible;
+	out.actions = reference.actions;
+	out.locked = reference.locked;
 }
 
 CGPathNode::EAccessibility CPathfinder::evaluateAccessibility(const int3 & pos, const TerrainTile * tinfo, const ELayer layer) const
@@ -855,12 +1054,21 @@ TurnInfo::BonusCache::BonusCache(TBonusListPtr bl)
 TurnInfo::TurnInfo(const CGHeroInstance * Hero, const int turn)
 	: hero(Hero), maxMovePointsLand(-1), maxMovePointsWater(-1)
 {
-	std::stringstream cachingStr;
-	cachingStr << "days_" << turn;
-
-	bonuses = hero->getAllBonuses(Selector::days(turn), nullptr, nullptr, cachingStr.str());
+	CWillLastDays willLastDays; //not Selector::days, it is shared by paths calculated concurrently
+	willLastDays(turn);
+	bonuses = hero->getAllBonuses(willLastDays, nullptr, nullptr, BonusCacheKey::days(turn));
 	bonusCache = make_unique<BonusCache>(bonuses);
 	nativeTerrain = hero->getNativeTerrain();
+
+	const int pathfindingLevel = hero->getSecSkillLevel(SecondarySkill::PATHFINDING);
+	terrainCosts.resize(GameConstants::TERRAIN_TYPES, GameConstants::BASE_MOVEMENT_COST);
+	for(int i = 0; i < GameConstants::TERRAIN_TYPES; i++)
+	{
+		if(nativeTerrain == i || (i < ETerrainType::ROCK && bonusCache->noTerrainPenalty[i]))
+			continue;
+
+		terrainCosts[i] = std::max<int>(VLC->heroh->terrCosts[i] - pathfindingLevel * 25, GameConstants::BASE_MOVEMENT_COST);
+	}
 }
 
 bool TurnInfo::isLayerAvailable(const EPathfindingLayer layer) const
@@ -924,6 +1132,32 @@ int TurnInfo::getMaxMovePoints(const EPathfindingLayer layer) const
 	return layer == EPathfindingLayer::SAIL ? maxMovePointsWater : maxMovePointsLand;
 }
 
+int TurnInfo::getTileCost(const TileMovementInfo & dest, const TileMovementInfo & from) const
+{
+	//if there is road both on dest and src tiles - use road movement cost
+	if(dest.roadType != ERoadType::NO_ROAD && from.roadType != ERoadType::NO_ROAD)
+	{
+		int road = std::min(dest.roadType, from.roadType); //used road ID
+		switch(road)
+		{
+		case ERoadType::DIRT_ROAD:
+			return 75;
+		case ERoadType::GRAVEL_ROAD:
+			return 65;
+		case ERoadType::COBBLESTONE_ROAD:
+			return 50;
+		default:
+			logGlobal->errorStream() << "Unknown road type: " << road << "... Something wrong!";
+			return GameConstants::BASE_MOVEMENT_COST;
+		}
+	}
+
+	if(!vstd::isValidIndex(terrainCosts, from.terType))
+		return GameConstants::BASE_MOVEMENT_COST;
+
+	return terrainCosts[from.terType];
+}
+
 CPathfinderHelper::CPathfinderHelper(const CGHeroInstance * Hero, const CPathfinder::PathfinderOptions & Options)
 	: turn(-1), hero(Hero), options(Options)
 {
@@ -985,7 +1219,7 @@ int CPathfinderHelper::getMaxMovePoints(const EPathfindingLayer layer) const
 	return turnsInfo[turn]->getMaxMovePoints(layer);
 }
 
-void CPathfinderHelper::getNeighbours(const CMap * map, const TerrainTile & srct, const int3 & tile, std::vector<int3> & vec, const boost::logic::tribool & onLand, const bool limitCoastSailing)
+void CPathfinderHelper::getNeighbours(const CMap * map, const TileMovementInfo & srct, const int3 & tile, std::vector<int3> & vec, const boost::logic::tribool & onLand, const bool limitCoastSailing)
 {
 	static const int3 dirs[] = {
 		int3(-1, +1, +0),	int3(0, +1, +0),	int3(+1, +1, +0),
@@ -999,7 +1233,7 @@ void CPathfinderHelper::getNeighbours(const CMap * map, const TerrainTile & srct
 		if(!map->isInTheMap(hlp))
 			continue;
 
-		const TerrainTile & hlpt = map->getTile(hlp);
+		const TileMovementInfo & hlpt = map->getMovementInfo(hlp);
 		if(hlpt.terType == ETerrainType::ROCK)
 			continue;
 
@@ -1010,25 +1244,25 @@ void CPathfinderHelper::getNeighbours(const CMap * map, const TerrainTile & srct
 // 		}
 
 		/// Following condition let us avoid diagonal movement over coast when sailing
-		if(srct.terType == ETerrainType::WATER && limitCoastSailing && hlpt.terType == ETerrainType::WATER && dir.x && dir.y) //diagonal move through water
+		if(srct.isWater() && limitCoastSailing && hlpt.isWater() && dir.x && dir.y) //diagonal move through water
 		{
 			int3 hlp1 = tile,
 				hlp2 = tile;
 			hlp1.x += dir.x;
 			hlp2.y += dir.y;
 
-			if(map->getTile(hlp1).terType != ETerrainType::WATER || map->getTile(hlp2).terType != ETerrainType::WATER)
+			if(!map->getMovementInfo(hlp1).isWater() || !map->getMovementInfo(hlp2).isWater())
 				continue;
 		}
 
-		if(indeterminate(onLand) || onLand == (hlpt.terType != ETerrainType::WATER))
+		if(indeterminate(onLand) || onLand == !hlpt.isWater())
 		{
 			vec.push_back(hlp);
 		}
 	}
 }
 
-int CPathfinderHelper::getMovementCost(const CGHeroInstance * h, const int3 & src, const int3 & dst, const TerrainTile * ct, const TerrainTile * dt, const int remainingMovePoints, const TurnInfo * ti, const bool checkLast)
+int CPathfinderHelper::getMovementCost(const CGHeroInstance * h, const int3 & src, const int3 & dst, const TileMovementInfo * ct, const TileMovementInfo * dt, const int remainingMovePoints, const TurnInfo * ti, const bool checkLast)
 {
 	if(src == dst) //same tile
 		return 0;
@@ -1042,23 +1276,24 @@ int CPathfinderHelper::getMovementCost(const CGHeroInstance * h, const int3 & sr
 
 	if(ct == nullptr || dt == nullptr)
 	{
-		ct = h->cb->getTile(src);
-		dt = h->cb->getTile(dst);
+		const CMap * map = h->cb->gameState()->map;
+		ct = &map->getMovementInfo(src);
+		dt = &map->getMovementInfo(dst);
 	}
 
 	/// TODO: by the original game rules hero shouldn't be affected by terrain penalty while flying.
 	/// Also flying movement only has penalty when player moving over blocked tiles.
 	/// So if you only have base flying with 40% penalty you can still ignore terrain penalty while having zero flying penalty.
-	int ret = h->getTileCost(*dt, *ct, ti);
+	int ret = ti->getTileCost(*dt, *ct);
 	/// Unfortunately this can't be implemented yet as server don't know when player flying and when he's not.
 	/// Difference in cost calculation on client and server is much worse than incorrect cost.
 	/// So this one is waiting till server going to use pathfinder rules for path validation.
 
-	if(dt->blocked && ti->hasBonusOfType(Bonus::FLYING_MOVEMENT))
+	if(dt->isBlocked() && ti->hasBonusOfType(Bonus::FLYING_MOVEMENT))
 	{
 		ret *= (100.0 + ti->valOfBonuses(Bonus::FLYING_MOVEMENT)) / 100.0;
 	}
-	else if(dt->terType == ETerrainType::WATER)
+	else if(dt->isWater())
 	{
 		if(h->boat && ct->hasFavorableWinds() && dt->hasFavorableWinds())
 			ret *= 0.666;
@@ -1089,7 +1324,7 @@ int CPathfinderHelper::getMovementCost(const CGHeroInstance * h, const int3 & sr
 	{
 		std::vector<int3> vec;
 		vec.reserve(8); //optimization
-		getNeighbours(h->cb->gameState()->map, *dt, dst, vec, ct->terType != ETerrainType::WATER, true);
+		getNeighbours(h->cb->gameState()->map, *dt, dst, vec, !ct->isWater(), true);
 		for(auto & elem : vec)
 		{
 			int fcost = getMovementCost(h, dst, elem, nullptr, nullptr, left, ti, false);
@@ -1116,32 +1351,8 @@ int CPathfinderHelper::getMovementCost(const CGHeroInstance * h, const int3 & ds
 }
 
 CGPathNode::CGPathNode()
-	: coord(int3(-1, -1, -1)), layer(ELayer::WRONG)
-{
-	reset();
-}
-
-void CGPathNode::reset()
+	: coord(int3(-1, -1, -1)), moveRemains(0), turns(255), layer(ELayer::WRONG), accessible(NOT_SET), action(UNKNOWN)
 {
-	locked = false;
-	accessible = NOT_SET;
-	moveRemains = 0;
-	turns = 255;
-	theNodeBefore = nullptr;
-	action = UNKNOWN;
-}
-
-void CGPathNode::update(const int3 & Coord, const ELayer Layer, const EAccessibility Accessible)
-{
-	if(layer == ELayer::WRONG)
-	{
-		coord = Coord;
-		layer = Layer;
-	}
-	else
-		reset();
-
-	accessible = Accessible;
 }
 
 bool CGPathNode::reachable() const
@@ -1170,18 +1381,28 @@ void CGPath::convert(ui8 mode)
 	}
 }
 
+const CPathsInfo::TNodeIndex CPathsInfo::INVALID_NODE = std::numeric_limits<CPathsInfo::TNodeIndex>::max();
+
 CPathsInfo::CPathsInfo(const int3 & Sizes)
-	: sizes(Sizes)
+	: heroMovement(0), sizes(Sizes)
 {
 	hero = nullptr;
-	nodes.resize(boost::extents[sizes.x][sizes.y][sizes.z][ELayer::NUM_LAYERS]);
+
+	const size_t count = nodesCount();
+	moveRemains.resize(count);
+	turns.resize(count);
+	parents.resize(count);
+	accessible.resize(count);
+	actions.resize(count);
+	locked.resize(count);
+	resetNodes();
 }
 
 CPathsInfo::~CPathsInfo()
 {
 }
 
-const CGPathNode * CPathsInfo::getPathInfo(const int3 & tile) const
+CGPathNode CPathsInfo::getPathInfo(const int3 & tile) const
 {
 	assert(vstd::iswithin(tile.x, 0, sizes.x));
 	assert(vstd::iswithin(tile.y, 0, sizes.y));
@@ -1196,15 +1417,14 @@ bool CPathsInfo::getPath(CGPath & out, const int3 & dst) const
 	boost::unique_lock<boost::mutex> pathLock(pathMx);
 
 	out.nodes.clear();
-	const CGPathNode * curnode = getNode(dst);
-	if(!curnode->theNodeBefore)
+	TNodeIndex curnode = getIndex(dst);
+	if(parents[curnode] == INVALID_NODE)
 		return false;
 
-	while(curnode)
+	while(curnode != INVALID_NODE)
 	{
-		const CGPathNode cpn = * curnode;
-		curnode = curnode->theNodeBefore;
-		out.nodes.push_back(cpn);
+		out.nodes.push_back(makeNodeView(curnode));
+		curnode = parents[curnode];
 	}
 	return true;
 }
@@ -1220,16 +1440,95 @@ int CPathsInfo::getDistance(const int3 & tile) const
 		return 255;
 }
 
-const CGPathNode * CPathsInfo::getNode(const int3 & coord) const
+CGPathNode CPathsInfo::getNode(const int3 & coord) const
+{
+	return makeNodeView(getIndex(coord));
+}
+
+size_t CPathsInfo::nodesCount() const
+{
+	return sizes.x * sizes.y * sizes.z * ELayer::NUM_LAYERS;
+}
+
+CPathsInfo::TNodeIndex CPathsInfo::getIndex(const int3 & coord, const ELayer layer) const
 {
-	auto landNode = &nodes[coord.x][coord.y][coord.z][ELayer::LAND];
-	if(landNode->reachable())
+	return ((coord.x * sizes.y + coord.y) * sizes.z + coord.z) * ELayer::NUM_LAYERS + layer.num;
+}
+
+CPathsInfo::TNodeIndex CPathsInfo::getIndex(const int3 & coord) const
+{
+	const TNodeIndex landNode = getIndex(coord, ELayer::LAND);
+	if(reachable(landNode))
 		return landNode;
 	else
-		return &nodes[coord.x][coord.y][coord.z][ELayer::SAIL];
+		return getIndex(coord, ELayer::SAIL);
+}
+
+int3 CPathsInfo::getCoord(const TNodeIndex index) const
+{
+	const TNodeIndex tile = index / ELayer::NUM_LAYERS;
+	return int3(tile / (sizes.y * sizes.z), (tile / sizes.z) % sizes.y, tile % sizes.z);
+}
+
+EPathfindingLayer CPathsInfo::getLayer(const TNodeIndex index) const
+{
+	return static_cast<ELayer::EEPathfindingLayer>(index % ELayer::NUM_LAYERS);
+}
+
+bool CPathsInfo::reachable(const TNodeIndex index) const
+{
+	return turns[index] < 255;
+}
+
+void CPathsInfo::resetNodes()
+{
+	boost::range::fill(moveRemains, 0);
+	boost::range::fill(turns, 255);
+	boost::range::fill(parents, INVALID_NODE);
+	boost::range::fill(accessible, CGPathNode::NOT_SET);
+	boost::range::fill(actions, CGPathNode::UNKNOWN);
+	boost::range::fill(locked, false);
+}
+
+void CPathsInfo::resetNode(const TNodeIndex index)
+{
+	moveRemains[index] = 0;
+	turns[index] = 255;
+	parents[index] = INVALID_NODE;
+	accessible[index] = CGPathNode::NOT_SET;
+	actions[index] = CGPathNode::UNKNOWN;
+	locked[index] = false;
+}
+
+void CPathsInfo::updateNode(const TNodeIndex index, const CGPathNode::EAccessibility Accessible)
+{
+	resetNode(index);
+	accessible[index] = Accessible;
+}
+
+CGPathNode CPathsInfo::makeNodeView(const TNodeIndex index) const
+{
+	CGPathNode node;
+	if(accessible[index] != CGPathNode::NOT_SET)
+	{
+		node.coord = getCoord(index);
+		node.layer = getLayer(index);
+	}
+	node.moveRemains = moveRemains[index];
+	node.turns = turns[index];
+	node.accessible = accessible[index];
+	node.action = actions[index];
+	return node;
+}
+
+void CPathsInfo::invalidateTiles(const std::set<int3> & tiles)
+{
+	/// Without hero paths are already invalid and will be fully recalculated
+	if(hero)
+		invalidTiles.insert(tiles.begin(), tiles.end());
 }
 
-CGPathNode * CPathsInfo::getNode(const int3 & coord, const ELayer layer)
+bool CPathsInfo::needsRepair() const
 {
-	return &nodes[coord.x][coord.y][coord.z][layer];
+	return !invalidTiles.empty();
 }
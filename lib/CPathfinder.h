@@ -20,6 +20,7 @@
 class CGHeroInstance;
 class CGObjectInstance;
 struct TerrainTile;
+struct TileMovementInfo;
 class CPathfinderHelper;
 class CMap;
 class CGWhirlpool;
@@ -52,18 +53,14 @@ struct DLL_LINKAGE CGPathNode
 		BLOCKED //tile can't be entered nor visited
 	};
 
-	CGPathNode * theNodeBefore;
 	int3 coord; //coordinates
 	ui32 moveRemains; //remaining tiles after hero reaches the tile
 	ui8 turns; //how many turns we have to wait before reachng the tile - 0 means current turn
 	ELayer layer;
 	EAccessibility accessible;
 	ENodeAction action;
-	bool locked;
 
 	CGPathNode();
-	void reset();
-	void update(const int3 & Coord, const ELayer Layer, const EAccessibility Accessible);
 	bool reachable() const;
 };
 
@@ -76,25 +73,58 @@ struct DLL_LINKAGE CGPath
 	void convert(ui8 mode); //mode=0 -> from 'manifest' to 'object'
 };
 
+/// Graph nodes are kept in separate dense arrays indexed by node index.
+/// Node index is calculated from [x][y][level][layer] so coordinate and layer are not stored.
+/// CGPathNode returned by getPathInfo / getPath is only a copy assembled from these arrays:
+/// it stays valid after paths are recalculated but does not follow later changes.
+/// API change: getPathInfo / getNode used to return pointers into the node array,
+/// and the "nodes" array, CGPathNode::theNodeBefore and CGPathNode::locked are gone.
+/// Walk a path with getPath and the parents array instead of following theNodeBefore.
 struct DLL_LINKAGE CPathsInfo
 {
 	typedef EPathfindingLayer ELayer;
+	typedef ui32 TNodeIndex;
+
+	static const TNodeIndex INVALID_NODE;
 
 	mutable boost::mutex pathMx;
 
 	const CGHeroInstance * hero;
 	int3 hpos;
+	ui32 heroMovement; //movement points hero had when paths were calculated
 	int3 sizes;
-	boost::multi_array<CGPathNode, 4> nodes; //[w][h][level][layer]
+
+	std::vector<ui32> moveRemains;
+	std::vector<ui8> turns;
+	std::vector<TNodeIndex> parents; //previous node on path to node
+	std::vector<CGPathNode::EAccessibility> accessible;
+	std::vector<CGPathNode::ENodeAction> actions;
+	std::vector<ui8> locked;
+
+	/// Tiles changed since paths were calculated.
+	/// If hero position and movement are unchanged pathfinder only repair paths affected by these tiles.
+	std::unordered_set<int3, ShashInt3> invalidTiles;
 
 	CPathsInfo(const int3 & Sizes);
 	~CPathsInfo();
-	const CGPathNode * getPathInfo(const int3 & tile) const;
+	CGPathNode getPathInfo(const int3 & tile) const;
 	bool getPath(CGPath & out, const int3 & dst) const;
 	int getDistance(const int3 & tile) const;
-	const CGPathNode * getNode(const int3 & coord) const;
-
-	CGPathNode * getNode(const int3 & coord, const ELayer layer);
+	CGPathNode getNode(const int3 & coord) const;
+
+	size_t nodesCount() const;
+	TNodeIndex getIndex(const int3 & coord, const ELayer layer) const;
+	TNodeIndex getIndex(const int3 & coord) const; //land node if reachable, otherwise sail node
+	int3 getCoord(const TNodeIndex index) const;
+	ELayer getLayer(const TNodeIndex index) const;
+	bool reachable(const TNodeIndex index) const;
+	void resetNodes();
+	void resetNode(const TNodeIndex index);
+	void updateNode(const TNodeIndex index, const CGPathNode::EAccessibility Accessible);
+	CGPathNode makeNodeView(const TNodeIndex index) const;
+
+	void invalidateTiles(const std::set<int3> & tiles);
+	bool needsRepair() const;
 };
 
 class CPathfinder : private CGameInfoCallback
@@ -156,6 +186,15 @@ private:
 		///   I find it's reasonable limitation, but it's will make some movements more expensive than in H3.
 		bool originalMovementRules;
 
+		/// When only some tiles were invalidated since previous calculation pathfinder will reset
+		/// nodes which paths go through these tiles and repair them instead of full recalculation.
+		/// Changes around teleporters, hero position or movement points always cause full recalculation.
+		bool incrementalUpdates;
+
+		/// Debug option: every repaired graph is compared against full recalculation.
+		/// Mismatches are logged and result of full recalculation is used instead.
+		bool verifyIncrementalUpdates;
+
 		PathfinderOptions();
 	} options;
 
@@ -164,6 +203,9 @@ private:
 	const std::vector<std::vector<std::vector<ui8> > > &FoW;
 	std::unique_ptr<CPathfinderHelper> hlp;
 
+	bool repairPossible; //previous results can be reused, see PathfinderOptions::incrementalUpdates
+	std::vector<bool> lockedBeforeRepair;
+
 	enum EPatrolState {
 		PATROL_NONE = 0,
 		PATROL_LOCKED = 1,
@@ -171,26 +213,34 @@ private:
 	} patrolState;
 	std::unordered_set<int3, ShashInt3> patrolTiles;
 
+	typedef CPathsInfo::TNodeIndex TNodeIndex;
+
 	struct NodeComparer
 	{
-		bool operator()(const CGPathNode * lhs, const CGPathNode * rhs) const
+		const CPathsInfo * paths;
+
+		NodeComparer(const CPathsInfo * Paths = nullptr) : paths(Paths) {}
+		bool operator()(const TNodeIndex lhs, const TNodeIndex rhs) const
 		{
-			if(rhs->turns > lhs->turns)
+			if(paths->turns[rhs] > paths->turns[lhs])
 				return false;
-			else if(rhs->turns == lhs->turns && rhs->moveRemains < lhs->moveRemains)
+			else if(paths->turns[rhs] == paths->turns[lhs] && paths->moveRemains[rhs] < paths->moveRemains[lhs])
 				return false;
 
 			return true;
 		}
 	};
-	boost::heap::priority_queue<CGPathNode *, boost::heap::compare<NodeComparer> > pq;
+	boost::heap::priority_queue<TNodeIndex, boost::heap::compare<NodeComparer> > pq;
 
 	std::vector<int3> neighbourTiles;
 	std::vector<int3> neighbours;
 
-	CGPathNode * cp; //current (source) path node -> we took it from the queue
-	CGPathNode * dp; //destination node -> it's a neighbour of cp that we consider
+	TNodeIndex cp; //current (source) path node -> we took it from the queue
+	TNodeIndex dp; //destination node -> it's a neighbour of cp that we consider
+	int3 cpCoord, dpCoord;
+	ELayer cpLayer, dpLayer;
 	const TerrainTile * ct, * dt; //tile info for both nodes
+	const TileMovementInfo * ctInfo, * dtInfo; //packed terrain data of both nodes used for movement costs
 	const CGObjectInstance * ctObj, * dtObj;
 	CGPathNode::ENodeAction destAction;
 
@@ -216,6 +266,11 @@ private:
 
 	void initializePatrol();
 	void initializeGraph();
+	void initializeTile(const int3 & pos);
+
+	bool initializeRepair();
+	void finalizeRepair();
+	void verifyRepair();
 
 	CGPathNode::EAccessibility evaluateAccessibility(const int3 & pos, const TerrainTile * tinfo, const ELayer layer) const;
 	bool isVisitableObj(const CGObjectInstance * obj, const ELayer layer) const;
@@ -251,12 +306,15 @@ struct DLL_LINKAGE TurnInfo
 	mutable int maxMovePointsLand;
 	mutable int maxMovePointsWater;
 	int nativeTerrain;
+	/// Cost of leaving tile of each terrain type by land without road, with terrain penalty bonuses and pathfinding already applied
+	std::vector<int> terrainCosts;
 
 	TurnInfo(const CGHeroInstance * Hero, const int Turn = 0);
 	bool isLayerAvailable(const EPathfindingLayer layer) const;
 	bool hasBonusOfType(const Bonus::BonusType type, const int subtype = -1) const;
 	int valOfBonuses(const Bonus::BonusType type, const int subtype = -1) const;
 	int getMaxMovePoints(const EPathfindingLayer layer) const;
+	int getTileCost(const TileMovementInfo & dest, const TileMovementInfo & from) const;
 };
 
 class DLL_LINKAGE CPathfinderHelper
@@ -270,9 +328,9 @@ public:
 	bool hasBonusOfType(const Bonus::BonusType type, const int subtype = -1) const;
 	int getMaxMovePoints(const EPathfindingLayer layer) const;
 
-	static void getNeighbours(const CMap * map, const TerrainTile & srct, const int3 & tile, std::vector<int3> & vec, const boost::logic::tribool & onLand, const bool limitCoastSailing);
+	static void getNeighbours(const CMap * map, const TileMovementInfo & srct, const int3 & tile, std::vector<int3> & vec, const boost::logic::tribool & onLand, const bool limitCoastSailing);
 
-	static int getMovementCost(const CGHeroInstance * h, const int3 & src, const int3 & dst, const TerrainTile * ct, const TerrainTile * dt, const int remainingMovePoints =- 1, const TurnInfo * ti = nullptr, const bool checkLast = true);
+	static int getMovementCost(const CGHeroInstance * h, const int3 & src, const int3 & dst, const TileMovementInfo * ct, const TileMovementInfo * dt, const int remainingMovePoints =- 1, const TurnInfo * ti = nullptr, const bool checkLast = true);
 	static int getMovementCost(const CGHeroInstance * h, const int3 & dst);
 
 private:
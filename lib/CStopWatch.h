@@ -9,6 +9,7 @@
 	#include <ctime>
 	#define TO_MS_DIVISOR (CLOCKS_PER_SEC / 1000)
 #endif
+#include <chrono>
 
 /*
  * CStopWatch.h, part of VCMI engine
@@ -63,3 +64,24 @@ private:
 	#endif
 	}
 };
+
+/// Measures real time instead of processor time used by process,
+/// for work that runs on several threads or waits for disk
+class CWallClockStopWatch
+{
+	std::chrono::steady_clock::time_point last;
+
+public:
+	CWallClockStopWatch()
+		: last(std::chrono::steady_clock::now())
+	{
+	}
+
+	si64 getDiff() //get diff in milliseconds
+	{
+		const auto now = std::chrono::steady_clock::now();
+		const si64 ret = std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count();
+		last = now;
+		return ret;
+	}
+};
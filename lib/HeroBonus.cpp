@@ -19,6 +19,10 @@
 #include "CGeneralTextHandler.h"
 #include "BattleState.h"
 #include "CArtHandler.h"
+#include "CConfigHandler.h"
+
+#include <atomic>
+#include <boost/pool/pool_alloc.hpp>
 
 #define FOREACH_PARENT(pname) 	TNodes lparents; getParents(lparents); for(CBonusSystemNode *pname : lparents)
 #define FOREACH_CPARENT(pname) 	TCNodes lparents; getParents(lparents); for(const CBonusSystemNode *pname : lparents)
@@ -83,9 +87,17 @@ const std::map<std::string, TPropagatorPtr> bonusPropagatorMap =
 #define BONUS_LOG_LINE(x) logBonus->traceStream() << x
 
 int CBonusSystemNode::treeChanged = 1;
+int CBonusSystemNode::globalChanged = 1;
 const bool CBonusSystemNode::cachingEnabled = true;
 
-BonusList::BonusList(bool BelongsToTree /* =false */) : belongsToTree(BelongsToTree)
+/// Debug mode: every cached bonus request is compared with the result calculated without caching
+static bool isCacheVerificationEnabled()
+{
+	static const bool enabled = settings["general"]["verifyBonusCache"].Bool();
+	return enabled;
+}
+
+BonusList::BonusList(CBonusSystemNode * Owner /* =nullptr */) : owner(Owner)
 {
 
 }
@@ -94,13 +106,13 @@ BonusList::BonusList(const BonusList &bonusList)
 {
 	bonuses.resize(bonusList.size());
 	std::copy(bonusList.begin(), bonusList.end(), bonuses.begin());
-	belongsToTree = false;
+	owner = nullptr;
 }
 
 BonusList::BonusList(BonusList&& other):
-	belongsToTree(false)
+	owner(nullptr)
 {
-	std::swap(belongsToTree, other.belongsToTree);
+	std::swap(owner, other.owner);
 	std::swap(bonuses, other.bonuses);
 }
 
@@ -108,69 +120,71 @@ BonusList& BonusList::operator=(const BonusList &bonusList)
 {
 	bonuses.resize(bonusList.size());
 	std::copy(bonusList.begin(), bonusList.end(), bonuses.begin());
-	belongsToTree = false;
+	owner = nullptr;
 	return *this;
 }
 
 void BonusList::changed()
 {
-    if(belongsToTree)
-		CBonusSystemNode::treeHasChanged();
+	if(owner)
+		owner->nodeHasChanged();
 }
 
-int BonusList::totalValue() const
+BonusValueAccumulator::BonusValueAccumulator():
+	base(0), percentToBase(0), percentToAll(0), additive(0),
+	indepMax(0), hasIndepMax(false), indepMin(0), hasIndepMin(false), notIndepBonuses(0)
 {
-	int base = 0;
-	int percentToBase = 0;
-	int percentToAll = 0;
-	int additive = 0;
-	int indepMax = 0;
-	bool hasIndepMax = false;
-	int indepMin = 0;
-	bool hasIndepMin = false;
 
-	for (auto& b : bonuses)
+}
+
+void BonusValueAccumulator::add(const Bonus & bonus)
+{
+	switch(bonus.valType)
 	{
-		switch(b->valType)
+	case Bonus::BASE_NUMBER:
+		base += bonus.val;
+		break;
+	case Bonus::PERCENT_TO_ALL:
+		percentToAll += bonus.val;
+		break;
+	case Bonus::PERCENT_TO_BASE:
+		percentToBase += bonus.val;
+		break;
+	case Bonus::ADDITIVE_VALUE:
+		additive += bonus.val;
+		break;
+	case Bonus::INDEPENDENT_MAX:
+		if (!hasIndepMax)
 		{
-		case Bonus::BASE_NUMBER:
-			base += b->val;
-			break;
-		case Bonus::PERCENT_TO_ALL:
-			percentToAll += b->val;
-			break;
-		case Bonus::PERCENT_TO_BASE:
-			percentToBase += b->val;
-			break;
-		case Bonus::ADDITIVE_VALUE:
-			additive += b->val;
-			break;
-		case Bonus::INDEPENDENT_MAX:
-			if (!hasIndepMax)
-			{
-				indepMax = b->val;
-				hasIndepMax = true;
-			}
-			else
-			{
-				vstd::amax(indepMax, b->val);
-			}
-
-			break;
-		case Bonus::INDEPENDENT_MIN:
-			if (!hasIndepMin)
-			{
-				indepMin = b->val;
-				hasIndepMin = true;
-			}
-			else
-			{
-				vstd::amin(indepMin, b->val);
-			}
+			indepMax = bonus.val;
+			hasIndepMax = true;
+		}
+		else
+		{
+			vstd::amax(indepMax, bonus.val);
+		}
 
-			break;
+		break;
+	case Bonus::INDEPENDENT_MIN:
+		if (!hasIndepMin)
+		{
+			indepMin = bonus.val;
+			hasIndepMin = true;
 		}
+		else
+		{
+			vstd::amin(indepMin, bonus.val);
+		}
+
+		break;
 	}
+
+	if(bonus.valType != Bonus::INDEPENDENT_MAX && bonus.valType != Bonus::INDEPENDENT_MIN)
+		notIndepBonuses++;
+}
+
+int BonusValueAccumulator::total() const
+{
 	int modifiedBase = base + (base * percentToBase) / 100;
 	modifiedBase += additive;
 	int valFirst = (modifiedBase * (100 + percentToAll)) / 100;
@@ -178,11 +192,6 @@ int BonusList::totalValue() const
 	if(hasIndepMin && hasIndepMax)
 		assert(indepMin < indepMax);
 
-	const int notIndepBonuses = boost::count_if(bonuses, [](const std::shared_ptr<Bonus>& b)
-	{
-		return b->valType != Bonus::INDEPENDENT_MAX && b->valType != Bonus::INDEPENDENT_MIN;
-	});
-
 	if (hasIndepMax)
 	{
 		if(notIndepBonuses)
@@ -201,6 +210,14 @@ int BonusList::totalValue() const
 	return valFirst;
 }
 
+int BonusList::totalValue() const
+{
+	BonusValueAccumulator sum;
+	for(auto & b : bonuses)
+		sum.add(*b);
+	return sum.total();
+}
+
 std::shared_ptr<Bonus> BonusList::getFirst(const CSelector &select)
 {
 	for (auto & b : bonuses)
@@ -297,6 +314,112 @@ void BonusList::insert(BonusList::TInternalContainer::iterator position, BonusLi
 	changed();
 }
 
+static std::atomic<ui64> bonusPoolAllocations(0);
+static std::atomic<ui64> bonusPoolHeapAllocations(0);
+
+/// Same as default allocator of boost pools, but counts blocks taken from heap
+struct BonusPoolHeapAllocator
+{
+	typedef std::size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	static char * malloc(const size_type bytes)
+	{
+		bonusPoolHeapAllocations++;
+		return new (std::nothrow) char[bytes];
+	}
+
+	static void free(char * const block)
+	{
+		delete [] block;
+	}
+};
+
+std::shared_ptr<Bonus> CBonusPool::makeBonus(const Bonus &prototype)
+{
+	bonusPoolAllocations++;
+	return std::allocate_shared<Bonus>(boost::fast_pool_allocator<Bonus, BonusPoolHeapAllocator>(), prototype);
+}
+
+TBonusListPtr CBonusPool::makeList()
+{
+	bonusPoolAllocations++;
+	return std::allocate_shared<BonusList>(boost::fast_pool_allocator<BonusList, BonusPoolHeapAllocator>());
+}
+
+ui64 CBonusPool::allocations()
+{
+	return bonusPoolAllocations;
+}
+
+ui64 CBonusPool::heapAllocations()
+{
+	return bonusPoolHeapAllocations;
+}
+
+BonusRequestCache::BonusRequestCache() : used(0)
+{
+}
+
+TBonusListPtr BonusRequestCache::find(const BonusCacheKey & key) const
+{
+	if(slots.empty())
+		return nullptr;
+
+	const auto & slot = slots[findSlot(key)];
+	return slot.first.isCached() ? slot.second : nullptr;
+}
+
+void BonusRequestCache::insert(const BonusCacheKey & key, TBonusListPtr bonuses)
+{
+	// keep load factor below one half so probe sequences stay short
+	if((used + 1) * 2 > slots.size())
+		grow();
+
+	auto & slot = slots[findSlot(key)];
+	if(!slot.first.isCached())
+	{
+		slot.first = key;
+		used++;
+	}
+	slot.second = bonuses;
+}
+
+void BonusRequestCache::clear()
+{
+	if(!used)
+		return;
+
+	for(auto & slot : slots)
+	{
+		slot.first = BonusCacheKey();
+		slot.second.reset();
+	}
+	used = 0;
+}
+
+size_t BonusRequestCache::findSlot(const BonusCacheKey & key) const
+{
+	const size_t mask = slots.size() - 1;
+	size_t i = key.hash() & mask;
+	while(slots[i].first.isCached() && !(slots[i].first == key))
+		i = (i + 1) & mask;
+
+	return i;
+}
+
+void BonusRequestCache::grow()
+{
+	std::vector<std::pair<BonusCacheKey, TBonusListPtr>> old(std::max<size_t>(16, slots.size() * 2));
+	old.swap(slots);
+	used = 0;
+	for(auto & slot : old)
+	{
+		if(slot.first.isCached())
+			insert(slot.first, slot.second);
+	}
+}
+
 int IBonusBearer::valOfBonuses(Bonus::BonusType type, const CSelector &selector) const
 {
 	return valOfBonuses(Selector::type(type).And(selector));
@@ -304,59 +427,51 @@ int IBonusBearer::valOfBonuses(Bonus::BonusType type, const CSelector &selector)
 
 int IBonusBearer::valOfBonuses(Bonus::BonusType type, int subtype /*= -1*/) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << type << "s_" << subtype;
-
 	CSelector s = Selector::type(type);
 	if(subtype != -1)
 		s = s.And(Selector::subtype(subtype));
 
-	return valOfBonuses(s, cachingStr.str());
+	return valOfBonuses(s, BonusCacheKey::type(type, subtype));
 }
 
-int IBonusBearer::valOfBonuses(const CSelector &selector, const std::string &cachingStr) const
+int IBonusBearer::valOfBonuses(const CSelector &selector, const BonusCacheKey &cachingKey) const
 {
 	CSelector limit = nullptr;
-	TBonusListPtr hlp = getAllBonuses(selector, limit, nullptr, cachingStr);
+	TBonusListPtr hlp = getAllBonuses(selector, limit, nullptr, cachingKey);
 	return hlp->totalValue();
 }
-bool IBonusBearer::hasBonus(const CSelector &selector, const std::string &cachingStr /*= ""*/) const
+bool IBonusBearer::hasBonus(const CSelector &selector, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
-	return getBonuses(selector, cachingStr)->size() > 0;
+	return getBonuses(selector, cachingKey)->size() > 0;
 }
 
-bool IBonusBearer::hasBonus(const CSelector &selector, const CSelector &limit, const std::string &cachingStr /*= ""*/) const
+bool IBonusBearer::hasBonus(const CSelector &selector, const CSelector &limit, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
-	return getBonuses(selector, limit, cachingStr)->size() > 0;
+	return getBonuses(selector, limit, cachingKey)->size() > 0;
 }
 
 bool IBonusBearer::hasBonusOfType(Bonus::BonusType type, int subtype /*= -1*/) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << type << "s_" << subtype;
-
 	CSelector s = Selector::type(type);
 	if(subtype != -1)
 		s = s.And(Selector::subtype(subtype));
 
-	return hasBonus(s, cachingStr.str());
+	return hasBonus(s, BonusCacheKey::type(type, subtype));
 }
 
-const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const std::string &cachingStr /*= ""*/) const
+const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
-	return getAllBonuses(selector, nullptr, nullptr, cachingStr);
+	return getAllBonuses(selector, nullptr, nullptr, cachingKey);
 }
 
-const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const CSelector &limit, const std::string &cachingStr /*= ""*/) const
+const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const CSelector &limit, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
-	return getAllBonuses(selector, limit, nullptr, cachingStr);
+	return getAllBonuses(selector, limit, nullptr, cachingKey);
 }
 
 bool IBonusBearer::hasBonusFrom(Bonus::BonusSource source, ui32 sourceID) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "source_" << source << "id_" << sourceID;
-	return hasBonus(Selector::source(source,sourceID), cachingStr.str());
+	return hasBonus(Selector::source(source,sourceID), BonusCacheKey::source(source, sourceID));
 }
 
 int IBonusBearer::MoraleVal() const
@@ -419,15 +534,11 @@ ui32 IBonusBearer::MaxHealth() const
 
 ui32 IBonusBearer::getMinDamage() const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << Bonus::CREATURE_DAMAGE << "s_0Otype_" << Bonus::CREATURE_DAMAGE << "s_1";
-	return valOfBonuses(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 0).Or(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 1)), cachingStr.str());
+	return valOfBonuses(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 0).Or(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 1)), BonusCacheKey(BonusCacheKey::MIN_DAMAGE));
 }
 ui32 IBonusBearer::getMaxDamage() const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << Bonus::CREATURE_DAMAGE << "s_0Otype_" << Bonus::CREATURE_DAMAGE << "s_2";
-	return valOfBonuses(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 0).Or(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 2)), cachingStr.str());
+	return valOfBonuses(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 0).Or(Selector::typeSubtype(Bonus::CREATURE_DAMAGE, 2)), BonusCacheKey(BonusCacheKey::MAX_DAMAGE));
 }
 
 si32 IBonusBearer::manaLimit() const
@@ -474,11 +585,9 @@ ui32 IBonusBearer::Speed( int turn /*= 0*/ , bool useBind /* = false*/) const
 
 bool IBonusBearer::isLiving() const //TODO: theoreticaly there exists "LIVING" bonus in stack experience documentation
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << Bonus::UNDEAD << "s_-1Otype_" << Bonus::NON_LIVING << "s_-11type_" << Bonus::SIEGE_WEAPON; //I don't really get what string labels mean?
 	return !hasBonus(Selector::type(Bonus::UNDEAD)
 					.Or(Selector::type(Bonus::NON_LIVING))
-					.Or(Selector::type(Bonus::SIEGE_WEAPON)), cachingStr.str());
+					.Or(Selector::type(Bonus::SIEGE_WEAPON)), BonusCacheKey(BonusCacheKey::NOT_LIVING));
 }
 
 const std::shared_ptr<Bonus> IBonusBearer::getBonus(const CSelector &selector) const
@@ -546,7 +655,7 @@ void CBonusSystemNode::getAllBonusesRec(BonusList &out) const
 	bonuses.getAllBonuses(out);
 }
 
-const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root /*= nullptr*/, const std::string &cachingStr /*= ""*/) const
+const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root /*= nullptr*/, const BonusCacheKey &cachingKey /*= BonusCacheKey()*/) const
 {
 	bool limitOnUs = (!root || root == this); //caching won't work when we want to limit bonuses against an external node
 	if (CBonusSystemNode::cachingEnabled && limitOnUs)
@@ -555,9 +664,9 @@ const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, c
 		static boost::mutex m;
 		boost::mutex::scoped_lock lock(m);
 
-		// If the bonus system tree changes(state of a single node or the relations to each other) then
-		// cache all bonus objects. Selector objects doesn't matter.
-		if (cachedLast != treeChanged)
+		// If this node, any of its ancestors or the relations between them changed since last request
+		// then cache all bonus objects again. Selector objects doesn't matter.
+		if (cachedLast < std::max(nodeChanged, globalChanged))
 		{
 			cachedBonuses.clear();
 			cachedRequests.clear();
@@ -570,26 +679,26 @@ const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, c
 			cachedLast = treeChanged;
 		}
 
-		// If a bonus system request comes with a caching string then look up in the map if there are any
-		// pre-calculated bonus results. Limiters can't be cached so they have to be calculated.
-		if (cachingStr != "")
-		{
-			auto it = cachedRequests.find(cachingStr);
-			if(it != cachedRequests.end())
-			{
-				//Cached list contains bonuses for our query with applied limiters
-				return it->second;
-			}
-		}
+		// If a bonus system request comes with a caching key then look up in the cache if there are any
+		// pre-calculated bonus results. Cached list contains bonuses for our query with applied limiters.
+		TBonusListPtr ret;
+		if (cachingKey.isCached())
+			ret = cachedRequests.find(cachingKey);
 
 		//We still don't have the bonuses (didn't returned them from cache)
 		//Perform bonus selection
-		auto ret = std::make_shared<BonusList>();
-		cachedBonuses.getBonuses(*ret, selector, limit);
+		if(!ret)
+		{
+			ret = CBonusPool::makeList();
+			cachedBonuses.getBonuses(*ret, selector, limit);
+
+			// Save the results in the cache
+			if(cachingKey.isCached())
+				cachedRequests.insert(cachingKey, ret);
+		}
 
-		// Save the results in the cache
-		if(cachingStr != "")
-			cachedRequests[cachingStr] = ret;
+		if(isCacheVerificationEnabled())
+			verifyCachedBonuses(*ret, selector, limit);
 
 		return ret;
 	}
@@ -601,7 +710,7 @@ const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, c
 
 const TBonusListPtr CBonusSystemNode::getAllBonusesWithoutCaching(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root /*= nullptr*/) const
 {
-	auto ret = std::make_shared<BonusList>();
+	auto ret = CBonusPool::makeList();
 
 	// Get bonus results without caching enabled.
 	BonusList beforeLimiting, afterLimiting;
@@ -638,7 +747,32 @@ const TBonusListPtr CBonusSystemNode::getAllBonusesWithoutCaching(const CSelecto
 	return ret;
 }
 
-CBonusSystemNode::CBonusSystemNode() : bonuses(true), exportedBonuses(true), nodeType(UNKNOWN), cachedLast(0)
+void CBonusSystemNode::verifyCachedBonuses(const BonusList &cached, const CSelector &selector, const CSelector &limit) const
+{
+	auto expected = getAllBonusesWithoutCaching(selector, limit);
+
+	std::vector<Bonus *> cachedSorted, expectedSorted;
+	for(auto & b : cached)
+		cachedSorted.push_back(b.get());
+	for(auto & b : *expected)
+		expectedSorted.push_back(b.get());
+	boost::sort(cachedSorted);
+	boost::sort(expectedSorted);
+
+	if(cachedSorted != expectedSorted)
+	{
+		logBonus->errorStream() << "Cached bonuses of " << nodeName() << " are outdated: "
+			<< cached.size() << " bonuses in cache, " << expected->size() << " expected";
+		for(auto b : expectedSorted)
+			if(!boost::binary_search(cachedSorted, b))
+				logBonus->errorStream() << "\tmissing: " << b->Description();
+		for(auto b : cachedSorted)
+			if(!boost::binary_search(expectedSorted, b))
+				logBonus->errorStream() << "\tstale: " << b->Description();
+	}
+}
+
+CBonusSystemNode::CBonusSystemNode() : bonuses(this), exportedBonuses(this), nodeType(UNKNOWN), cachedLast(0), nodeChanged(0)
 {
 }
 
@@ -647,8 +781,11 @@ CBonusSystemNode::CBonusSystemNode(CBonusSystemNode && other):
 	exportedBonuses(std::move(other.exportedBonuses)),
 	nodeType(other.nodeType),
 	description(other.description),
-	cachedLast(0)
+	cachedLast(0),
+	nodeChanged(0)
 {
+	bonuses.owner = this;
+	exportedBonuses.owner = this;
 	std::swap(parents, other.parents);
 	std::swap(children, other.children);
 
@@ -694,7 +831,7 @@ void CBonusSystemNode::attachTo(CBonusSystemNode *parent)
 		newRedDescendant(parent);
 
 	parent->newChildAttached(this);
-	CBonusSystemNode::treeHasChanged();
+	nodeHasChanged();
 }
 
 void CBonusSystemNode::detachFrom(CBonusSystemNode *parent)
@@ -708,7 +845,7 @@ void CBonusSystemNode::detachFrom(CBonusSystemNode *parent)
 
 	parents -= parent;
 	parent->childDetached(this);
-	CBonusSystemNode::treeHasChanged();
+	nodeHasChanged();
 }
 
 void CBonusSystemNode::popBonuses(const CSelector &s)
@@ -748,7 +885,6 @@ void CBonusSystemNode::addNewBonus(const std::shared_ptr<Bonus>& b)
 	assert(!vstd::contains(exportedBonuses, b));
 	exportedBonuses.push_back(b);
 	exportBonus(b);
-	CBonusSystemNode::treeHasChanged();
 }
 
 void CBonusSystemNode::accumulateBonus(const std::shared_ptr<Bonus>& b)
@@ -767,7 +903,6 @@ void CBonusSystemNode::removeBonus(const std::shared_ptr<Bonus>& b)
 		unpropagateBonus(b);
 	else
 		bonuses -= b;
-	CBonusSystemNode::treeHasChanged();
 }
 
 bool CBonusSystemNode::actsAsBonusSourceOnly() const
@@ -933,8 +1068,6 @@ void CBonusSystemNode::exportBonus(std::shared_ptr<Bonus> b)
 		propagateBonus(b);
 	else
 		bonuses.push_back(b);
-
-	CBonusSystemNode::treeHasChanged();
 }
 
 void CBonusSystemNode::exportBonuses()
@@ -1025,9 +1158,24 @@ TBonusListPtr CBonusSystemNode::limitBonuses(const BonusList &allBonuses) const
 	return ret;
 }
 
+void CBonusSystemNode::nodeHasChanged()
+{
+	invalidateDescendants(++treeChanged);
+}
+
+void CBonusSystemNode::invalidateDescendants(int changeStamp)
+{
+	nodeChanged = changeStamp;
+	for(CBonusSystemNode *child : children)
+	{
+		if(child->nodeChanged != changeStamp) //already visited through another parent
+			child->invalidateDescendants(changeStamp);
+	}
+}
+
 void CBonusSystemNode::treeHasChanged()
 {
-	treeChanged++;
+	globalChanged = ++treeChanged;
 }
 
 int NBonus::valOf(const CBonusSystemNode *obj, Bonus::BonusType type, int subtype /*= -1*/)
@@ -1126,29 +1274,6 @@ namespace Selector
 	DLL_LINKAGE CWillLastTurns turns;
 	DLL_LINKAGE CWillLastDays days;
 
-	CSelector DLL_LINKAGE typeSubtype(Bonus::BonusType Type, TBonusSubtype Subtype)
-	{
-		return type(Type).And(subtype(Subtype));
-	}
-
-	CSelector DLL_LINKAGE typeSubtypeInfo(Bonus::BonusType type, TBonusSubtype subtype, si32 info)
-	{
-		return CSelectFieldEqual<Bonus::BonusType>(&Bonus::type)(type)
-			.And(CSelectFieldEqual<TBonusSubtype>(&Bonus::subtype)(subtype))
-			.And(CSelectFieldEqual<si32>(&Bonus::additionalInfo)(info));
-	}
-
-	CSelector DLL_LINKAGE source(Bonus::BonusSource source, ui32 sourceID)
-	{
-		return CSelectFieldEqual<Bonus::BonusSource>(&Bonus::source)(source)
-			.And(CSelectFieldEqual<ui32>(&Bonus::sid)(sourceID));
-	}
-
-	CSelector DLL_LINKAGE sourceTypeSel(Bonus::BonusSource source)
-	{
-		return CSelectFieldEqual<Bonus::BonusSource>(&Bonus::source)(source);
-	}
-
 	DLL_LINKAGE CSelector all([](const Bonus * b){return true;});
 	DLL_LINKAGE CSelector none([](const Bonus * b){return false;});
 
@@ -1307,8 +1432,8 @@ HasAnotherBonusLimiter::HasAnotherBonusLimiter( Bonus::BonusType bonus, TBonusSu
 int HasAnotherBonusLimiter::limit(const BonusLimitationContext &context) const
 {
 	CSelector mySelector = isSubtypeRelevant
-							? Selector::typeSubtype(type, subtype)
-							: Selector::type(type);
+							? CSelector(Selector::typeSubtype(type, subtype))
+							: CSelector(Selector::type(type));
 
 	//if we have a bonus of required type accepted, limiter should accept also this bonus
 	if(context.alreadyAccepted.getFirst(mySelector))
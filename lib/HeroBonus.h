@@ -382,6 +382,26 @@ struct DLL_LINKAGE Bonus : public std::enable_shared_from_this<Bonus>
 DLL_LINKAGE std::ostream & operator<<(std::ostream &out, const Bonus &bonus);
 
 
+/// Calculates total value of bonuses in the same way as BonusList::totalValue, without storing them in list
+class DLL_LINKAGE BonusValueAccumulator
+{
+	int base;
+	int percentToBase;
+	int percentToAll;
+	int additive;
+	int indepMax;
+	bool hasIndepMax;
+	int indepMin;
+	bool hasIndepMin;
+	int notIndepBonuses;
+
+public:
+	BonusValueAccumulator();
+
+	void add(const Bonus & bonus);
+	int total() const;
+};
+
 class DLL_LINKAGE BonusList
 {
 public:
@@ -389,9 +409,11 @@ public:
 
 private:
 	TInternalContainer bonuses;
-	bool belongsToTree;
+	CBonusSystemNode * owner; //node whose cached bonuses are invalidated by changes of this list, nullptr for standalone lists
 	void changed();
 
+	friend class CBonusSystemNode;
+
 public:
 	typedef TInternalContainer::const_reference const_reference;
 	typedef TInternalContainer::value_type value_type;
@@ -399,7 +421,7 @@ public:
 	typedef TInternalContainer::const_iterator const_iterator;
 	typedef TInternalContainer::iterator iterator;
 
-	BonusList(bool BelongsToTree = false);
+	BonusList(CBonusSystemNode * Owner = nullptr);
 	BonusList(const BonusList &bonusList);
 	BonusList(BonusList && other);
 	BonusList& operator=(const BonusList &bonusList);
@@ -499,6 +521,20 @@ inline BonusList::const_iterator range_end(BonusList const &x)
 
 DLL_LINKAGE std::ostream & operator<<(std::ostream &out, const BonusList &bonusList);
 
+/// Bonuses and bonus lists are created and destroyed in large numbers during battles and battle AI simulations.
+/// These are allocated together with their shared_ptr control blocks from memory pools instead of general heap.
+/// Pools are process-wide singletons: freed objects go back to their pool and are reused by later requests,
+/// but pool memory itself is never returned to the system, so it stays at the peak of the largest battle.
+class DLL_LINKAGE CBonusPool
+{
+public:
+	static std::shared_ptr<Bonus> makeBonus(const Bonus &prototype); //copy of given bonus
+	static TBonusListPtr makeList();
+
+	static ui64 allocations(); //number of objects taken from pools since start, without pools each one is a heap allocation
+	static ui64 heapAllocations(); //number of blocks pools took from heap since start
+};
+
 class DLL_LINKAGE IPropagator
 {
 public:
@@ -544,6 +580,84 @@ public:
 	}
 };
 
+/// Identifies selector of bonus request, so node can cache result of the request.
+/// Requests with equal keys must use equivalent selectors. Default constructed key disables caching.
+class DLL_LINKAGE BonusCacheKey
+{
+public:
+	enum EQuery : ui8
+	{
+		NONE,
+		TYPE, //type and subtype, -1 subtype for any
+		TYPE_INFO, //type, subtype and additional info
+		TYPE_SOURCE, //type and source type
+		SOURCE, //source type and source id
+		DAYS, //bonuses that will last given number of days
+		ACTIVE_SPELLS, //spell effects except NONE bonuses
+		MIN_DAMAGE, //creature damage for both or minimal damage
+		MAX_DAMAGE, //creature damage for both or maximal damage
+		NOT_LIVING, //undead, non living or siege weapon
+		CURE_DISPELLABLE, //selectors of spell mechanics
+		DISPELLABLE,
+		HELPFUL_DISPELLABLE,
+		ALL //all bonuses without effect range limit, filtered later by selector expressions
+	};
+
+	BonusCacheKey()
+		: query(NONE), a(0), b(0), c(0)
+	{}
+
+	BonusCacheKey(EQuery Query, si32 A = 0, si32 B = 0, si32 C = 0)
+		: query(Query), a(A), b(B), c(C)
+	{}
+
+	static BonusCacheKey type(si32 type, si32 subtype = -1) { return BonusCacheKey(TYPE, type, subtype); }
+	static BonusCacheKey typeInfo(si32 type, si32 subtype, si32 info) { return BonusCacheKey(TYPE_INFO, type, subtype, info); }
+	static BonusCacheKey typeSource(si32 type, si32 source) { return BonusCacheKey(TYPE_SOURCE, type, source); }
+	static BonusCacheKey source(si32 source, si32 sourceID) { return BonusCacheKey(SOURCE, source, sourceID); }
+	static BonusCacheKey days(si32 days) { return BonusCacheKey(DAYS, days); }
+
+	bool isCached() const
+	{
+		return query != NONE;
+	}
+
+	bool operator==(const BonusCacheKey & other) const
+	{
+		return query == other.query && a == other.a && b == other.b && c == other.c;
+	}
+
+	size_t hash() const
+	{
+		ui32 ret = query;
+		ret = ret * 0x9E3779B1u + static_cast<ui32>(a);
+		ret = ret * 0x9E3779B1u + static_cast<ui32>(b);
+		ret = ret * 0x9E3779B1u + static_cast<ui32>(c);
+		return ret ^ (ret >> 15);
+	}
+
+	EQuery query;
+	si32 a, b, c;
+};
+
+/// Open addressing hash table with cached results of bonus requests, stored in single array
+class DLL_LINKAGE BonusRequestCache
+{
+public:
+	BonusRequestCache();
+
+	TBonusListPtr find(const BonusCacheKey & key) const;
+	void insert(const BonusCacheKey & key, TBonusListPtr bonuses);
+	void clear();
+
+private:
+	std::vector<std::pair<BonusCacheKey, TBonusListPtr>> slots; //size is always power of 2, empty slot has NONE key
+	size_t used;
+
+	size_t findSlot(const BonusCacheKey & key) const;
+	void grow();
+};
+
 class DLL_LINKAGE IBonusBearer
 {
 public:
@@ -551,15 +665,21 @@ public:
 	// * selector is predicate that tests if HeroBonus matches our criteria
 	// * root is node on which call was made (nullptr will be replaced with this)
 	//interface
-	virtual const TBonusListPtr getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr, const std::string &cachingStr = "") const = 0;
-	int valOfBonuses(const CSelector &selector, const std::string &cachingStr = "") const;
-	bool hasBonus(const CSelector &selector, const std::string &cachingStr = "") const;
-	bool hasBonus(const CSelector &selector, const CSelector &limit, const std::string &cachingStr = "") const;
-	const TBonusListPtr getBonuses(const CSelector &selector, const CSelector &limit, const std::string &cachingStr = "") const;
-	const TBonusListPtr getBonuses(const CSelector &selector, const std::string &cachingStr = "") const;
+	virtual const TBonusListPtr getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr, const BonusCacheKey &cachingKey = BonusCacheKey()) const = 0;
+	int valOfBonuses(const CSelector &selector, const BonusCacheKey &cachingKey = BonusCacheKey()) const;
+	bool hasBonus(const CSelector &selector, const BonusCacheKey &cachingKey = BonusCacheKey()) const;
+	bool hasBonus(const CSelector &selector, const CSelector &limit, const BonusCacheKey &cachingKey = BonusCacheKey()) const;
+	const TBonusListPtr getBonuses(const CSelector &selector, const CSelector &limit, const BonusCacheKey &cachingKey = BonusCacheKey()) const;
+	const TBonusListPtr getBonuses(const CSelector &selector, const BonusCacheKey &cachingKey = BonusCacheKey()) const;
 
 	const std::shared_ptr<Bonus> getBonus(const CSelector &selector) const; //returns any bonus visible on node that matches (or nullptr if none matches)
 
+	//selector expressions (see CSelectorExpression) are checked inline against cached list of all bonuses
+	template<typename TSelector>
+	int valOfBonuses(const TSelector &selector, typename std::enable_if<std::is_class<TSelector>::value>::type *dummy = nullptr) const;
+	template<typename TSelector>
+	bool hasBonus(const TSelector &selector, typename std::enable_if<std::is_class<TSelector>::value>::type *dummy = nullptr) const;
+
 	//legacy interface
 	int valOfBonuses(Bonus::BonusType type, const CSelector &selector) const;
 	int valOfBonuses(Bonus::BonusType type, int subtype = -1) const; //subtype -> subtype of bonus, if -1 then anyt;
@@ -603,16 +723,18 @@ private:
 	static const bool cachingEnabled;
 	mutable BonusList cachedBonuses;
 	mutable int cachedLast;
+	int nodeChanged; //value of treeChanged when bonuses or parents of this node or any of its ancestors were modified
 	static int treeChanged;
+	static int globalChanged; //value of treeChanged when whole tree was invalidated
 
-	// Setting a value to cachingStr before getting any bonuses caches the result for later requests.
-	// This string needs to be unique, that's why it has to be setted in the following manner:
-	// [property key]_[value] => only for selector
-	mutable std::map<std::string, TBonusListPtr > cachedRequests;
+	// Passing a caching key when getting bonuses caches the result for later requests with same key.
+	mutable BonusRequestCache cachedRequests;
 
 	void getBonusesRec(BonusList &out, const CSelector &selector, const CSelector &limit) const;
 	void getAllBonusesRec(BonusList &out) const;
 	const TBonusListPtr getAllBonusesWithoutCaching(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr) const;
+	void verifyCachedBonuses(const BonusList &cached, const CSelector &selector, const CSelector &limit) const;
+	void invalidateDescendants(int changeStamp);
 
 public:
 	explicit CBonusSystemNode();
@@ -621,7 +743,7 @@ public:
 
 	void limitBonuses(const BonusList &allBonuses, BonusList &out) const; //out will bo populed with bonuses that are not limited here
 	TBonusListPtr limitBonuses(const BonusList &allBonuses) const; //same as above, returns out by val for convienence
-	const TBonusListPtr getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr, const std::string &cachingStr = "") const override;
+	const TBonusListPtr getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr, const BonusCacheKey &cachingKey = BonusCacheKey()) const override;
 	void getParents(TCNodes &out) const;  //retrieves list of parent nodes (nodes to inherit bonuses from),
 	const std::shared_ptr<Bonus> getBonusLocalFirst(const CSelector &selector) const;
 
@@ -669,6 +791,9 @@ public:
 	const std::string &getDescription() const;
 	void setDescription(const std::string &description);
 
+	///invalidates cached bonuses of this node and of all nodes that inherit bonuses from it
+	void nodeHasChanged();
+	///invalidates cached bonuses of all nodes, needed when node that was changed is not known
 	static void treeHasChanged();
 
 	template <typename Handler> void serialize(Handler &h, const int version)
@@ -688,6 +813,76 @@ namespace NBonus
 	DLL_LINKAGE bool hasOfType(const CBonusSystemNode *obj, Bonus::BonusType type, int subtype = -1);//determines if hero has a bonus of given type (and optionally subtype)
 }
 
+template<typename Lhs, typename Rhs> class CSelectAnd;
+template<typename Lhs, typename Rhs> class CSelectOr;
+
+/// Base of selectors that are combined at compile time. Whole expression has its own type
+/// (like CSelectAnd<CSelectFieldValue<Bonus::BonusType>, CWillLastTurns>) so checking it can be
+/// inlined into loops over bonuses. Expressions are converted to CSelector where they have to be stored.
+template<typename Derived>
+class CSelectorExpression
+{
+public:
+	template<typename Rhs>
+	CSelectAnd<Derived, Rhs> And(const Rhs &rhs) const
+	{
+		return CSelectAnd<Derived, Rhs>(static_cast<const Derived &>(*this), rhs);
+	}
+	template<typename Rhs>
+	CSelectOr<Derived, Rhs> Or(const Rhs &rhs) const
+	{
+		return CSelectOr<Derived, Rhs>(static_cast<const Derived &>(*this), rhs);
+	}
+};
+
+template<typename Lhs, typename Rhs>
+class CSelectAnd : public CSelectorExpression<CSelectAnd<Lhs, Rhs>>
+{
+	Lhs lhs;
+	Rhs rhs;
+public:
+	CSelectAnd(const Lhs &Lhs_, const Rhs &Rhs_)
+		: lhs(Lhs_), rhs(Rhs_)
+	{
+	}
+	bool operator()(const Bonus *bonus) const
+	{
+		return lhs(bonus) && rhs(bonus);
+	}
+};
+
+template<typename Lhs, typename Rhs>
+class CSelectOr : public CSelectorExpression<CSelectOr<Lhs, Rhs>>
+{
+	Lhs lhs;
+	Rhs rhs;
+public:
+	CSelectOr(const Lhs &Lhs_, const Rhs &Rhs_)
+		: lhs(Lhs_), rhs(Rhs_)
+	{
+	}
+	bool operator()(const Bonus *bonus) const
+	{
+		return lhs(bonus) || rhs(bonus);
+	}
+};
+
+template<typename T>
+class CSelectFieldValue : public CSelectorExpression<CSelectFieldValue<T>>
+{
+	T Bonus::*ptr;
+	T value;
+public:
+	CSelectFieldValue(T Bonus::*Ptr, const T &Value)
+		: ptr(Ptr), value(Value)
+	{
+	}
+	bool operator()(const Bonus *bonus) const
+	{
+		return bonus->*ptr == value;
+	}
+};
+
 template<typename T>
 class CSelectFieldEqual
 {
@@ -699,10 +894,9 @@ public:
 	{
 	}
 
-	CSelector operator()(const T &valueToCompareAgainst) const
+	CSelectFieldValue<T> operator()(const T &valueToCompareAgainst) const
 	{
-		auto ptr2 = ptr; //We need a COPY because we don't want to reference this (might be outlived by lambda)
-		return [ptr2, valueToCompareAgainst](const Bonus *bonus) {  return bonus->*ptr2 == valueToCompareAgainst; };
+		return CSelectFieldValue<T>(ptr, valueToCompareAgainst);
 	}
 };
 
@@ -727,7 +921,7 @@ public:
 	}
 };
 
-class DLL_LINKAGE CWillLastTurns
+class DLL_LINKAGE CWillLastTurns : public CSelectorExpression<CWillLastTurns>
 {
 public:
 	int turnsRequested;
@@ -745,7 +939,7 @@ public:
 	}
 };
 
-class DLL_LINKAGE CWillLastDays
+class DLL_LINKAGE CWillLastDays : public CSelectorExpression<CWillLastDays>
 {
 public:
 	int daysRequested;
@@ -908,10 +1102,32 @@ namespace Selector
 	extern DLL_LINKAGE CWillLastTurns turns;
 	extern DLL_LINKAGE CWillLastDays days;
 
-	CSelector DLL_LINKAGE typeSubtype(Bonus::BonusType Type, TBonusSubtype Subtype);
-	CSelector DLL_LINKAGE typeSubtypeInfo(Bonus::BonusType type, TBonusSubtype subtype, si32 info);
-	CSelector DLL_LINKAGE source(Bonus::BonusSource source, ui32 sourceID);
-	CSelector DLL_LINKAGE sourceTypeSel(Bonus::BonusSource source);
+	typedef CSelectAnd<CSelectFieldValue<Bonus::BonusType>, CSelectFieldValue<TBonusSubtype>> TTypeSubtype;
+	typedef CSelectAnd<TTypeSubtype, CSelectFieldValue<si32>> TTypeSubtypeInfo;
+	typedef CSelectAnd<CSelectFieldValue<Bonus::BonusSource>, CSelectFieldValue<ui32>> TSource;
+
+	inline TTypeSubtype typeSubtype(Bonus::BonusType Type, TBonusSubtype Subtype)
+	{
+		return CSelectFieldValue<Bonus::BonusType>(&Bonus::type, Type)
+			.And(CSelectFieldValue<TBonusSubtype>(&Bonus::subtype, Subtype));
+	}
+
+	inline TTypeSubtypeInfo typeSubtypeInfo(Bonus::BonusType type, TBonusSubtype subtype, si32 info)
+	{
+		return typeSubtype(type, subtype)
+			.And(CSelectFieldValue<si32>(&Bonus::additionalInfo, info));
+	}
+
+	inline TSource source(Bonus::BonusSource source, ui32 sourceID)
+	{
+		return CSelectFieldValue<Bonus::BonusSource>(&Bonus::source, source)
+			.And(CSelectFieldValue<ui32>(&Bonus::sid, sourceID));
+	}
+
+	inline CSelectFieldValue<Bonus::BonusSource> sourceTypeSel(Bonus::BonusSource source)
+	{
+		return CSelectFieldValue<Bonus::BonusSource>(&Bonus::source, source);
+	}
 
 	/**
 	 * Selects all bonuses
@@ -938,6 +1154,29 @@ extern DLL_LINKAGE const std::map<std::string, TLimiterPtr> bonusLimiterMap;
 extern DLL_LINKAGE const std::map<std::string, TPropagatorPtr> bonusPropagatorMap;
 
 
+template<typename TSelector>
+int IBonusBearer::valOfBonuses(const TSelector &selector, typename std::enable_if<std::is_class<TSelector>::value>::type *dummy) const
+{
+	BonusValueAccumulator sum;
+	for(auto & b : *getAllBonuses(Selector::all, nullptr, nullptr, BonusCacheKey(BonusCacheKey::ALL)))
+	{
+		if(selector(b.get()))
+			sum.add(*b);
+	}
+	return sum.total();
+}
+
+template<typename TSelector>
+bool IBonusBearer::hasBonus(const TSelector &selector, typename std::enable_if<std::is_class<TSelector>::value>::type *dummy) const
+{
+	for(auto & b : *getAllBonuses(Selector::all, nullptr, nullptr, BonusCacheKey(BonusCacheKey::ALL)))
+	{
+		if(selector(b.get()))
+			return true;
+	}
+	return false;
+}
+
 // BonusList template that requires full interface of CBonusSystemNode
 template <class InputIterator>
 void BonusList::insert(const int position, InputIterator first, InputIterator last)
@@ -523,6 +523,10 @@ static const std::unordered_map<std::string, JsonNode::JsonType> stringToType =
 	{"object",  JsonNode::DATA_STRUCT}
 };
 
+/// guards caches of compiled schemas and resolved references, validation may run on several threads
+/// caches are not function-local statics since MSVC 2013 doesn't initialize those thread-safely
+static boost::mutex validationCacheMx;
+
 namespace
 {
 	namespace Common
@@ -619,19 +623,45 @@ namespace
 			return "";
 		}
 
+		/// reference resolved to schema node, valid as long as it is used from same schema
+		struct ResolvedReference
+		{
+			std::string baseSchema;
+			std::string URI;
+			const JsonNode * target;
+		};
+		std::unordered_map<const JsonNode *, ResolvedReference> resolvedReferences; //guarded by validationCacheMx
+
 		std::string refCheck(Validation::ValidationData & validator, const JsonNode & baseSchema, const JsonNode & schema, const JsonNode & data)
 		{
-			std::string URI = schema.String();
-			//node must be validated using schema pointed by this reference and not by data here
-			//Local reference. Turn it into more easy to handle remote ref
-			if (boost::algorithm::starts_with(URI, "#"))
-				URI = validator.usedSchemas.back() + URI;
-			return check(URI, data, validator);
+			ResolvedReference reference; //copy, cached one may be changed by other thread once lock is released
+			{
+				boost::unique_lock<boost::mutex> lock(validationCacheMx);
+				ResolvedReference & cached = resolvedReferences[&schema];
+				if (!cached.target || cached.baseSchema != validator.usedSchemas.back())
+				{
+					cached.baseSchema = validator.usedSchemas.back();
+					cached.URI = schema.String();
+					//node must be validated using schema pointed by this reference and not by data here
+					//Local reference. Turn it into more easy to handle remote ref
+					if (boost::algorithm::starts_with(cached.URI, "#"))
+						cached.URI = cached.baseSchema + cached.URI;
+					cached.target = &JsonUtils::getSchema(cached.URI);
+				}
+				reference = cached;
+			}
+
+			validator.usedSchemas.push_back(reference.URI);
+			auto onscopeExit = vstd::makeScopeGuard([&]()
+			{
+				validator.usedSchemas.pop_back();
+			});
+			return check(*reference.target, data, validator);
 		}
 
 		std::string formatCheck(Validation::ValidationData & validator, const JsonNode & baseSchema, const JsonNode & schema, const JsonNode & data)
 		{
-			auto formats = Validation::getKnownFormats();
+			const auto & formats = Validation::getKnownFormats();
 			std::string errors;
 			auto checker = formats.find(schema.String());
 			if (checker != formats.end())
@@ -707,7 +737,7 @@ namespace
 
 	namespace Vector
 	{
-		std::string itemEntryCheck(Validation::ValidationData & validator, const JsonVector items, const JsonNode & schema, size_t index)
+		std::string itemEntryCheck(Validation::ValidationData & validator, const JsonVector & items, const JsonNode & schema, size_t index)
 		{
 			validator.currentPath.push_back(JsonNode());
 			validator.currentPath.back().Float() = index;
@@ -839,8 +869,7 @@ namespace
 				{
 					if (deps.second.getType() == JsonNode::DATA_VECTOR)
 					{
-						JsonVector depList = deps.second.Vector();
-						for(auto & depEntry : depList)
+						for(auto & depEntry : deps.second.Vector())
 						{
 							if (data[depEntry.String()].isNull())
 								errors += validator.makeErrorMessage("Property " + depEntry.String() + " required for " + deps.first + " is missing");
@@ -856,8 +885,11 @@ namespace
 			return errors;
 		}
 
-		std::string propertyEntryCheck(Validation::ValidationData & validator, const JsonNode &node, const JsonNode & schema, std::string nodeName)
+		std::string propertyEntryCheck(Validation::ValidationData & validator, const JsonNode &node, const JsonNode & schema, const std::string & nodeName)
 		{
+			if (schema.isNull())
+				return "";
+
 			validator.currentPath.push_back(JsonNode());
 			validator.currentPath.back().String() = nodeName;
 			auto onExit = vstd::makeScopeGuard([&]
@@ -866,9 +898,7 @@ namespace
 			});
 
 			// there is schema specifically for this item
-			if (!schema.isNull())
-				return check(schema, node, validator);
-			return "";
+			return check(schema, node, validator);
 		}
 
 		std::string propertiesCheck(Validation::ValidationData & validator, const JsonNode & baseSchema, const JsonNode & schema, const JsonNode & data)
@@ -883,9 +913,10 @@ namespace
 		std::string additionalPropertiesCheck(Validation::ValidationData & validator, const JsonNode & baseSchema, const JsonNode & schema, const JsonNode & data)
 		{
 			std::string errors;
+			const JsonMap & properties = baseSchema["properties"].Struct();
 			for(auto & entry : data.Struct())
 			{
-				if (baseSchema["properties"].Struct().count(entry.first) == 0)
+				if (properties.count(entry.first) == 0)
 				{
 					// try generic additionalItems schema
 					if (schema.getType() == JsonNode::DATA_STRUCT)
@@ -1105,17 +1136,47 @@ namespace Validation
 
 	std::string check(const JsonNode & schema, const JsonNode & data, ValidationData & validator)
 	{
-		const TValidatorMap & knownFields = getKnownFieldsFor(data.getType());
 		std::string errors;
-		for(auto & entry : schema.Struct())
+		for(auto & field : compile(schema).fields[data.getType()])
+			errors += (*field.validator)(validator, schema, *field.value, data);
+		return errors;
+	}
+
+	/// Fields like title or description never produce errors and are not worth calling
+	static bool isEmptyCheck(const TFieldValidator & validator)
+	{
+		typedef std::string (*TCheck)(ValidationData &, const JsonNode &, const JsonNode &, const JsonNode &);
+		auto target = validator.target<TCheck>();
+		return target && *target == Common::emptyCheck;
+	}
+
+	static std::unordered_map<const JsonNode *, CompiledSchema> compiledSchemas; //guarded by validationCacheMx
+
+	const CompiledSchema & compile(const JsonNode & schema)
+	{
+		//elements of unordered_map are never moved, so returned reference stays valid after unlocking
+		boost::unique_lock<boost::mutex> lock(validationCacheMx);
+		auto it = compiledSchemas.find(&schema);
+		if (it != compiledSchemas.end())
+			return it->second;
+
+		CompiledSchema & compiled = compiledSchemas[&schema];
+		for (int type = JsonNode::DATA_NULL; type <= JsonNode::DATA_STRUCT; type++)
 		{
-			auto checker = knownFields.find(entry.first);
-			if (checker != knownFields.end())
-				errors += checker->second(validator, schema, entry.second, data);
-			//else
-			//	errors += validator.makeErrorMessage("Unknown entry in schema " + entry.first);
+			const TValidatorMap & knownFields = getKnownFieldsFor(static_cast<JsonNode::JsonType>(type));
+			for(auto & entry : schema.Struct())
+			{
+				auto checker = knownFields.find(entry.first);
+				if (checker != knownFields.end() && !isEmptyCheck(checker->second))
+				{
+					CompiledSchema::Field field = {&checker->second, &entry.second};
+					compiled.fields[type].push_back(field);
+				}
+				//else
+				//	errors += validator.makeErrorMessage("Unknown entry in schema " + entry.first);
+			}
 		}
-		return errors;
+		return compiled;
 	}
 
 	const TValidatorMap & getKnownFieldsFor(JsonNode::JsonType type)
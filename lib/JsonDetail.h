@@ -116,10 +116,26 @@ namespace Validation
 	typedef std::function<std::string(ValidationData &, const JsonNode &, const JsonNode &, const JsonNode &)> TFieldValidator;
 	typedef std::unordered_map<std::string, TFieldValidator> TValidatorMap;
 
+	/// Schema node with validators of all its fields looked up in advance, separately for every type of data
+	struct CompiledSchema
+	{
+		struct Field
+		{
+			const TFieldValidator * validator;
+			const JsonNode * value;
+		};
+		/// fields that have to be checked, indexed by JsonNode::JsonType of validated data
+		std::vector<Field> fields[JsonNode::DATA_STRUCT + 1];
+	};
+
 	/// map of known fields in schema
 	const TValidatorMap & getKnownFieldsFor(JsonNode::JsonType type);
 	const TFormatMap & getKnownFormats();
 
+	/// returns compiled schema node, compiling it on first use, may be called from several threads
+	/// nodes are identified by address, so schema must not be destroyed, as ones from JsonUtils::getSchema are never
+	const CompiledSchema & compile(const JsonNode & schema);
+
 	std::string check(std::string schemaName, const JsonNode & data);
 	std::string check(std::string schemaName, const JsonNode & data, ValidationData & validator);
 	std::string check(const JsonNode & schema, const JsonNode & data, ValidationData & validator);
@@ -676,10 +676,13 @@ bool JsonUtils::validate(const JsonNode &node, std::string schemaName, std::stri
 	return log.empty();
 }
 
+// cached schemas to avoid loading json data multiple times
+static std::map<std::string, JsonNode> loadedSchemas;
+static boost::mutex loadedSchemasMx; //validation may run on several threads
+
 const JsonNode & getSchemaByName(std::string name)
 {
-	// cached schemas to avoid loading json data multiple times
-	static std::map<std::string, JsonNode> loadedSchemas;
+	boost::unique_lock<boost::mutex> lock(loadedSchemasMx);
 
 	if (vstd::contains(loadedSchemas, name))
 		return loadedSchemas[name];
@@ -558,6 +558,7 @@ struct RemoveObject : public CPackForClient //500
 	DLL_LINKAGE void applyGs(CGameState *gs);
 
 	ObjectInstanceID id;
+	std::set<int3> objectTiles; //client only, paths through these tiles are invalidated once object is removed
 
 	template <typename Handler> void serialize(Handler &h, const int version)
 	{
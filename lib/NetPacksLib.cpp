@@ -943,7 +943,8 @@ DLL_LINKAGE void RebalanceStacks::applyGs(CGameState *gs)
 		}
 	}
 
-	CBonusSystemNode::treeHasChanged();
+	src.army->nodeHasChanged();
+	dst.army->nodeHasChanged();
 }
 
 DLL_LINKAGE void PutArtifact::applyGs(CGameState *gs)
@@ -1348,10 +1349,14 @@ void BattleResult::applyGs(CGameState *gs)
 	if(VLC->modh->modules.STACK_EXP)
 	{
 		for(int i = 0; i < 2; i++)
+		{
 			if(exp[i])
-				gs->curB->battleGetArmyObject(i)->giveStackExp(exp[i]);
-
-		CBonusSystemNode::treeHasChanged();
+			{
+				CArmedInstance * army = gs->curB->battleGetArmyObject(i);
+				army->giveStackExp(exp[i]);
+				army->nodeHasChanged();
+			}
+		}
 	}
 
 	for(int i = 0; i < 2; i++)
@@ -1529,7 +1534,7 @@ void actualizeEffect(CStack * s, const Bonus & ef)
 			stackBonus->turnsRemain = std::max(stackBonus->turnsRemain, ef.turnsRemain);
 		}
 	}
-	CBonusSystemNode::treeHasChanged();
+	s->nodeHasChanged();
 }
 
 void actualizeEffect(CStack * s, const std::vector<Bonus> & ef)
@@ -1559,7 +1564,7 @@ DLL_LINKAGE void SetStackEffect::applyGs(CGameState *gs)
 		{
 			//no such effect or cumulative - add new
 			logBonus->traceStream() << sta->nodeName() << " receives a new bonus: " << effect.Description();
-			sta->addNewBonus(std::make_shared<Bonus>(effect));
+			sta->addNewBonus(CBonusPool::makeBonus(effect));
 		}
 		else
 			actualizeEffect(sta, effect);
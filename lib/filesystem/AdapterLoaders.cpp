@@ -2,8 +2,39 @@
 #include "AdapterLoaders.h"
 
 #include "../JsonNode.h"
+#include "../CStopWatch.h"
+#include "../CThreadHelper.h"
+#include "CMemoryStream.h"
 #include "Filesystem.h"
 
+/// Stream over prefetched data, owns loaded buffer
+class CPrefetchedStream : public CMemoryStream
+{
+	std::unique_ptr<ui8[]> data;
+public:
+	CPrefetchedStream(std::unique_ptr<ui8[]> Data, si64 size)
+		: CMemoryStream(Data.get(), size), data(std::move(Data))
+	{
+	}
+};
+
+class CFilesystemList::CPrefetchHandle : public IPrefetchHandle
+{
+public:
+	const CFilesystemList * loader;
+	std::vector<ResourceID> resources;
+
+	CPrefetchHandle(const CFilesystemList * Loader, const std::vector<ResourceID> & Resources)
+		: loader(Loader), resources(Resources)
+	{
+	}
+
+	~CPrefetchHandle()
+	{
+		loader->dropPrefetched(this, resources);
+	}
+};
+
 CMappedFileLoader::CMappedFileLoader(const std::string & mountPoint, const JsonNode &config)
 {
 	for(auto entry : config.Struct())
@@ -57,6 +88,17 @@ CFilesystemList::~CFilesystemList()
 
 std::unique_ptr<CInputStream> CFilesystemList::load(const ResourceID & resourceName) const
 {
+	{
+		boost::unique_lock<boost::mutex> lock(prefetchMx);
+		auto it = prefetched.find(resourceName);
+		if (it != prefetched.end())
+		{
+			std::unique_ptr<CInputStream> ret = make_unique<CPrefetchedStream>(std::move(it->second.data), it->second.size);
+			prefetched.erase(it);
+			return ret;
+		}
+	}
+
 	// load resource from last loader that have it (last overridden version)
 	for (auto & loader : boost::adaptors::reverse(loaders))
 	{
@@ -68,6 +110,77 @@ std::unique_ptr<CInputStream> CFilesystemList::load(const ResourceID & resourceN
 		+ EResTypeHelper::getEResTypeAsString(resourceName.getType()) + " wasn't found.");
 }
 
+std::unique_ptr<IPrefetchHandle> CFilesystemList::prefetch(const std::vector<ResourceID> & resources) const
+{
+	auto handle = make_unique<CPrefetchHandle>(this, resources);
+	CWallClockStopWatch timer;
+	std::vector<std::pair<std::unique_ptr<ui8[]>, si64>> loaded(resources.size());
+
+	std::vector<Task> tasks;
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		{
+			boost::unique_lock<boost::mutex> lock(prefetchMx);
+			if (prefetched.count(resources[i]))
+				continue;
+		}
+		tasks.push_back([&, i]()
+		{
+			//only reading and decompression are done here, missing or broken resources are reported by load()
+			try
+			{
+				if (existsResource(resources[i]))
+					loaded[i] = load(resources[i])->readAll();
+			}
+			catch (std::exception & e)
+			{
+				logGlobal->debugStream() << "Failed to prefetch " << resources[i].getName() << ": " << e.what();
+			}
+		});
+	}
+	if (tasks.empty())
+		return std::move(handle);
+
+	const int threads = std::min<int>(tasks.size(), std::max<ui32>(1, boost::thread::hardware_concurrency()));
+	CThreadHelper helper(&tasks, threads);
+	helper.run();
+
+	si64 totalSize = 0;
+	size_t count = 0;
+	boost::unique_lock<boost::mutex> lock(prefetchMx);
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		if (!loaded[i].first || prefetched.count(resources[i]))
+			continue;
+		totalSize += loaded[i].second;
+		count++;
+		PrefetchedData & entry = prefetched[resources[i]];
+		entry.data = std::move(loaded[i].first);
+		entry.size = loaded[i].second;
+		entry.owner = handle.get();
+	}
+	logGlobal->debugStream() << "Prefetched " << count << " resources (" << totalSize / 1024 << " KB) on "
+		<< threads << " threads in " << timer.getDiff() << " ms";
+	return std::move(handle);
+}
+
+void CFilesystemList::dropPrefetched(const IPrefetchHandle * owner, const std::vector<ResourceID> & resources) const
+{
+	boost::unique_lock<boost::mutex> lock(prefetchMx);
+	size_t count = 0;
+	for (auto & resource : resources)
+	{
+		auto it = prefetched.find(resource);
+		if (it != prefetched.end() && it->second.owner == owner)
+		{
+			prefetched.erase(it);
+			count++;
+		}
+	}
+	if (count)
+		logGlobal->debugStream() << "Dropping " << count << " prefetched resources that were not used";
+}
+
 bool CFilesystemList::existsResource(const ResourceID & resourceName) const
 {
 	for (auto & loader : loaders)
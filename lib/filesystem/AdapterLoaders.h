@@ -58,6 +58,20 @@ class DLL_LINKAGE CFilesystemList : public ISimpleResourceLoader
 
 	std::set<ISimpleResourceLoader *> writeableLoaders;
 
+	struct PrefetchedData
+	{
+		std::unique_ptr<ui8[]> data;
+		si64 size;
+		const IPrefetchHandle * owner; //handle returned by prefetch() that loaded it
+	};
+	class CPrefetchHandle;
+
+	/// resources loaded by prefetch() and not consumed by load() yet
+	mutable std::unordered_map<ResourceID, PrefetchedData> prefetched;
+	mutable boost::mutex prefetchMx;
+
+	void dropPrefetched(const IPrefetchHandle * owner, const std::vector<ResourceID> & resources) const;
+
 	//FIXME: this is only compile fix, should be removed in the end
 	CFilesystemList(CFilesystemList &) = delete;
 	CFilesystemList &operator=(CFilesystemList &) = delete;
@@ -77,6 +91,13 @@ public:
 	bool createResource(std::string filename, bool update = false) override;
 	std::vector<const ISimpleResourceLoader *> getResourcesWithName(const ResourceID & resourceName) const override;
 
+	/**
+	 * Loads resources on all available cores and keeps them in memory until they are loaded.
+	 * Resources kept already by other handle are not loaded again and stay owned by that handle.
+	 * @see ISimpleResourceLoader::prefetch
+	 */
+	std::unique_ptr<IPrefetchHandle> prefetch(const std::vector<ResourceID> & resources) const override;
+
 	/**
 	 * Adds a resource loader to the loaders list
 	 * Passes loader ownership to this object
@@ -3,9 +3,38 @@
 
 #include "CFileInputStream.h"
 #include "CCompressedStream.h"
+#include "CMemoryStream.h"
+#include "CResourceIndexCache.h"
 
 #include "CBinaryReader.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+typedef std::shared_ptr<const boost::interprocess::mapped_region> TMappedRegion;
+
+/// Uncompressed entry of memory mapped archive, keeps archive mapped as long as stream exists
+class CMappedEntryStream : public CMemoryStream
+{
+	TMappedRegion region;
+public:
+	CMappedEntryStream(TMappedRegion Region, const ArchiveEntry & entry)
+		: CMemoryStream(static_cast<const ui8 *>(Region->get_address()) + entry.offset, entry.fullSize), region(Region)
+	{
+	}
+};
+
+/// Compressed entry of memory mapped archive, inflated straight from mapped memory
+class CMappedCompressedEntryStream : public CCompressedStream
+{
+	TMappedRegion region;
+public:
+	CMappedCompressedEntryStream(TMappedRegion Region, const ArchiveEntry & entry)
+		: CCompressedStream(static_cast<const ui8 *>(Region->get_address()) + entry.offset, entry.compressedSize, false), region(Region)
+	{
+	}
+};
+
 ArchiveEntry::ArchiveEntry()
 	: offset(0), fullSize(0), compressedSize(0)
 {
@@ -15,6 +44,55 @@ ArchiveEntry::ArchiveEntry()
 CArchiveLoader::CArchiveLoader(std::string _mountPoint, boost::filesystem::path _archive) :
     archive(std::move(_archive)),
     mountPoint(std::move(_mountPoint))
+{
+	// Table of contents is read from archive only if it is not in resource index or archive has changed
+	const std::string cacheKey = "archive:" + mountPoint + ":" + archive.string();
+	CResourceIndexCache::TEntries cached;
+	if(CResourceIndexCache::get().find(cacheKey, cached))
+	{
+		for(auto & cachedEntry : cached)
+		{
+			ArchiveEntry entry;
+			entry.name = cachedEntry.name;
+			entry.offset = cachedEntry.values[0];
+			entry.fullSize = cachedEntry.values[1];
+			entry.compressedSize = cachedEntry.values[2];
+			entries[ResourceID(mountPoint + entry.name)] = entry;
+		}
+	}
+	else
+	{
+		initArchive();
+
+		for(auto & entry : entries)
+		{
+			CResourceIndexCache::Entry cachedEntry;
+			cachedEntry.name = entry.second.name;
+			cachedEntry.values = {{entry.second.offset, entry.second.fullSize, entry.second.compressedSize}};
+			cached.push_back(cachedEntry);
+		}
+		CResourceIndexCache::get().store(cacheKey, std::vector<boost::filesystem::path>(1, archive), std::move(cached));
+	}
+
+	// Fake .lod file with no data has nothing to map
+	if(entries.empty())
+		return;
+
+	// Map whole archive, so loading an entry doesn't need to open, seek and read the file again
+	try
+	{
+		boost::interprocess::file_mapping file(archive.string().c_str(), boost::interprocess::read_only);
+		mapping = std::make_shared<const boost::interprocess::mapped_region>(file, boost::interprocess::read_only);
+	}
+	catch(boost::interprocess::interprocess_exception & e)
+	{
+		logGlobal->warnStream() << "Failed to map archive " << archive << " into memory, it will be read from file: " << e.what();
+	}
+
+	logGlobal->traceStream() << "Archive \""<<archive.filename()<<"\" loaded (" << entries.size() << " files found).";
+}
+
+void CArchiveLoader::initArchive()
 {
 	// Open archive file(.snd, .vid, .lod)
 	CFileInputStream fileStream(archive);
@@ -35,8 +113,6 @@ CArchiveLoader::CArchiveLoader(std::string _mountPoint, boost::filesystem::path
 		initSNDArchive(mountPoint, fileStream);
 	else
 		throw std::runtime_error("LOD archive format unknown. Cannot deal with " + archive.string());
-
-	logGlobal->traceStream() << ext << "Archive \""<<archive.filename()<<"\" loaded (" << entries.size() << " files found).";
 }
 
 void CArchiveLoader::initLODArchive(const std::string &mountPoint, CFileInputStream & fileStream)
@@ -137,6 +213,16 @@ std::unique_ptr<CInputStream> CArchiveLoader::load(const ResourceID & resourceNa
 
 	const ArchiveEntry & entry = entries.at(resourceName);
 
+	// entries pointing outside of the archive are left for file streams to handle
+	const si64 storedSize = entry.compressedSize != 0 ? entry.compressedSize : entry.fullSize;
+	if (mapping && entry.offset >= 0 && storedSize >= 0 && entry.offset + storedSize <= si64(mapping->get_size()))
+	{
+		if (entry.compressedSize != 0)
+			return make_unique<CMappedCompressedEntryStream>(mapping, entry);
+		else
+			return make_unique<CMappedEntryStream>(mapping, entry);
+	}
+
 	if (entry.compressedSize != 0) //compressed data
 	{
 		auto fileStream = make_unique<CFileInputStream>(archive, entry.offset, entry.compressedSize);
@@ -15,6 +15,14 @@
 
 class CFileInputStream;
 
+namespace boost
+{
+	namespace interprocess
+	{
+		class mapped_region;
+	}
+}
+
 /**
  * A struct which holds information about the archive entry e.g. where it is located in space of the archive container.
  */
@@ -65,6 +73,13 @@ public:
 	std::unordered_set<ResourceID> getFilteredFiles(std::function<bool(const ResourceID &)> filter) const override;
 
 private:
+	/**
+	 * Reads table of contents of archive, format is chosen by its extension.
+	 *
+	 * @throws std::runtime_error if the archive isn't supported
+	 */
+	void initArchive();
+
 	/**
 	 * Initializes a LOD archive.
 	 *
@@ -93,4 +108,7 @@ private:
 
 	/** Holds all entries of the archive file. An entry can be accessed via the entry name. **/
 	std::unordered_map<ResourceID, ArchiveEntry> entries;
+
+	/** Whole archive mapped into memory or nullptr if mapping failed. Shared with streams returned by load() **/
+	std::shared_ptr<const boost::interprocess::mapped_region> mapping;
 };
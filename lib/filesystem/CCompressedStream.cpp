@@ -82,7 +82,20 @@ CCompressedStream::CCompressedStream(std::unique_ptr<CInputStream> stream, bool
 	compressedBuffer(inflateBlockSize)
 {
 	assert(gzipStream);
+	init(gzip);
+}
+
+CCompressedStream::CCompressedStream(const ui8 * data, si64 size, bool gzip)
+{
+	init(gzip);
 
+	// whole input is available right away, gzipStream stays empty
+	inflateState->avail_in = size;
+	inflateState->next_in = const_cast<ui8 *>(data);
+}
+
+void CCompressedStream::init(bool gzip)
+{
 	// Allocate inflate state
 	inflateState = new z_stream;
 	inflateState->zalloc = Z_NULL;
@@ -121,7 +134,7 @@ si64 CCompressedStream::readMore(ui8 *data, si64 size)
 
 	do
 	{
-		if (inflateState->avail_in == 0)
+		if (inflateState->avail_in == 0 && gzipStream)
 		{
 			//inflate ran out of available data or was not initialized yet
 			// get new input data and update state accordingly
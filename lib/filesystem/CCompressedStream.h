@@ -102,6 +102,16 @@ public:
 	 */
 	CCompressedStream(std::unique_ptr<CInputStream> stream, bool gzip, size_t decompressedSize=0);
 
+	/**
+	 * C-tor for compressed data that is already in memory (e.g. in memory mapped archive).
+	 * Data is inflated in place, without copying it into internal buffer.
+	 *
+	 * @param data - compressed data, must stay valid as long as this stream exists
+	 * @param size - size of compressed data
+	 * @param gzip - this is gzipp'ed data
+	 */
+	CCompressedStream(const ui8 * data, si64 size, bool gzip);
+
 	~CCompressedStream();
 
 	/**
@@ -118,7 +128,10 @@ private:
 	 */
 	si64 readMore(ui8 * data, si64 size) override;
 
-	/** The file stream with compressed data. */
+	/** Initializes inflate state */
+	void init(bool gzip);
+
+	/** The file stream with compressed data or nullptr if all compressed data were passed to inflate already. */
 	std::unique_ptr<CInputStream> gzipStream;
 
 	/** buffer with not yet decompressed data*/
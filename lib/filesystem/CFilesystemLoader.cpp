@@ -3,6 +3,7 @@
 
 #include "CFileInputStream.h"
 #include "FileStream.h"
+#include "CResourceIndexCache.h"
 
 namespace bfs = boost::filesystem;
 
@@ -96,7 +97,38 @@ std::unordered_map<ResourceID, bfs::path> CFilesystemLoader::listFiles(const std
 	assert(bfs::is_directory(baseDirectory));
 	std::unordered_map<ResourceID, bfs::path> fileList;
 
+	auto addFile = [&](bfs::path filename, EResType::Type type)
+	{
+		std::string resName;
+		if (bfs::path::preferred_separator != '/')
+		{
+			// resource names are using UNIX slashes (/)
+			resName.reserve(resName.size() + filename.native().size());
+			resName = mountPoint;
+			for (const char c : filename.string())
+				if (c != bfs::path::preferred_separator)
+					resName.push_back(c);
+				else
+					resName.push_back('/');
+		}
+		else
+			resName = mountPoint + filename.string();
+
+		fileList[ResourceID(resName, type)] = std::move(filename);
+	};
+
+	const std::string cacheKey = "dir:" + mountPoint + ":" + baseDirectory.string() + ":"
+		+ boost::lexical_cast<std::string>(depth) + (initial ? ":initial" : "");
+	CResourceIndexCache::TEntries cached;
+	if (CResourceIndexCache::get().find(cacheKey, cached))
+	{
+		for (auto & entry : cached)
+			addFile(entry.name, static_cast<EResType::Type>(entry.values[0]));
+		return fileList;
+	}
+
 	std::vector<bfs::path> path; //vector holding relative path to our file
+	std::vector<bfs::path> scannedDirs(1, baseDirectory); //adding or removing file changes modification time of its directory
 
 	bfs::recursive_directory_iterator enddir;
 	bfs::recursive_directory_iterator it(baseDirectory, bfs::symlink_option::recurse);
@@ -111,6 +143,8 @@ std::unordered_map<ResourceID, bfs::path> CFilesystemLoader::listFiles(const std
 			path.back() = it->path().filename();
 			// don't iterate into directory if depth limit reached
 			it.no_push(depth <= it.level());
+			if (depth > it.level())
+				scannedDirs.push_back(it->path());
 
 			type = EResType::DIRECTORY;
 		}
@@ -132,24 +166,15 @@ std::unordered_map<ResourceID, bfs::path> CFilesystemLoader::listFiles(const std
 			else
 				filename = it->path().filename();
 
-			std::string resName;
-			if (bfs::path::preferred_separator != '/')
-			{
-				// resource names are using UNIX slashes (/)
-				resName.reserve(resName.size() + filename.native().size());
-				resName = mountPoint;
-				for (const char c : filename.string())
-					if (c != bfs::path::preferred_separator)
-						resName.push_back(c);
-					else
-						resName.push_back('/');
-			}
-			else
-				resName = mountPoint + filename.string();
+			CResourceIndexCache::Entry entry;
+			entry.name = filename.string();
+			entry.values = {{type, 0, 0}};
+			cached.push_back(entry);
 
-			fileList[ResourceID(resName, type)] = std::move(filename);
+			addFile(std::move(filename), type);
 		}
 	}
+	CResourceIndexCache::get().store(cacheKey, scannedDirs, std::move(cached));
 
 	return fileList;
 }
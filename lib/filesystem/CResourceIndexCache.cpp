@@ -0,0 +1,133 @@
+#include "StdInc.h"
+#include "CResourceIndexCache.h"
+
+#include "../VCMIDirs.h"
+#include "../CStopWatch.h"
+#include "../serializer/BinaryDeserializer.h"
+#include "../serializer/BinarySerializer.h"
+
+/*
+ * CResourceIndexCache.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+namespace bfs = boost::filesystem;
+
+CResourceIndexCache::CResourceIndexCache(bfs::path cacheFile)
+	: cacheFile(std::move(cacheFile)), modified(false)
+{
+}
+
+CResourceIndexCache & CResourceIndexCache::get()
+{
+	static CResourceIndexCache instance(VCMIDirs::get().userCachePath() / "resourceIndex.bin");
+	static boost::once_flag loaded = BOOST_ONCE_INIT;
+	boost::call_once(loaded, [](){ instance.load(); });
+	return instance;
+}
+
+void CResourceIndexCache::load()
+{
+	if(!bfs::exists(cacheFile))
+		return;
+
+	CStopWatch timer;
+	try
+	{
+		CLoadFile file(cacheFile);
+		file >> containers;
+		logGlobal->debugStream() << "Loaded resource index of " << containers.size() << " containers in " << timer.getDiff() << " ms";
+	}
+	catch(std::exception & e)
+	{
+		//outdated or broken cache is not an error, everything will be scanned again
+		logGlobal->debugStream() << "Resource index " << cacheFile << " dropped: " << e.what();
+		containers.clear();
+	}
+}
+
+bool CResourceIndexCache::makeStamp(const bfs::path & file, FileStamp & stamp)
+{
+	boost::system::error_code ec;
+	stamp.path = file.string();
+	stamp.modified = bfs::last_write_time(file, ec);
+	if(ec)
+		return false;
+
+	//timestamps have one second resolution, so change made in same second as scan may go unnoticed
+	if(stamp.modified + 1 >= std::time(nullptr))
+		return false;
+
+	stamp.size = bfs::is_directory(file, ec) ? 0 : bfs::file_size(file, ec);
+	return !ec;
+}
+
+bool CResourceIndexCache::find(const std::string & key, TEntries & entries) const
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	auto it = containers.find(key);
+	if(it == containers.end())
+		return false;
+
+	for(auto & stamp : it->second.files)
+	{
+		FileStamp current;
+		if(!makeStamp(stamp.path, current) || current.modified != stamp.modified || current.size != stamp.size)
+			return false;
+	}
+	entries = it->second.entries;
+	return true;
+}
+
+void CResourceIndexCache::store(const std::string & key, const std::vector<bfs::path> & files, TEntries entries)
+{
+	Container container;
+	container.files.resize(files.size());
+	for(size_t i = 0; i < files.size(); i++)
+	{
+		if(!makeStamp(files[i], container.files[i]))
+			return;
+	}
+	container.entries = std::move(entries);
+
+	boost::unique_lock<boost::mutex> lock(mx);
+	containers[key] = std::move(container);
+	modified = true;
+}
+
+void CResourceIndexCache::save()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	if(!modified)
+		return;
+
+	//drop containers that no longer exist, e.g. of uninstalled mods
+	vstd::erase_if(containers, [](const std::pair<const std::string, Container> & container)
+	{
+		return container.second.files.empty() || !bfs::exists(container.second.files.front().path);
+	});
+
+	//client and server may save at same time, so file is written under unique name and replaced at once
+	const bfs::path tempFile = cacheFile.parent_path() / bfs::unique_path(cacheFile.filename().string() + "-%%%%%%%%.tmp");
+	try
+	{
+		{
+			CSaveFile file(tempFile);
+			file << containers;
+		}
+		bfs::rename(tempFile, cacheFile);
+		modified = false;
+	}
+	catch(std::exception & e)
+	{
+		logGlobal->warnStream() << "Failed to save resource index to " << cacheFile << ": " << e.what();
+		boost::system::error_code ec;
+		bfs::remove(tempFile, ec);
+	}
+}
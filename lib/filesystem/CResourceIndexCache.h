@@ -0,0 +1,94 @@
+#pragma once
+
+/*
+ * CResourceIndexCache.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+/**
+ * Persistent cache of file lists of directories and archives, kept in user cache directory between launches.
+ *
+ * Every container is stored together with modification time and size of files and directories it was read from.
+ * Containers are validated with only these checks, so loaders scan again only containers that have changed.
+ *
+ * Class is thread-safe.
+ */
+class DLL_LINKAGE CResourceIndexCache
+{
+public:
+	/// Single file of container, meaning of name and values is defined by loader that stored it
+	struct Entry
+	{
+		std::string name;
+		std::array<si64, 3> values;
+
+		template <typename Handler> void serialize(Handler & h, const int version)
+		{
+			h & name & values;
+		}
+	};
+	typedef std::vector<Entry> TEntries;
+
+	/// Returns global instance, loaded from disk on first access
+	static CResourceIndexCache & get();
+
+	/**
+	 * Looks for up-to-date entries of container.
+	 *
+	 * @param key Unique identifier of container, e.g. its type, path and mount point
+	 * @param entries Filled with cached entries if found
+	 * @return true if container was cached and none of its files has changed since
+	 */
+	bool find(const std::string & key, TEntries & entries) const;
+
+	/**
+	 * Stores entries of container. Does nothing if state of some file can't be checked.
+	 *
+	 * @param key Unique identifier of container
+	 * @param files Files and directories that have to stay unchanged for entries to be valid
+	 * @param entries List of entries of container
+	 */
+	void store(const std::string & key, const std::vector<boost::filesystem::path> & files, TEntries entries);
+
+	/// Writes cache to disk if anything was stored since last save
+	void save();
+
+private:
+	struct FileStamp
+	{
+		std::string path;
+		si64 modified;
+		si64 size;
+
+		template <typename Handler> void serialize(Handler & h, const int version)
+		{
+			h & path & modified & size;
+		}
+	};
+
+	struct Container
+	{
+		std::vector<FileStamp> files;
+		TEntries entries;
+
+		template <typename Handler> void serialize(Handler & h, const int version)
+		{
+			h & files & entries;
+		}
+	};
+
+	CResourceIndexCache(boost::filesystem::path cacheFile);
+	void load();
+
+	static bool makeStamp(const boost::filesystem::path & file, FileStamp & stamp);
+
+	boost::filesystem::path cacheFile;
+	std::map<std::string, Container> containers;
+	bool modified;
+	mutable boost::mutex mx;
+};
@@ -1,6 +1,7 @@
 #include "StdInc.h"
 #include "CZipLoader.h"
 #include "FileStream.h"
+#include "CResourceIndexCache.h"
 
 #include "../ScopeGuard.h"
 
@@ -65,6 +66,21 @@ std::unordered_map<ResourceID, unz64_file_pos> CZipLoader::listFiles(const std::
 {
 	std::unordered_map<ResourceID, unz64_file_pos> ret;
 
+	// only archives on disk can be validated by resource index, not ones provided by custom IO API
+	const bool useIndex = std::dynamic_pointer_cast<CDefaultIOApi>(ioApi) != nullptr;
+	const std::string cacheKey = "zip:" + mountPoint + ":" + archive.string();
+	CResourceIndexCache::TEntries cached;
+	if(useIndex && CResourceIndexCache::get().find(cacheKey, cached))
+	{
+		for(auto & entry : cached)
+		{
+			unz64_file_pos & pos = ret[ResourceID(mountPoint + entry.name)];
+			pos.pos_in_zip_directory = entry.values[0];
+			pos.num_of_file = entry.values[1];
+		}
+		return ret;
+	}
+
 	unzFile file = unzOpen2_64(archive.c_str(), &zlibApi);
 
 	if(file == nullptr)
@@ -84,12 +100,21 @@ std::unordered_map<ResourceID, unz64_file_pos> CZipLoader::listFiles(const std::
 			unzGetCurrentFileInfo64 (file, &info, filename.data(), filename.size(), nullptr, 0, nullptr, 0);
 
 			std::string filenameString(filename.data(), filename.size());
-			unzGetFilePos64(file, &ret[ResourceID(mountPoint + filenameString)]);
+			unz64_file_pos & pos = ret[ResourceID(mountPoint + filenameString)];
+			unzGetFilePos64(file, &pos);
+
+			CResourceIndexCache::Entry entry;
+			entry.name = filenameString;
+			entry.values = {{si64(pos.pos_in_zip_directory), si64(pos.num_of_file), 0}};
+			cached.push_back(entry);
 		}
 		while (unzGoToNextFile(file) == UNZ_OK);
 	}
 	unzClose(file);
 
+	if(useIndex && file != nullptr)
+		CResourceIndexCache::get().store(cacheKey, std::vector<boost::filesystem::path>(1, archive), std::move(cached));
+
 	return ret;
 }
 
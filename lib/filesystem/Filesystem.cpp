@@ -5,6 +5,7 @@
 #include "CFilesystemLoader.h"
 #include "AdapterLoaders.h"
 #include "CZipLoader.h"
+#include "CResourceIndexCache.h"
 
 //For filesystem initialization
 #include "../JsonNode.h"
@@ -194,6 +195,7 @@ void CResourceHandler::load(const std::string &fsConfigURI)
 	const JsonNode fsConfig((char*)fsConfigData.first.get(), fsConfigData.second);
 
 	addFilesystem("data", "core", createFileSystem("", fsConfig["filesystem"]));
+	CResourceIndexCache::get().save();
 }
 
 void CResourceHandler::addFilesystem(const std::string & parent, const std::string & identifier, ISimpleResourceLoader * loader)
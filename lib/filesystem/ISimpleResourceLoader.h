@@ -13,6 +13,17 @@
 class CInputStream;
 class ResourceID;
 
+/**
+ * Returned by ISimpleResourceLoader::prefetch to its caller.
+ * Resources prefetched with it that were not loaded yet are freed when it is destroyed,
+ * so it must not outlive loader that created it.
+ */
+class DLL_LINKAGE IPrefetchHandle
+{
+public:
+	virtual ~IPrefetchHandle() { };
+};
+
 /**
  * A class which knows the files containing in the archive or system and how to load them.
  */
@@ -94,6 +105,18 @@ public:
 		return false;
 	}
 
+	/**
+	 * Loads listed resources in advance, possibly in parallel, so following load() calls only take them from memory.
+	 * Every prefetched resource is kept until it is loaded once or returned handle is destroyed.
+	 *
+	 * @param resources List of resources to load. Resources that don't exist are ignored.
+	 * @return handle owning prefetched resources, caller should keep it until loading that needs them is done
+	 */
+	virtual std::unique_ptr<IPrefetchHandle> prefetch(const std::vector<ResourceID> & resources) const
+	{
+		return make_unique<IPrefetchHandle>();
+	}
+
 	/**
 	 * @brief Returns all loaders that have resource with such name
 	 *
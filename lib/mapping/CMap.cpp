@@ -165,6 +165,23 @@ bool TerrainTile::isWater() const
 	return terType == ETerrainType::WATER;
 }
 
+TileMovementInfo::TileMovementInfo()
+	: terType(ETerrainType::WRONG), roadType(ERoadType::NO_ROAD), flags(0)
+{
+
+}
+
+TileMovementInfo::TileMovementInfo(const TerrainTile & tile)
+	: terType(tile.terType), roadType(tile.roadType), flags(0)
+{
+	if(tile.isWater())
+		flags |= WATER;
+	if(tile.hasFavorableWinds())
+		flags |= FAVORABLE_WINDS;
+	if(tile.blocked)
+		flags |= BLOCKED;
+}
+
 const int CMapHeader::MAP_SIZE_SMALL = 36;
 const int CMapHeader::MAP_SIZE_MIDDLE = 72;
 const int CMapHeader::MAP_SIZE_LARGE = 108;
@@ -272,6 +289,7 @@ void CMap::removeBlockVisTiles(CGObjectInstance * obj, bool total)
 					curt.blockingObjects -= obj;
 					curt.blocked = curt.blockingObjects.size();
 				}
+				updateMovementInfo(int3(xVal, yVal, zVal));
 			}
 		}
 	}
@@ -299,6 +317,7 @@ void CMap::addBlockVisTiles(CGObjectInstance * obj)
 					curt.blockingObjects.push_back(obj);
 					curt.blocked = true;
 				}
+				updateMovementInfo(int3(xVal, yVal, zVal));
 			}
 		}
 	}
@@ -317,6 +336,35 @@ void CMap::calculateGuardingGreaturePositions()
 	}
 }
 
+const TileMovementInfo & CMap::getMovementInfo(const int3 & tile) const
+{
+	assert(isInTheMap(tile));
+	return movementInfo[(tile.z * height + tile.y) * width + tile.x];
+}
+
+void CMap::initMovementInfo()
+{
+	int levels = twoLevel ? 2 : 1;
+	movementInfo.resize(width * height * levels);
+	for(int k = 0; k < levels; k++)
+	{
+		for(int j = 0; j < height; j++)
+		{
+			for(int i = 0; i < width; i++)
+				movementInfo[(k * height + j) * width + i] = TileMovementInfo(terrain[i][j][k]);
+		}
+	}
+}
+
+void CMap::updateMovementInfo(const int3 & tile)
+{
+	//not built yet, e.g. map is still being loaded or edited
+	if(movementInfo.empty())
+		return;
+
+	movementInfo[(tile.z * height + tile.y) * width + tile.x] = TileMovementInfo(getTile(tile));
+}
+
 CGHeroInstance * CMap::getHero(int heroID)
 {
 	for(auto & elem : heroesOnMap)
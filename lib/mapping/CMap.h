@@ -311,6 +311,11 @@ public:
 	void removeBlockVisTiles(CGObjectInstance * obj, bool total = false);
 	void calculateGuardingGreaturePositions();
 
+	/// Packed terrain data for pathfinder, built from terrain once map is ready and kept in sync by add/removeBlockVisTiles
+	const TileMovementInfo & getMovementInfo(const int3 & tile) const;
+	void initMovementInfo();
+	void updateMovementInfo(const int3 & tile);
+
 	void addNewArtifactInstance(CArtifactInstance * art);
 	void eraseArtifactInstance(CArtifactInstance * art);
 
@@ -357,6 +362,8 @@ public:
 private:
 	/// a 3-dimensional array of terrain tiles, access is as follows: x, y, level. where level=1 is underground
 	TerrainTile*** terrain;
+	/// flat array of packed terrain data, indexed by (level * height + y) * width + x. Not serialized, rebuilt on load
+	std::vector<TileMovementInfo> movementInfo;
 
 public:
 	template <typename Handler>
@@ -415,6 +422,9 @@ public:
 		h & objects;
 		h & heroesOnMap & teleportChannels & towns & artInstances;
 
+		if(!h.saving)
+			initMovementInfo();
+
 		// static members
 		h & CGKeys::playerKeyMap;
 		h & CGMagi::eyelist;
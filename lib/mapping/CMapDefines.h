@@ -96,3 +96,26 @@ struct DLL_LINKAGE TerrainTile
 		h & visitableObjects & blockingObjects;
 	}
 };
+
+/// Subset of terrain tile data which is needed to evaluate movement costs, packed into few bytes.
+/// Map keeps these in flat array so pathfinder don't have to look into terrain tiles for every edge.
+struct DLL_LINKAGE TileMovementInfo
+{
+	enum EFlags
+	{
+		WATER = 1,
+		FAVORABLE_WINDS = 2,
+		BLOCKED = 4
+	};
+
+	TileMovementInfo();
+	explicit TileMovementInfo(const TerrainTile & tile);
+
+	bool isWater() const { return flags & WATER; }
+	bool isBlocked() const { return flags & BLOCKED; }
+	bool hasFavorableWinds() const { return flags & FAVORABLE_WINDS; }
+
+	si8 terType;
+	si8 roadType;
+	ui8 flags;
+};
@@ -0,0 +1,163 @@
+/*
+ * CGridSearch.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#include "StdInc.h"
+#include "CGridSearch.h"
+
+#include "../mapping/CMap.h"
+
+static const std::array<int3, 8> dirs = int3::getDirs(); //first 4 directions are direct neighbours
+
+CGridSearch::CGridSearch(const CMap * map) :
+	map(map),
+	width(map->width),
+	height(map->height),
+	currentSearch(0),
+	goal(-1)
+{
+	Node empty = {0, -1, 0, false, false};
+	nodes.resize(width * height * (map->twoLevel ? 2 : 1), empty);
+}
+
+int CGridSearch::index(const int3 & tile) const
+{
+	return (tile.z * height + tile.y) * width + tile.x;
+}
+
+int3 CGridSearch::tileAt(int index) const
+{
+	return int3(index % width, (index / width) % height, index / (width * height));
+}
+
+CGridSearch::Node & CGridSearch::getNode(int index)
+{
+	Node & node = nodes[index];
+	if(node.search != currentSearch)
+	{
+		node.search = currentSearch;
+		node.parent = -1;
+		node.cost = 0;
+		node.open = false;
+		node.visited = false;
+		touched.push_back(index);
+	}
+	return node;
+}
+
+bool CGridSearch::find(const int3 & src, ENeighbours neighbours, const TGoalFunc & isGoal, const TCostFunc & cost)
+{
+	if(++currentSearch == 0) //counter wrapped, old stamps could be taken as current
+	{
+		for(auto & node : nodes)
+			node.search = 0;
+		currentSearch = 1;
+	}
+	touched.clear();
+	queue.clear();
+	goal = -1;
+
+	if(!map->isInTheMap(src)) //e.g. tile below object at bottom edge of map, dense arrays have no place for it
+		return false;
+
+	Node & start = getNode(index(src));
+	start.open = true;
+	queue.push_back(QueueEntry{0, src});
+
+	while(!queue.empty())
+	{
+		std::pop_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+		const QueueEntry current = queue.back();
+		queue.pop_back();
+
+		const int currentIndex = index(current.tile);
+		Node & node = nodes[currentIndex];
+		if(!node.open || node.cost != current.cost)
+			continue; //tile was queued again with different cost, this entry is outdated
+
+		node.open = false;
+		node.visited = true;
+
+		if(isGoal(current.tile))
+		{
+			goal = currentIndex;
+			return true;
+		}
+
+		switch(neighbours)
+		{
+		case DIRECT:
+			stepToNeighbours(current.tile, 4, cost);
+			break;
+		case ALL:
+			stepToNeighbours(current.tile, 8, cost);
+			break;
+		case DIRECT_OR_ALL:
+			if(!stepToNeighbours(current.tile, 4, cost))
+				stepToNeighbours(current.tile, 8, cost);
+			break;
+		}
+	}
+	return false;
+}
+
+bool CGridSearch::stepToNeighbours(const int3 & tile, size_t dirCount, const TCostFunc & cost)
+{
+	const int from = index(tile);
+	bool entered = false;
+	for(size_t i = 0; i < dirCount; i++)
+	{
+		const int3 neighbour = tile + dirs[i];
+		if(!map->isInTheMap(neighbour))
+			continue;
+
+		const float moveCost = cost(tile, neighbour);
+		if(moveCost >= 0 && step(from, neighbour, moveCost))
+			entered = true;
+	}
+	return entered;
+}
+
+bool CGridSearch::step(int from, const int3 & to, float moveCost)
+{
+	const float distance = nodes[from].cost + moveCost;
+	Node & node = getNode(index(to));
+
+	if(node.visited && distance >= node.cost)
+		return false;
+
+	node.parent = from;
+	node.cost = distance;
+	node.open = true;
+	queue.push_back(QueueEntry{distance, to});
+	std::push_heap(queue.begin(), queue.end(), std::greater<QueueEntry>());
+	return true;
+}
+
+std::vector<int3> CGridSearch::getPath() const
+{
+	std::vector<int3> path;
+	if(goal < 0)
+		return path;
+
+	for(int current = goal; nodes[current].parent >= 0; current = nodes[current].parent)
+		path.push_back(tileAt(current));
+	return path;
+}
+
+std::vector<int3> CGridSearch::getVisitedTiles() const
+{
+	std::vector<int3> tiles;
+	for(int i : touched)
+	{
+		if(nodes[i].visited)
+			tiles.push_back(tileAt(i));
+	}
+	return tiles;
+}
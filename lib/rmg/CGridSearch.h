@@ -0,0 +1,92 @@
+/*
+ * CGridSearch.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#pragma once
+
+#include "../int3.h"
+
+class CMap;
+
+/// Cheapest path search over map tiles, shared by all path searches of random map generator.
+/// State of tiles is kept in dense arrays covering whole map, which are reused by following searches,
+/// and tiles waiting for visit are kept in binary heap.
+class CGridSearch
+{
+public:
+	enum ENeighbours
+	{
+		DIRECT, //only 4 direct neighbours, e.g. for roads that can't be rendered diagonally
+		ALL, //all 8 neighbours
+		DIRECT_OR_ALL //all 8 neighbours, but only if none of direct ones was entered
+	};
+
+	/// returns cost of moving from tile to its neighbour, negative if neighbour can't be entered
+	typedef std::function<float(const int3 & from, const int3 & to)> TCostFunc;
+	/// returns true if search should stop at visited tile
+	typedef std::function<bool(const int3 & tile)> TGoalFunc;
+
+	explicit CGridSearch(const CMap * map);
+
+	/**
+	 * Searches for cheapest path from src to any goal tile.
+	 *
+	 * Visited tiles are taken in order of their cost, ties are broken by tile order (int3::operator<),
+	 * so results are stable between platforms and runs.
+	 * Tile that was not visited yet takes cost of every step into it, even if more expensive.
+	 *
+	 * @return true if goal was reached
+	 */
+	bool find(const int3 & src, ENeighbours neighbours, const TGoalFunc & isGoal, const TCostFunc & cost);
+
+	/// path found by last search, from goal tile back to (but without) source tile
+	std::vector<int3> getPath() const;
+	/// all tiles visited by last search
+	std::vector<int3> getVisitedTiles() const;
+
+private:
+	struct Node
+	{
+		ui32 search; //node is valid only if it was touched by current search
+		int parent;
+		float cost;
+		bool open;
+		bool visited;
+	};
+
+	struct QueueEntry
+	{
+		float cost;
+		int3 tile;
+
+		bool operator>(const QueueEntry & other) const
+		{
+			if(cost != other.cost)
+				return cost > other.cost;
+			return other.tile < tile;
+		}
+	};
+
+	const CMap * map;
+	int width, height;
+	std::vector<Node> nodes;
+	std::vector<QueueEntry> queue;
+	std::vector<int> touched; //nodes of current search
+	ui32 currentSearch;
+	int goal;
+
+	int index(const int3 & tile) const;
+	int3 tileAt(int index) const;
+	Node & getNode(int index);
+
+	/// moves to neighbour if it wasn't visited yet or if path is cheaper, returns true on success
+	bool step(int from, const int3 & to, float moveCost);
+	/// tries neighbours in first dirCount directions of int3::getDirs(), returns true if any was entered
+	bool stepToNeighbours(const int3 & tile, size_t dirCount, const TCostFunc & cost);
+};
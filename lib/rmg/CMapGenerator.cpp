@@ -8,10 +8,13 @@
 #include "../CTownHandler.h"
 #include "../StringConstants.h"
 #include "../filesystem/Filesystem.h"
+#include "../CThreadHelper.h"
 #include "CZonePlacer.h"
+#include "CGridSearch.h"
 #include "../mapObjects/CObjectClassesHandler.h"
 
 static const int3 dirs4[] = {int3(0,1,0),int3(0,-1,0),int3(-1,0,0),int3(+1,0,0)};
+static const size_t MIN_QUEST_ARTS_PER_ZONE = 8; //zone won't place seer huts with fewer artifacts, see CRmgTemplateZone::addAllPossibleObjects
 
 void CMapGenerator::foreach_neighbour(const int3 &pos, std::function<void(int3& pos)> foo)
 {
@@ -37,10 +40,15 @@ void CMapGenerator::foreachDirectNeighbour(const int3& pos, std::function<void(i
 
 
 CMapGenerator::CMapGenerator() :
-    zonesTotal(0), monolithIndex(0)
+    zonesTotal(0), zoneFillThreads(1), monolithIndex(0)
 {
 }
 
+void CMapGenerator::setZoneFillThreads(int threads)
+{
+	zoneFillThreads = std::max(1, threads);
+}
+
 void CMapGenerator::initTiles()
 {
 	map->initTerrain();
@@ -60,6 +68,7 @@ void CMapGenerator::initTiles()
 	}
 
 	zoneColouring.resize(boost::extents[map->twoLevel ? 2 : 1][map->width][map->height]);
+	gridSearch = make_unique<CGridSearch>(map.get());
 }
 
 CMapGenerator::~CMapGenerator()
@@ -108,6 +117,9 @@ std::unique_ptr<CMap> CMapGenerator::generate(CMapGenOptions * mapGenOptions, in
 	assert(mapGenOptions);
 
 	rand.setSeed(this->randomSeed);
+	phaseTimes.clear();
+	phaseStart = boost::posix_time::microsec_clock::universal_time();
+	error.clear();
 	mapGenOptions->finalize(rand);
 
 	map = make_unique<CMap>();
@@ -122,14 +134,17 @@ std::unique_ptr<CMap> CMapGenerator::generate(CMapGenOptions * mapGenOptions, in
 
 		initPrisonsRemaining();
 		initQuestArtsRemaining();
+		finishPhase("init");
 		genZones();
 		map->calculateGuardingGreaturePositions(); //clear map so that all tiles are unguarded
+		finishPhase("zones");
 		fillZones();
 		//updated guarded tiles will be calculated in CGameState::initMapObjects()
 	}
 	catch (rmgException &e)
 	{
 		logGlobal->errorStream() << "Random map generation received exception: " << e.what();
+		error = e.what();
 	}
 	return std::move(map);
 }
@@ -250,8 +265,23 @@ void CMapGenerator::genZones()
 	editManager->getTerrainSelection().selectRange(MapRect(int3(0, 0, 0), mapGenOptions->getWidth(), mapGenOptions->getHeight()));
 	editManager->drawTerrain(ETerrainType::GRASS, &rand);
 
+	//zones keep state of generation, so every map is generated with own copies of template zones
 	auto tmpl = mapGenOptions->getMapTemplate();
-	zones = tmpl->getZones(); //copy from template (refactor?)
+	zones.clear();
+	ownedZones.clear();
+	for (auto & it : tmpl->getZones())
+	{
+		auto zone = std::make_shared<CRmgTemplateZone>(*it.second);
+		ownedZones.push_back(zone);
+		zones[it.first] = zone.get();
+	}
+	connections.clear();
+	for (auto connection : tmpl->getConnections())
+	{
+		connection.setZoneA(zones.at(connection.getZoneA()->getId()));
+		connection.setZoneB(zones.at(connection.getZoneB()->getId()));
+		connections.push_back(connection);
+	}
 
 	CZonePlacer placer(this);
 	placer.placeZones(mapGenOptions, &rand);
@@ -284,14 +314,26 @@ void CMapGenerator::fillZones()
 	//we need info about all town types to evaluate dwellings and pandoras with creatures properly
 	for (auto it : zones)
 		it.second->initTownType(this);
+	finishPhase("connections");
+
+	if (zoneFillThreads > 1)
+		fillZonesInParallel();
+	else
+	{
+		for (auto it : zones)
+		{
+			it.second->initTerrainType(this);
+			it.second->fill(this);
+		}
+	}
 
 	std::vector<CRmgTemplateZone*> treasureZones;
 	for (auto it : zones)
 	{
-		it.second->fill(this);
 		if (it.second->getType() == ETemplateZoneType::TREASURE)
 			treasureZones.push_back(it.second);
 	}
+	finishPhase("fill");
 
 	//set apriopriate free/occupied tiles, including blocked underground rock
 	createObstaclesCommon1();
@@ -304,6 +346,7 @@ void CMapGenerator::fillZones()
 	{
 		it.second->createObstacles2(this);
 	}
+	finishPhase("obstacles");
 
 	#define PRINT_MAP_BEFORE_ROADS true
 	if (PRINT_MAP_BEFORE_ROADS) //enable to debug
@@ -354,6 +397,7 @@ void CMapGenerator::fillZones()
 	auto grailZone = *RandomGeneratorUtil::nextItem(treasureZones, rand);
 
 	map->grailPos = *RandomGeneratorUtil::nextItem(*grailZone->getFreePaths(), rand);
+	finishPhase("roads");
 
 	logGlobal->infoStream() << "Zones filled successfully";
 }
@@ -442,11 +486,124 @@ void CMapGenerator::createObstaclesCommon2()
 	}
 }
 
+void CMapGenerator::fillZonesInParallel()
+{
+	//painting terrain updates views of tiles in neighbouring zones
+	for (auto it : zones)
+		it.second->initTerrainType(this);
+
+	//prisons and seer huts are split between zones up front, so zones don't depend on order in which they are filled
+	std::vector<ui32> heroes;
+	for (int i = 0; i < map->allowedHeroes.size(); i++)
+	{
+		if (map->allowedHeroes[i])
+			heroes.push_back(i);
+	}
+	RandomGeneratorUtil::randomShuffle(heroes, rand);
+
+	std::vector<ArtifactID> questArts = questArtifacts;
+	RandomGeneratorUtil::randomShuffle(questArts, rand);
+	std::vector<CRmgTemplateZone *> questZones;
+	for (auto it : zones)
+	{
+		if (it.second->getQuestArtZone())
+			questZones.push_back(it.second);
+	}
+	//better give enough artifacts to some zones than too few to all of them
+	const size_t questArtsPerZone = questZones.empty() ? 0 : std::max(MIN_QUEST_ARTS_PER_ZONE, questArts.size() / questZones.size());
+
+	//zone can be filled only after zones which place artifacts for their seer huts in it
+	std::map<TRmgTemplateZoneId, size_t> waveOfZone;
+	std::vector<std::vector<CRmgTemplateZone *>> waves;
+	const int zoneCount = zones.size();
+	int zoneIndex = 0;
+	for (auto it : zones)
+	{
+		auto zone = it.second;
+		const size_t wave = waveOfZone[zone->getId()];
+		if (zone->getQuestArtZone()) //quest art zone has always higher id
+			vstd::amax(waveOfZone[zone->getQuestArtZone()->getId()], wave + 1);
+		if (waves.size() <= wave)
+			waves.resize(wave + 1);
+		waves[wave].push_back(zone);
+
+		std::vector<ui32> zoneHeroes;
+		for (size_t i = zoneIndex; i < heroes.size(); i += zoneCount)
+			zoneHeroes.push_back(heroes[i]);
+		const int zonePrisons = prisonsRemaining / zoneCount + (zoneIndex < prisonsRemaining % zoneCount ? 1 : 0);
+
+		std::vector<ArtifactID> zoneQuestArts;
+		auto questZone = std::find(questZones.begin(), questZones.end(), zone);
+		if (questZone != questZones.end())
+		{
+			const size_t first = std::min(questArts.size(), (questZone - questZones.begin()) * questArtsPerZone);
+			const size_t last = (questZone + 1 == questZones.end()) ? questArts.size() : std::min(questArts.size(), first + questArtsPerZone);
+			zoneQuestArts.assign(questArts.begin() + first, questArts.begin() + last);
+		}
+
+		//splitmix64 of map seed and zone id, fixed width so maps are the same on 32 and 64-bit platforms
+		ui64 seed = ((ui64(ui32(randomSeed)) << 32) | ui32(zone->getId())) + 0x9E3779B97F4A7C15ULL;
+		seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+		seed ^= seed >> 31;
+		zone->startParallelFill(this, static_cast<int>(ui32(seed)), zoneHeroes, zonePrisons, zoneQuestArts);
+		zoneIndex++;
+	}
+
+	try
+	{
+		for (auto & wave : waves)
+		{
+			std::vector<std::exception_ptr> errors(wave.size());
+			std::vector<Task> tasks;
+			for (size_t i = 0; i < wave.size(); i++)
+			{
+				auto zone = wave[i];
+				auto & error = errors[i];
+				tasks.push_back([this, zone, &error]()
+				{
+					try
+					{
+						zone->fill(this);
+					}
+					catch (...)
+					{
+						error = std::current_exception();
+					}
+				});
+			}
+			CThreadHelper threadHelper(&tasks, std::min<int>(zoneFillThreads, tasks.size()));
+			threadHelper.run();
+
+			for (auto & error : errors)
+			{
+				if (error)
+					std::rethrow_exception(error);
+			}
+			for (auto zone : wave)
+			{
+				if (zone->getQuestArtZone())
+					zone->passQuestArts();
+			}
+		}
+	}
+	catch (...)
+	{
+		for (auto it : zones)
+			it.second->abortParallelFill();
+		throw;
+	}
+
+	//objects get their ids in the same order regardless of threads
+	for (auto it : zones)
+		it.second->finishParallelFill(this);
+}
+
 void CMapGenerator::findZonesForQuestArts()
 {
 	//we want to place arties in zones that were not yet filled (higher index)
 
-	for (auto connection : mapGenOptions->getMapTemplate()->getConnections())
+	for (auto connection : connections)
 	{
 		auto zoneA = connection.getZoneA();
 		auto zoneB = connection.getZoneB();
@@ -464,18 +621,18 @@ void CMapGenerator::findZonesForQuestArts()
 
 void CMapGenerator::createDirectConnections()
 {
-	for (auto connection : mapGenOptions->getMapTemplate()->getConnections())
+	for (auto connection : connections)
 	{
 		auto zoneA = connection.getZoneA();
 		auto zoneB = connection.getZoneB();
 
 		//rearrange tiles in random order
-		auto tilesCopy = zoneA->getTileInfo();
-		std::vector<int3> tiles(tilesCopy.begin(), tilesCopy.end());
+		auto & zoneTiles = zoneA->getTileInfo();
+		std::vector<int3> tiles(zoneTiles.begin(), zoneTiles.end());
 
 		int3 guardPos(-1,-1,-1);
 
-		auto otherZoneTiles = zoneB->getTileInfo();
+		auto & otherZoneTiles = zoneB->getTileInfo();
 
 		int3 posA = zoneA->getPos();
 		int3 posB = zoneB->getPos();
@@ -485,7 +642,7 @@ void CMapGenerator::createDirectConnections()
 		if (posA.z == posB.z)
 		{
 			std::vector<int3> middleTiles;
-			for (auto tile : tilesCopy)
+			for (auto tile : zoneTiles)
 			{
 				if (isBlocked(tile)) //tiles may be occupied by subterranean gates already placed
 					continue;
@@ -564,8 +721,8 @@ void CMapGenerator::createConnections2()
 			{
 				bool continueOuterLoop = false;
 				//find common tiles for both zones
-				auto tileSetA = zoneA->getPossibleTiles(),
-					tileSetB = zoneB->getPossibleTiles();
+				auto & tileSetA = zoneA->getPossibleTiles();
+				auto & tileSetB = zoneB->getPossibleTiles();
 
 				std::vector<int3> tilesA(tileSetA.begin(), tileSetA.end()),
 					tilesB(tileSetB.begin(), tileSetB.end());
@@ -758,6 +915,29 @@ void CMapGenerator::setZoneID(const int3& tile, TRmgTemplateZoneId zid)
 	zoneColouring[tile.z][tile.x][tile.y] = zid;
 }
 
+CGridSearch & CMapGenerator::getGridSearch()
+{
+	return *gridSearch;
+}
+
+const std::vector<std::pair<std::string, si64>> & CMapGenerator::getPhaseTimes() const
+{
+	return phaseTimes;
+}
+
+const std::string & CMapGenerator::getError() const
+{
+	return error;
+}
+
+void CMapGenerator::finishPhase(const std::string & name)
+{
+	auto now = boost::posix_time::microsec_clock::universal_time();
+	phaseTimes.push_back(std::make_pair(name, (now - phaseStart).total_milliseconds()));
+	phaseStart = now;
+	logGlobal->debugStream() << boost::format("Map generation phase %s took %d ms") % name % phaseTimes.back().second;
+}
+
 bool CMapGenerator::isAllowedSpell(SpellID sid) const
 {
 	assert(sid >= 0);
@@ -821,9 +1001,11 @@ void CMapGenerator::registerZone (TFaction faction)
 	zonesPerFaction[faction]++;
 	zonesTotal++;
 }
-ui32 CMapGenerator::getZoneCount(TFaction faction)
+ui32 CMapGenerator::getZoneCount(TFaction faction) const
 {
-	return zonesPerFaction[faction];
+	//zones may ask for factions without any zone, don't insert them while zones are filled in parallel
+	auto it = zonesPerFaction.find(faction);
+	return it != zonesPerFaction.end() ? it->second : 0;
 }
 ui32 CMapGenerator::getTotalZoneCount() const
 {
@@ -27,6 +27,7 @@ class CMapEditManager;
 class JsonNode;
 class CMapGenerator;
 class CTileInfo;
+class CGridSearch;
 
 typedef std::vector<JsonNode> JsonVector;
 
@@ -93,26 +94,52 @@ public:
 	void banQuestArt(ArtifactID id);
 
 	void registerZone (TFaction faction);
-	ui32 getZoneCount(TFaction faction);
+	ui32 getZoneCount(TFaction faction) const;
 	ui32 getTotalZoneCount() const;
 
 	TRmgTemplateZoneId getZoneID(const int3& tile) const;
 	void setZoneID(const int3& tile, TRmgTemplateZoneId zid);
 
+	/// path search shared by all zones, sized for current map
+	CGridSearch & getGridSearch();
+
+	/// names of generation phases with (wall clock) time spent in them in ms, in order of execution
+	const std::vector<std::pair<std::string, si64>> & getPhaseTimes() const;
+
+	/// error which stopped last generation, empty if it was successful - otherwise generated map is incomplete
+	const std::string & getError() const;
+
+	/// Sets number of threads used to fill zones, default is 1.
+	/// With more threads every zone uses own random generator and share of prisons and quest artifacts,
+	/// so generated map differs from one filled on single thread, but is the same for any number of threads above 1.
+	void setZoneFillThreads(int threads);
+
+	/// guards creation of map objects, new objects attach themselves to creature and artifact types shared by all zones
+	boost::mutex objectsMx;
+
 private:
 	std::list<CRmgTemplateZoneConnection> connectionsLeft;
 	std::map<TRmgTemplateZoneId, CRmgTemplateZone*> zones;
+	std::vector<std::shared_ptr<CRmgTemplateZone>> ownedZones; //copies of template zones, which are left untouched
+	std::vector<CRmgTemplateZoneConnection> connections; //connections of template, between copied zones
 	std::map<TFaction, ui32> zonesPerFaction;
 	ui32 zonesTotal; //zones that have their main town only
 
 	CTileInfo*** tiles;
 	boost::multi_array<TRmgTemplateZoneId, 3> zoneColouring; //[z][x][y]
+	std::unique_ptr<CGridSearch> gridSearch;
+	int zoneFillThreads;
+
+	boost::posix_time::ptime phaseStart; //not CStopWatch, which measures CPU time of all threads
+	std::vector<std::pair<std::string, si64>> phaseTimes;
+	std::string error;
 
 	int prisonsRemaining;
 	//int questArtsRemaining;
 	int monolithIndex;
 	std::vector<ArtifactID> questArtifacts;
 	void checkIsOnMap(const int3 &tile) const; //throws
+	void finishPhase(const std::string & name);
 
 	/// Generation methods
 	std::string getMapDescription() const;
@@ -124,6 +151,7 @@ private:
 	void initTiles();
 	void genZones();
 	void fillZones();
+	void fillZonesInParallel();
 	void createObstaclesCommon1();
 	void createObstaclesCommon2();
 
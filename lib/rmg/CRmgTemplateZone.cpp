@@ -11,6 +11,7 @@
 
 #include "StdInc.h"
 #include "CRmgTemplateZone.h"
+#include "CGridSearch.h"
 #include "../mapping/CMapEditManager.h"
 #include "../mapping/CMap.h"
 
@@ -152,6 +153,41 @@ void CTileInfo::setRoadType(ERoadType::ERoadType value)
 //	setOccupied(ETileType::FREE);
 }
 
+struct CRmgTemplateZone::ParallelFillState
+{
+	CRandomGenerator rand;
+	std::unique_ptr<CGridSearch> gridSearch;
+	std::vector<ui32> prisonHeroes; //heroes left for prisons of this zone
+	int prisonsRemaining;
+	std::vector<ui32> usedHeroes;
+	std::vector<ArtifactID> questArts; //artifacts left for seer huts of this zone
+	std::vector<ArtifactID> usedQuestArts;
+	std::vector<std::pair<CGObjectInstance *, int3>> objects; //placed objects in order of placement, they get their ids once all zones are filled
+	std::vector<ObjectInfo> questArtInfos; //artifacts to be placed in quest art zone
+};
+
+CRmgTemplateZone::ParallelFillHolder::ParallelFillHolder()
+{
+}
+
+CRmgTemplateZone::ParallelFillHolder::ParallelFillHolder(const ParallelFillHolder & other)
+{
+}
+
+CRmgTemplateZone::ParallelFillHolder & CRmgTemplateZone::ParallelFillHolder::operator=(const ParallelFillHolder & other)
+{
+	state.reset();
+	return *this;
+}
+
+CRmgTemplateZone::ParallelFillHolder::~ParallelFillHolder()
+{
+}
+
+void CRmgTemplateZone::ParallelFillHolder::reset(ParallelFillState * value)
+{
+	state.reset(value);
+}
 
 CRmgTemplateZone::CRmgTemplateZone() :
 	id(0),
@@ -322,6 +358,11 @@ void CRmgTemplateZone::setQuestArtZone(CRmgTemplateZone * otherZone)
 	questArtZone = otherZone;
 }
 
+CRmgTemplateZone * CRmgTemplateZone::getQuestArtZone() const
+{
+	return questArtZone;
+}
+
 std::vector<TRmgTemplateZoneId> CRmgTemplateZone::getConnections() const
 {
 	return connections;
@@ -343,7 +384,7 @@ std::vector<CTreasureInfo> CRmgTemplateZone::getTreasureInfo()
 	return treasureInfo;
 }
 
-std::set<int3>* CRmgTemplateZone::getFreePaths()
+CTileSet* CRmgTemplateZone::getFreePaths()
 {
 	return &freePaths;
 }
@@ -388,11 +429,11 @@ void CRmgTemplateZone::addTile (const int3 &pos)
 	tileinfo.insert(pos);
 }
 
-std::set<int3> CRmgTemplateZone::getTileInfo () const
+const CTileSet & CRmgTemplateZone::getTileInfo () const
 {
 	return tileinfo;
 }
-std::set<int3> CRmgTemplateZone::getPossibleTiles() const
+const CTileSet & CRmgTemplateZone::getPossibleTiles() const
 {
 	return possibleTiles;
 }
@@ -409,7 +450,7 @@ void CRmgTemplateZone::discardDistantTiles (CMapGenerator* gen, float distance)
 	//		//gen->setOccupied(tile, ETileType::BLOCKED); //fixme: crash at rendering?
 	//	}
 	//}
-	vstd::erase_if (tileinfo, [distance, this](const int3 &tile) -> bool
+	tileinfo.eraseIf([distance, this](const int3 &tile) -> bool
 	{
 		return tile.dist2d(this->pos) > distance;
 	});
@@ -422,10 +463,12 @@ void CRmgTemplateZone::clearTiles()
 
 void CRmgTemplateZone::initFreeTiles (CMapGenerator* gen)
 {
-	vstd::copy_if (tileinfo, vstd::set_inserter(possibleTiles), [gen](const int3 &tile) -> bool
+	for (auto tile : tileinfo)
 	{
-		return gen->isPossible(tile);
-	});
+		if (gen->isPossible(tile))
+			possibleTiles.insert(tile);
+	}
+	distanceIndex.reset(gen, possibleTiles);
 	if (freePaths.empty())
 	{
 		gen->setOccupied(pos, ETileType::FREE);
@@ -465,8 +508,8 @@ void CRmgTemplateZone::fractalize(CMapGenerator* gen)
 			freePaths.insert(tile);
 	}
 	std::vector<int3> clearedTiles (freePaths.begin(), freePaths.end());
-	std::set<int3> possibleTiles;
-	std::set<int3> tilesToIgnore; //will be erased in this iteration
+	CTileSet possibleTiles;
+	CTileSet tilesToIgnore; //will be erased in this iteration
 
 	//the more treasure density, the greater distance between paths. Scaling is experimental.
 	int totalDensity = 0;
@@ -493,7 +536,7 @@ void CRmgTemplateZone::fractalize(CMapGenerator* gen)
 		{
 			//link tiles in random order
 			std::vector<int3> tilesToMakePath(possibleTiles.begin(), possibleTiles.end());
-			RandomGeneratorUtil::randomShuffle(tilesToMakePath, gen->rand);
+			RandomGeneratorUtil::randomShuffle(tilesToMakePath, getRand(gen));
 
 			int3 nodeFound(-1, -1, -1);
 
@@ -532,7 +575,7 @@ void CRmgTemplateZone::fractalize(CMapGenerator* gen)
 			for (auto tileToClear : tilesToIgnore)
 			{
 				//these tiles are already connected, ignore them
-				vstd::erase_if_present(possibleTiles, tileToClear);
+				possibleTiles.erase(tileToClear);
 			}
 			if (!nodeFound.valid()) //nothing else can be done (?)
 				break;
@@ -641,7 +684,7 @@ void CRmgTemplateZone::connectLater(CMapGenerator* gen)
 	}
 }
 
-bool CRmgTemplateZone::crunchPath(CMapGenerator* gen, const int3 &src, const int3 &dst, bool onlyStraight, std::set<int3>* clearedTiles)
+bool CRmgTemplateZone::crunchPath(CMapGenerator* gen, const int3 &src, const int3 &dst, bool onlyStraight, CTileSet* clearedTiles)
 {
 /*
 make shortest path with free tiles, reachning dst or closest already free tile. Avoid blocks.
@@ -752,167 +795,69 @@ do not leave zone border
 
 bool CRmgTemplateZone::createRoad(CMapGenerator* gen, const int3& src, const int3& dst)
 {
-	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
-
-	std::set<int3> closed;    // The set of nodes already evaluated.
-	std::set<int3> open{src};    // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
-
-	//int3 currentNode = src;
 	gen->setRoad (src, ERoadType::NO_ROAD); //just in case zone guard already has road under it. Road under nodes will be added at very end
 
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
-	distances[src] = 0;
-	// Cost from start along best known path.
-	// Estimated total cost from start to goal through y.
-
-	while (open.size())
+	auto isGoal = [gen, &dst](const int3 & tile) -> bool
 	{
-		int3 currentNode = *boost::min_element(open, [&distances](const int3 &pos1, const int3 &pos2) -> bool
-		{
-			return distances[pos1] < distances[pos2];
-		});
-
-		vstd::erase_if_present (open, currentNode);
-		closed.insert (currentNode);
+		return tile == dst || gen->isRoad(tile);
+	};
+	auto cost = [gen, this, &dst](const int3 & from, const int3 & to) -> float
+	{
+		if (to == dst)
+			return 1;
+		if (gen->getZoneID(to) != id) //otherwise guard position may appear already connected to other zone.
+			return -1;
+
+		//if (gen->map->checkForVisitableDir(from, &gen->map->getTile(to), to)) //TODO: why it has no effect?
+		auto obj = gen->map->getTile(to).topVisitableObj();
+		if (gen->isFree(to) || (obj && obj->ID == Obj::MONSTER))
+			return 1;
+		return -1;
+	};
 
-		if (currentNode == dst || gen->isRoad(currentNode))
-		{
-			// The goal node was reached. Trace the path using
-			// the saved parent information and return path
-			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
-			{
-				// add node to path
-				roads.insert (backTracking);
-				gen->setRoad (backTracking, ERoadType::COBBLESTONE_ROAD);
-				//logGlobal->traceStream() << boost::format("Setting road at tile %s") % backTracking;
-				// do the same for the predecessor
-				backTracking = cameFrom[backTracking];
-			}
-			return true;
-		}
-		else
+	// roads cannot be rendered correctly for diagonal directions
+	auto & search = getGridSearch(gen);
+	if (search.find(src, CGridSearch::DIRECT_OR_ALL, isGoal, cost))
+	{
+		for (auto & tile : search.getPath())
 		{
-			bool directNeighbourFound = false;
-			float movementCost = 1;
-
-			auto foo = [gen, this, &open, &closed, &cameFrom, &currentNode, &distances, &dst, &directNeighbourFound, movementCost](int3& pos) -> void
-			{
-				float distance = distances[currentNode] + movementCost;
-				int bestDistanceSoFar = 1e6; //FIXME: boost::limits
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
-
-				if (distance < bestDistanceSoFar || !vstd::contains(closed, pos))
-				{
-					auto obj = gen->map->getTile(pos).topVisitableObj();
-					//if (gen->map->checkForVisitableDir(currentNode, &gen->map->getTile(pos), pos)) //TODO: why it has no effect?
-					if (gen->isFree(pos) || pos == dst || (obj && obj->ID == Obj::MONSTER))
-					{
-						if (gen->getZoneID(pos) == id || pos == dst) //otherwise guard position may appear already connected to other zone.
-						{
-							cameFrom[pos] = currentNode;
-							open.insert(pos);
-							distances[pos] = distance;
-							directNeighbourFound = true;
-							//logGlobal->traceStream() << boost::format("Found connection between node %s and %s, current distance %d") % currentNode % pos % distance;
-						}
-					}
-				}
-			};
-
-			gen->foreachDirectNeighbour (currentNode, foo); // roads cannot be rendered correctly for diagonal directions
-			if (!directNeighbourFound)
-			{
-				movementCost = 2.1f; //moving diagonally is penalized over moving two tiles straight
-				gen->foreach_neighbour(currentNode, foo);
-			}
+			roads.insert (tile);
+			gen->setRoad (tile, ERoadType::COBBLESTONE_ROAD);
 		}
-
+		return true;
 	}
+
 	logGlobal->warnStream() << boost::format("Failed to create road from %s to %s") % src %dst;
 	return false;
-
 }
 
 bool CRmgTemplateZone::connectPath(CMapGenerator* gen, const int3& src, bool onlyStraight)
 ///connect current tile to any other free tile within zone
 {
-	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
-
-	std::set<int3> closed;    // The set of nodes already evaluated.
-	std::set<int3> open{ src };    // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
-
-	//int3 currentNode = src;
-
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
-	distances[src] = 0;
-	// Cost from start along best known path.
-	// Estimated total cost from start to goal through y.
-
-	while (open.size())
+	auto isGoal = [gen](const int3 & tile) -> bool
 	{
-		int3 currentNode = *boost::min_element(open, [&distances](const int3 &pos1, const int3 &pos2) -> bool
-		{
-			return distances[pos1] < distances[pos2];
-		});
-
-		vstd::erase_if_present(open, currentNode);
-		closed.insert(currentNode);
-
-		if (gen->isFree(currentNode)) //we reached free paths, stop
-		{
-			// Trace the path using the saved parent information and return path
-			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
-			{
-				gen->setOccupied(backTracking, ETileType::FREE);
-				backTracking = cameFrom[backTracking];
-			}
-			return true;
-		}
-		else
-		{
-			auto foo = [gen, this, &open, &closed, &cameFrom, &currentNode, &distances](int3& pos) -> void
-			{
-				if (gen->isBlocked(pos)) //no paths through blocked or occupied tiles
-					return;
-
-				int distance = distances[currentNode] + 1;
-				int bestDistanceSoFar = 1e6; //FIXME: boost::limits
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
-
-				if (distance < bestDistanceSoFar || !vstd::contains(closed, pos))
-				{
-					//auto obj = gen->map->getTile(pos).topVisitableObj();
-					if (gen->getZoneID(pos) == id)
-					{
-						cameFrom[pos] = currentNode;
-						open.insert(pos);
-						distances[pos] = distance;
-					}
-				}
-			};
-
-			if (onlyStraight)
-				gen->foreachDirectNeighbour(currentNode, foo);
-			else
-				gen->foreach_neighbour(currentNode, foo);
-		}
+		return gen->isFree(tile); //we reached free paths, stop
+	};
+	auto cost = [gen, this](const int3 & from, const int3 & to) -> float
+	{
+		if (gen->isBlocked(to) || gen->getZoneID(to) != id) //no paths through blocked or occupied tiles
+			return -1;
+		return 1;
+	};
 
+	auto & search = getGridSearch(gen);
+	if (search.find(src, onlyStraight ? CGridSearch::DIRECT : CGridSearch::ALL, isGoal, cost))
+	{
+		for (auto & tile : search.getPath())
+			gen->setOccupied(tile, ETileType::FREE);
+		return true;
 	}
-	for (auto tile : closed) //these tiles are sealed off and can't be connected anymore
+
+	for (auto & tile : search.getVisitedTiles()) //these tiles are sealed off and can't be connected anymore
 	{
 		//TODO: refactor, unify?
 		gen->setOccupied (tile, ETileType::BLOCKED);
-		vstd::erase_if_present(possibleTiles, tile);
+		possibleTiles.erase(tile);
 	}
 	return false;
 }
@@ -920,77 +865,29 @@ bool CRmgTemplateZone::connectPath(CMapGenerator* gen, const int3& src, bool onl
 bool CRmgTemplateZone::connectWithCenter(CMapGenerator* gen, const int3& src, bool onlyStraight)
 ///connect current tile to any other free tile within zone
 {
-	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
-
-	std::set<int3> closed;    // The set of nodes already evaluated.
-	std::set<int3> open{ src };    // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
-
-	//int3 currentNode = src;
-
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
-	distances[src] = 0;
-	// Cost from start along best known path.
-	// Estimated total cost from start to goal through y.
-
-	while (open.size())
+	auto isGoal = [this](const int3 & tile) -> bool
 	{
-		int3 currentNode = *boost::min_element(open, [&distances](const int3 &pos1, const int3 &pos2) -> bool
-		{
-			return distances[pos1] < distances[pos2];
-		});
-
-		vstd::erase_if_present(open, currentNode);
-		closed.insert(currentNode);
+		return tile == pos; //we reached center of the zone, stop
+	};
+	auto cost = [gen, this](const int3 & from, const int3 & to) -> float
+	{
+		if (gen->getZoneID(to) != id)
+			return -1;
 
-		if (currentNode == pos) //we reached center of the zone, stop
-		{
-			// Trace the path using the saved parent information and return path
-			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
-			{
-				gen->setOccupied(backTracking, ETileType::FREE);
-				backTracking = cameFrom[backTracking];
-			}
-			return true;
-		}
+		if (gen->isFree(to)) //we prefer to use already free paths
+			return 1;
+		else if (gen->isPossible(to))
+			return 2;
 		else
-		{
-			auto foo = [gen, this, &open, &closed, &cameFrom, &currentNode, &distances](int3& pos) -> void
-			{
-				float movementCost = 0;
-				if (gen->isFree(pos))
-					movementCost = 1;
-				else if (gen->isPossible(pos))
-					movementCost = 2;
-				else
-					return;
-
-				float distance = distances[currentNode] + movementCost; //we prefer to use already free paths
-				int bestDistanceSoFar = 1e6; //FIXME: boost::limits
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
-
-				if (distance < bestDistanceSoFar || !vstd::contains(closed, pos))
-				{
-					//auto obj = gen->map->getTile(pos).topVisitableObj();
-					if (gen->getZoneID(pos) == id)
-					{
-						cameFrom[pos] = currentNode;
-						open.insert(pos);
-						distances[pos] = distance;
-					}
-				}
-			};
-
-			if (onlyStraight)
-				gen->foreachDirectNeighbour(currentNode, foo);
-			else
-				gen->foreach_neighbour(currentNode, foo);
-		}
+			return -1;
+	};
 
+	auto & search = getGridSearch(gen);
+	if (search.find(src, onlyStraight ? CGridSearch::DIRECT : CGridSearch::ALL, isGoal, cost))
+	{
+		for (auto & tile : search.getPath())
+			gen->setOccupied(tile, ETileType::FREE);
+		return true;
 	}
 	return false;
 }
@@ -1045,10 +942,10 @@ bool CRmgTemplateZone::addMonster(CMapGenerator* gen, int3 &pos, si32 strength,
 	}
 	if (possibleCreatures.size())
 	{
-		creId = *RandomGeneratorUtil::nextItem(possibleCreatures, gen->rand);
+		creId = *RandomGeneratorUtil::nextItem(possibleCreatures, getRand(gen));
 		amount = strength / VLC->creh->creatures[creId]->AIValue;
 		if (amount >= 4)
-			amount *= gen->rand.nextDouble(0.75, 1.25);
+			amount *= getRand(gen).nextDouble(0.75, 1.25);
 	}
 	else //just pick any available creature
 	{
@@ -1058,11 +955,15 @@ bool CRmgTemplateZone::addMonster(CMapGenerator* gen, int3 &pos, si32 strength,
 
 	auto guardFactory = VLC->objtypeh->getHandlerFor(Obj::MONSTER, creId);
 
-	auto guard = (CGCreature *) guardFactory->create(ObjectTemplate());
-	guard->character = CGCreature::HOSTILE;
-	auto  hlp = new CStackInstance(creId, amount);
-	//will be set during initialization
-	guard->putStack(SlotID(0), hlp);
+	CGCreature * guard;
+	{
+		boost::unique_lock<boost::mutex> lock(gen->objectsMx);
+		guard = (CGCreature *) guardFactory->create(ObjectTemplate());
+		guard->character = CGCreature::HOSTILE;
+		auto  hlp = new CStackInstance(creId, amount);
+		//will be set during initialization
+		guard->putStack(SlotID(0), hlp);
+	}
 
 	//logGlobal->traceStream() << boost::format ("Adding stack of %d %s. Map monster strenght %d, zone monster strength %d, base monster value %d")
 	//	% amount % VLC->creh->creatures[creId]->namePl % mapMonsterStrength % zoneMonsterStrength % strength;
@@ -1094,7 +995,7 @@ bool CRmgTemplateZone::createTreasurePile(CMapGenerator* gen, int3 &pos, float m
 	int maxValue = treasureInfo.max;
 	int minValue = treasureInfo.min;
 
-	ui32 desiredValue = (gen->rand.nextInt(minValue, maxValue));
+	ui32 desiredValue = (getRand(gen).nextInt(minValue, maxValue));
 
 	int currentValue = 0;
 	CGObjectInstance * object = nullptr;
@@ -1130,7 +1031,10 @@ bool CRmgTemplateZone::createTreasurePile(CMapGenerator* gen, int3 &pos, float m
 		}
 		else
 		{
-			object = oi.generateObject();
+			{
+				boost::unique_lock<boost::mutex> lock(gen->objectsMx);
+				object = oi.generateObject();
+			}
 
 			//remove from possible objects
 			auto oiptr = std::find(possibleObjects.begin(), possibleObjects.end(), oi);
@@ -1309,7 +1213,7 @@ bool CRmgTemplateZone::createTreasurePile(CMapGenerator* gen, int3 &pos, float m
 	else //we did not place eveyrthing successfully
 	{
 		gen->setOccupied(pos, ETileType::BLOCKED); //TODO: refactor stop condition
-		vstd::erase_if_present(possibleTiles, pos);
+		possibleTiles.erase(pos);
 		return false;
 	}
 }
@@ -1344,9 +1248,9 @@ void CRmgTemplateZone::initTownType (CMapGenerator* gen)
 				if(!this->townsAreSameType)
 				{
 					if (townTypes.size())
-						subType = *RandomGeneratorUtil::nextItem(townTypes, gen->rand);
+						subType = *RandomGeneratorUtil::nextItem(townTypes, getRand(gen));
 					else
-						subType = *RandomGeneratorUtil::nextItem(getDefaultTownTypes(), gen->rand); //it is possible to have zone with no towns allowed
+						subType = *RandomGeneratorUtil::nextItem(getDefaultTownTypes(), getRand(gen)); //it is possible to have zone with no towns allowed
 				}
 			}
 
@@ -1455,16 +1359,16 @@ void CRmgTemplateZone::initTownType (CMapGenerator* gen)
 	if (!totalTowns) //if there's no town present, get random faction for dwellings and pandoras
 	{
 		//25% chance for neutral
-		if (gen->rand.nextInt(1, 100) <= 25)
+		if (getRand(gen).nextInt(1, 100) <= 25)
 		{
 			townType = ETownType::NEUTRAL;
 		}
 		else
 		{
 			if (townTypes.size())
-				townType = *RandomGeneratorUtil::nextItem(townTypes, gen->rand);
+				townType = *RandomGeneratorUtil::nextItem(townTypes, getRand(gen));
 			else if (monsterTypes.size())
-				townType = *RandomGeneratorUtil::nextItem(monsterTypes, gen->rand); //this happens in Clash of Dragons in treasure zones, where all towns are banned
+				townType = *RandomGeneratorUtil::nextItem(monsterTypes, getRand(gen)); //this happens in Clash of Dragons in treasure zones, where all towns are banned
 			else //just in any case
 				randomizeTownType(gen);
 		}
@@ -1474,9 +1378,9 @@ void CRmgTemplateZone::initTownType (CMapGenerator* gen)
 void CRmgTemplateZone::randomizeTownType (CMapGenerator* gen)
 {
 	if (townTypes.size())
-		townType = *RandomGeneratorUtil::nextItem(townTypes, gen->rand);
+		townType = *RandomGeneratorUtil::nextItem(townTypes, getRand(gen));
 	else
-		townType = *RandomGeneratorUtil::nextItem(getDefaultTownTypes(), gen->rand); //it is possible to have zone with no towns allowed, we still need some
+		townType = *RandomGeneratorUtil::nextItem(getDefaultTownTypes(), getRand(gen)); //it is possible to have zone with no towns allowed, we still need some
 }
 
 void CRmgTemplateZone::initTerrainType (CMapGenerator* gen)
@@ -1485,7 +1389,7 @@ void CRmgTemplateZone::initTerrainType (CMapGenerator* gen)
 	if (matchTerrainToTown && townType != ETownType::NEUTRAL)
 		terrainType = VLC->townh->factions[townType]->nativeTerrain;
 	else
-		terrainType = *RandomGeneratorUtil::nextItem(terrainTypes, gen->rand);
+		terrainType = *RandomGeneratorUtil::nextItem(terrainTypes, getRand(gen));
 
 	//TODO: allow new types of terrain?
 	if (pos.z)
@@ -1506,7 +1410,7 @@ void CRmgTemplateZone::paintZoneTerrain (CMapGenerator* gen, ETerrainType terrai
 {
 	std::vector<int3> tiles(tileinfo.begin(), tileinfo.end());
 	gen->editManager->getTerrainSelection().setSelection(tiles);
-	gen->editManager->drawTerrain(terrainType, &gen->rand);
+	gen->editManager->drawTerrain(terrainType, &getRand(gen));
 }
 
 bool CRmgTemplateZone::placeMines (CMapGenerator* gen)
@@ -1722,7 +1626,7 @@ void CRmgTemplateZone::createTreasures(CMapGenerator* gen)
 		bool stop = false;
 		do {
 			//optimization - don't check tiles which are not allowed
-			vstd::erase_if(possibleTiles, [gen](const int3 &tile) -> bool
+			possibleTiles.eraseIf([gen](const int3 &tile) -> bool
 			{
 				return !gen->isPossible(tile);
 			});
@@ -1759,7 +1663,7 @@ void CRmgTemplateZone::createObstacles1(CMapGenerator * gen)
 			}
 		}
 		gen->editManager->getTerrainSelection().setSelection(accessibleTiles);
-		gen->editManager->drawTerrain(terrainType, &gen->rand);
+		gen->editManager->drawTerrain(terrainType, &getRand(gen));
 	}
 }
 
@@ -1803,7 +1707,7 @@ void CRmgTemplateZone::createObstacles2(CMapGenerator* gen)
 
 	auto tryToPlaceObstacleHere = [this, gen, &possibleObstacles](int3& tile, int index)-> bool
 	{
-		auto temp = *RandomGeneratorUtil::nextItem(possibleObstacles[index].second, gen->rand);
+		auto temp = *RandomGeneratorUtil::nextItem(possibleObstacles[index].second, getRand(gen));
 		int3 obstaclePos = tile + temp.getBlockMapOffset();
 		if (canObstacleBePlacedHere(gen, temp, obstaclePos)) //can be placed here
 		{
@@ -1818,7 +1722,7 @@ void CRmgTemplateZone::createObstacles2(CMapGenerator* gen)
 	for (auto tile : boost::adaptors::reverse(tileinfo))
 	{
 		//fill tiles that should be blocked with obstacles or are just possible (with some probability)
-		if (gen->shouldBeBlocked(tile) || (gen->isPossible(tile) && gen->rand.nextInt(1,100) < 60))
+		if (gen->shouldBeBlocked(tile) || (gen->isPossible(tile) && getRand(gen).nextInt(1,100) < 60))
 		{
 			//start from biggets obstacles
 			for (int i = 0; i < possibleObstacles.size(); i++)
@@ -1842,8 +1746,8 @@ void CRmgTemplateZone::connectRoads(CMapGenerator* gen)
 {
 	logGlobal->debug("Started building roads");
 
-	std::set<int3> roadNodesCopy(roadNodes);
-	std::set<int3> processed;
+	CTileSet roadNodesCopy(roadNodes);
+	CTileSet processed;
 
 	while(!roadNodesCopy.empty())
 	{
@@ -1868,7 +1772,7 @@ void CRmgTemplateZone::connectRoads(CMapGenerator* gen)
 		if (createRoad(gen, node, cross))
 		{
 			processed.insert(cross); //don't draw road starting at end point which is already connected
-			vstd::erase_if_present(roadNodesCopy, cross);
+			roadNodesCopy.erase(cross);
 		}
 
 		processed.insert(node);
@@ -1894,14 +1798,12 @@ void CRmgTemplateZone::drawRoads(CMapGenerator* gen)
 	}
 
 	gen->editManager->getTerrainSelection().setSelection(tiles);
-	gen->editManager->drawRoad(ERoadType::COBBLESTONE_ROAD, &gen->rand);
+	gen->editManager->drawRoad(ERoadType::COBBLESTONE_ROAD, &getRand(gen));
 }
 
 
 bool CRmgTemplateZone::fill(CMapGenerator* gen)
 {
-	initTerrainType(gen);
-
 	//zone center should be always clear to allow other tiles to connect
 	gen->setOccupied(this->getPos(), ETileType::FREE);
 	freePaths.insert(pos);
@@ -1918,36 +1820,131 @@ bool CRmgTemplateZone::fill(CMapGenerator* gen)
 	return true;
 }
 
-bool CRmgTemplateZone::findPlaceForTreasurePile(CMapGenerator* gen, float min_dist, int3 &pos, int value)
+void CRmgTemplateZone::startParallelFill(CMapGenerator* gen, int seed, const std::vector<ui32> & prisonHeroes, int prisonCount, const std::vector<ArtifactID> & questArts)
 {
-	float best_distance = 0;
-	bool result = false;
+	parallelFill.reset(new ParallelFillState());
+	parallelFill->rand.setSeed(seed);
+	parallelFill->gridSearch = make_unique<CGridSearch>(gen->map.get());
+	parallelFill->prisonHeroes = prisonHeroes;
+	parallelFill->prisonsRemaining = prisonCount;
+	parallelFill->questArts = questArts;
+}
+
+void CRmgTemplateZone::passQuestArts()
+{
+	for (auto & info : parallelFill->questArtInfos)
+		questArtZone->possibleObjects.push_back(info);
+	parallelFill->questArtInfos.clear();
+}
+
+void CRmgTemplateZone::finishParallelFill(CMapGenerator* gen)
+{
+	for (auto & object : parallelFill->objects)
+		gen->editManager->insertObject(object.first, object.second);
+	for (auto hid : parallelFill->usedHeroes)
+	{
+		gen->map->allowedHeroes[hid] = false;
+		gen->decreasePrisonsRemaining();
+	}
+	for (auto artid : parallelFill->usedQuestArts)
+		gen->banQuestArt(artid);
+
+	parallelFill.reset();
+}
+
+void CRmgTemplateZone::abortParallelFill()
+{
+	parallelFill.reset();
+}
+
+CRandomGenerator & CRmgTemplateZone::getRand(CMapGenerator* gen)
+{
+	return parallelFill ? parallelFill->rand : gen->rand;
+}
+
+CGridSearch & CRmgTemplateZone::getGridSearch(CMapGenerator* gen)
+{
+	return parallelFill ? *parallelFill->gridSearch : gen->getGridSearch();
+}
+
+bool CRmgTemplateZone::canUseTile(CMapGenerator* gen, const int3 & tile) const
+{
+	//tiles of other zones are changed by their own fill at the same time, zone ids are not changed during fill
+	return !parallelFill || gen->getZoneID(tile) == id;
+}
+
+int CRmgTemplateZone::getPrisonsRemaining(CMapGenerator* gen) const
+{
+	return parallelFill ? parallelFill->prisonsRemaining : gen->getPrisonsRemaning();
+}
+
+ui32 CRmgTemplateZone::takePrisonHero(CMapGenerator* gen)
+{
+	if (parallelFill)
+	{
+		auto hid = *RandomGeneratorUtil::nextItem(parallelFill->prisonHeroes, parallelFill->rand);
+		vstd::erase_if_present(parallelFill->prisonHeroes, hid);
+		parallelFill->usedHeroes.push_back(hid);
+		parallelFill->prisonsRemaining = std::max(0, parallelFill->prisonsRemaining - 1);
+		return hid;
+	}
+
+	std::vector<ui32> possibleHeroes;
+	for (int j = 0; j < gen->map->allowedHeroes.size(); j++)
+	{
+		if (gen->map->allowedHeroes[j])
+			possibleHeroes.push_back(j);
+	}
+
+	auto hid = *RandomGeneratorUtil::nextItem(possibleHeroes, gen->rand);
+	gen->map->allowedHeroes[hid] = false; //ban this hero
+	gen->decreasePrisonsRemaining();
+	return hid;
+}
+
+std::vector<ArtifactID> CRmgTemplateZone::getQuestArtsRemaining(CMapGenerator* gen) const
+{
+	return parallelFill ? parallelFill->questArts : gen->getQuestArtsRemaning();
+}
+
+void CRmgTemplateZone::banQuestArt(CMapGenerator* gen, ArtifactID id)
+{
+	if (parallelFill)
+	{
+		vstd::erase_if_present(parallelFill->questArts, id);
+		parallelFill->usedQuestArts.push_back(id);
+	}
+	else
+		gen->banQuestArt(id);
+}
 
+void CRmgTemplateZone::addQuestArtInfo(const ObjectInfo & info)
+{
+	if (parallelFill)
+		parallelFill->questArtInfos.push_back(info);
+	else
+		questArtZone->possibleObjects.push_back(info);
+}
+
+bool CRmgTemplateZone::findPlaceForTreasurePile(CMapGenerator* gen, float min_dist, int3 &pos, int value)
+{
 	bool needsGuard = value > minGuardedValue;
 
 	//logGlobal->infoStream() << boost::format("Min dist for density %f is %d") % density % min_dist;
-	for(auto tile : possibleTiles)
+	auto isSuitable = [gen, needsGuard](const int3 & tile) -> bool
 	{
-		auto dist = gen->getNearestObjectDistance(tile);
-
-		if ((dist >= min_dist) && (dist > best_distance))
+		bool allTilesAvailable = true;
+		gen->foreach_neighbour (tile, [&gen, &allTilesAvailable, needsGuard](int3 neighbour)
 		{
-			bool allTilesAvailable = true;
-			gen->foreach_neighbour (tile, [&gen, &allTilesAvailable, needsGuard](int3 neighbour)
-			{
-				if (!(gen->isPossible(neighbour) || gen->shouldBeBlocked(neighbour) || (!needsGuard && gen->isFree(neighbour))))
-				{
-					allTilesAvailable = false; //all present tiles must be already blocked or ready for new objects
-				}
-			});
-			if (allTilesAvailable)
+			if (!(gen->isPossible(neighbour) || gen->shouldBeBlocked(neighbour) || (!needsGuard && gen->isFree(neighbour))))
 			{
-				best_distance = dist;
-				pos = tile;
-				result = true;
+				allTilesAvailable = false; //all present tiles must be already blocked or ready for new objects
 			}
-		}
-	}
+		});
+		return allTilesAvailable;
+	};
+
+	bool result = distanceIndex.findFarthest(possibleTiles, min_dist, isSuitable, pos);
 	if (result)
 	{
 		gen->setOccupied(pos, ETileType::BLOCKED); //block that tile //FIXME: why?
@@ -1965,7 +1962,7 @@ bool CRmgTemplateZone::canObstacleBePlacedHere(CMapGenerator* gen, ObjectTemplat
 	for (auto blockingTile : tilesBlockedByObject)
 	{
 		int3 t = pos + blockingTile;
-		if (!gen->map->isInTheMap(t) || !(gen->isPossible(t) || gen->shouldBeBlocked(t)))
+		if (!gen->map->isInTheMap(t) || !canUseTile(gen, t) || !(gen->isPossible(t) || gen->shouldBeBlocked(t)))
 		{
 			return false; //if at least one tile is not possible, object can't be placed here
 		}
@@ -1993,7 +1990,7 @@ int3 CRmgTemplateZone::getAccessibleOffset(CMapGenerator* gen, ObjectTemplate &a
 				if (!vstd::contains(tilesBlockedByObject, offset))
 				{
 					int3 nearbyPos = tile + offset;
-					if (gen->map->isInTheMap(nearbyPos))
+					if (gen->map->isInTheMap(nearbyPos) && canUseTile(gen, nearbyPos))
 					{
 						if (appearance.isVisitableFrom(x, y) && !gen->isBlocked(nearbyPos))
 							ret = nearbyPos;
@@ -2022,7 +2019,7 @@ bool CRmgTemplateZone::areAllTilesAvailable(CMapGenerator* gen, CGObjectInstance
 	for (auto blockingTile : tilesBlockedByObject)
 	{
 		int3 t = tile + blockingTile;
-		if (!gen->map->isInTheMap(t) || !gen->isPossible(t))
+		if (!gen->map->isInTheMap(t) || !canUseTile(gen, t) || !gen->isPossible(t))
 		{
 			//if at least one tile is not possible, object can't be placed here
 			return false;
@@ -2036,30 +2033,17 @@ bool CRmgTemplateZone::findPlaceForObject(CMapGenerator* gen, CGObjectInstance*
 	//we need object apperance to deduce free tile
 	setTemplateForObject(gen, obj);
 
-	int best_distance = 0;
-	bool result = false;
-
 	auto tilesBlockedByObject = obj->getBlockedOffsets();
 
-	for (auto tile : tileinfo)
+	//all possible tiles of zone are indexed
+	auto isSuitable = [this, gen, obj, &tilesBlockedByObject](const int3 & tile) -> bool
 	{
+		int3 t = tile;
 		//object must be accessible from at least one surounding tile
-		if (!isAccessibleFromAnywhere(gen, obj->appearance, tile))
-			continue;
+		return gen->isPossible(tile) && isAccessibleFromAnywhere(gen, obj->appearance, t) && areAllTilesAvailable(gen, obj, t, tilesBlockedByObject);
+	};
 
-		auto ti = gen->getTile(tile);
-		auto dist = ti.getNearestObjectDistance();
-		//avoid borders
-		if (gen->isPossible(tile) && (dist >= min_dist) && (dist > best_distance))
-		{
-			if (areAllTilesAvailable(gen, obj, tile, tilesBlockedByObject))
-			{
-				best_distance = dist;
-				pos = tile;
-				result = true;
-			}
-		}
-	}
+	bool result = distanceIndex.findFarthest(possibleTiles, min_dist, isSuitable, pos);
 	if (result)
 	{
 		gen->setOccupied(pos, ETileType::BLOCKED); //block that tile
@@ -2091,7 +2075,10 @@ void CRmgTemplateZone::checkAndPlaceObject(CMapGenerator* gen, CGObjectInstance*
 		object->appearance = templates.front();
 	}
 
-	gen->editManager->insertObject(object, pos);
+	if (parallelFill)
+		parallelFill->objects.push_back(std::make_pair(object, pos));
+	else
+		gen->editManager->insertObject(object, pos);
 	//logGlobal->traceStream() << boost::format ("Successfully inserted object (%d,%d) at pos %s") %object->ID %object->subID %pos();
 }
 
@@ -2107,19 +2094,13 @@ void CRmgTemplateZone::placeObject(CMapGenerator* gen, CGObjectInstance* object,
 	points.insert(pos);
 	for(auto p : points)
 	{
-		if (gen->map->isInTheMap(p))
+		if (gen->map->isInTheMap(p) && canUseTile(gen, p))
 		{
 			gen->setOccupied(p, ETileType::USED);
 		}
 	}
 	if (updateDistance)
-	{
-		for(auto tile : possibleTiles) //don't need to mark distance for not possible tiles
-		{
-			si32 d = pos.dist2dSQ(tile); //optimization, only relative distance is interesting
-			gen->setNearestObjectDistance(tile, std::min<float>(d, gen->getNearestObjectDistance(tile)));
-		}
-	}
+		distanceIndex.addObject(gen, possibleTiles, pos); //don't need to mark distance for not possible tiles
 
 	switch (object->ID)
 	{
@@ -2364,7 +2345,7 @@ ObjectInfo CRmgTemplateZone::getRandomObject(CMapGenerator* gen, CTreasurePileIn
 	}
 	else
 	{
-		int r = gen->rand.nextInt (1, total);
+		int r = getRand(gen).nextInt (1, total);
 
 		//binary search = fastest
 		auto it = std::lower_bound(thresholds.begin(), thresholds.end(), r,
@@ -2431,14 +2412,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 	{
 		oi.generateObject = [i, gen, this]() -> CGObjectInstance *
 		{
-			std::vector<ui32> possibleHeroes;
-			for (int j = 0; j < gen->map->allowedHeroes.size(); j++)
-			{
-				if (gen->map->allowedHeroes[j])
-					possibleHeroes.push_back(j);
-			}
-
-			auto hid = *RandomGeneratorUtil::nextItem(possibleHeroes, gen->rand);
+			auto hid = takePrisonHero(gen);
 			auto factory = VLC->objtypeh->getHandlerFor(Obj::PRISON, 0);
 			auto obj = (CGHeroInstance *) factory->create(ObjectTemplate());
 
@@ -2446,8 +2420,6 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 			obj->subID = hid; //will be initialized later
 			obj->exp = prisonExp[i];
 			obj->setOwner(PlayerColor::NEUTRAL);
-			gen->map->allowedHeroes[hid] = false; //ban this hero
-			gen->decreasePrisonsRemaining();
 			obj->appearance = VLC->objtypeh->getHandlerFor(Obj::PRISON, 0)->getTemplates(terrainType).front(); //can't init template with hero subID
 
 			return obj;
@@ -2455,7 +2427,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 		oi.setTemplate(Obj::PRISON, 0, terrainType);
 		oi.value = prisonValues[i];
 		oi.probability = 30;
-		oi.maxPerZone = gen->getPrisonsRemaning() / 5; //probably not perfect, but we can't generate more prisons than hereos.
+		oi.maxPerZone = getPrisonsRemaining(gen) / 5; //probably not perfect, but we can't generate more prisons than hereos.
 		possibleObjects.push_back(oi);
 	}
 
@@ -2492,7 +2464,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 					oi.generateObject = [gen, temp, secondaryID, dwellingHandler]() -> CGObjectInstance *
 					{
 						auto obj = VLC->objtypeh->getHandlerFor(Obj::CREATURE_GENERATOR1, secondaryID)->create(temp);
-						//dwellingHandler->configureObject(obj, gen->rand);
+						//dwellingHandler->configureObject(obj, getRand(gen));
 						obj->tempOwner = PlayerColor::NEUTRAL;
 						return obj;
 					};
@@ -2508,7 +2480,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 
 	for (int i = 0; i < 5; i++)
 	{
-		oi.generateObject = [i, gen]() -> CGObjectInstance *
+		oi.generateObject = [i, gen, this]() -> CGObjectInstance *
 		{
 			auto factory = VLC->objtypeh->getHandlerFor(Obj::SPELL_SCROLL, 0);
 			auto obj = (CGArtifact *) factory->create(ObjectTemplate());
@@ -2521,7 +2493,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 					out.push_back(spell->id);
 				}
 			}
-			auto a = CArtifactInstance::createScroll(RandomGeneratorUtil::nextItem(out, gen->rand)->toSpell());
+			auto a = CArtifactInstance::createScroll(RandomGeneratorUtil::nextItem(out, getRand(gen))->toSpell());
 			obj->storedArtifact = a;
 			return obj;
 		};
@@ -2614,7 +2586,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 	//Pandora with 12 spells of certain level
 	for (int i = 1; i <= GameConstants::SPELL_LEVELS; i++)
 	{
-		oi.generateObject = [i, gen]() -> CGObjectInstance *
+		oi.generateObject = [i, gen, this]() -> CGObjectInstance *
 		{
 			auto factory = VLC->objtypeh->getHandlerFor(Obj::PANDORAS_BOX, 0);
 			auto obj = (CGPandoraBox *) factory->create(ObjectTemplate());
@@ -2626,7 +2598,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 					spells.push_back(spell);
 			}
 
-			RandomGeneratorUtil::randomShuffle(spells, gen->rand);
+			RandomGeneratorUtil::randomShuffle(spells, getRand(gen));
 			for (int j = 0; j < std::min<int>(12, spells.size()); j++)
 			{
 				obj->spells.push_back(spells[j]->id);
@@ -2643,7 +2615,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 	//Pandora with 15 spells of certain school
 	for (int i = 0; i < 4; i++)
 	{
-		oi.generateObject = [i,gen]() -> CGObjectInstance *
+		oi.generateObject = [i, gen, this]() -> CGObjectInstance *
 		{
 			auto factory = VLC->objtypeh->getHandlerFor(Obj::PANDORAS_BOX, 0);
 			auto obj = (CGPandoraBox *) factory->create(ObjectTemplate());
@@ -2656,7 +2628,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 					spells.push_back(spell);
 			}
 
-			RandomGeneratorUtil::randomShuffle(spells, gen->rand);
+			RandomGeneratorUtil::randomShuffle(spells, getRand(gen));
 			for (int j = 0; j < std::min<int>(15, spells.size()); j++)
 			{
 				obj->spells.push_back(spells[j]->id);
@@ -2672,7 +2644,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 
 	// Pandora box with 60 random spells
 
-	oi.generateObject = [gen]() -> CGObjectInstance *
+	oi.generateObject = [gen, this]() -> CGObjectInstance *
 	{
 		auto factory = VLC->objtypeh->getHandlerFor(Obj::PANDORAS_BOX, 0);
 		auto obj = (CGPandoraBox *) factory->create(ObjectTemplate());
@@ -2684,7 +2656,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 				spells.push_back(spell);
 		}
 
-		RandomGeneratorUtil::randomShuffle(spells, gen->rand);
+		RandomGeneratorUtil::randomShuffle(spells, getRand(gen));
 		for (int j = 0; j < std::min<int>(60, spells.size()); j++)
 		{
 			obj->spells.push_back(spells[j]->id);
@@ -2703,7 +2675,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 	{
 		static const int genericSeerHuts = 8;
 		int seerHutsPerType = 0;
-		const int questArtsRemaining = gen->getQuestArtsRemaning().size();
+		const int questArtsRemaining = getQuestArtsRemaining(gen).size();
 
 		//general issue is that not many artifact types are available for quests
 
@@ -2717,7 +2689,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 		}
 		oi.maxPerZone = seerHutsPerType;
 
-		RandomGeneratorUtil::randomShuffle(creatures, gen->rand);
+		RandomGeneratorUtil::randomShuffle(creatures, getRand(gen));
 
 		auto generateArtInfo = [this](ArtifactID id) -> ObjectInfo
 		{
@@ -2742,7 +2714,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 			if (!creaturesAmount)
 				continue;
 
-			int randomAppearance = *RandomGeneratorUtil::nextItem(VLC->objtypeh->knownSubObjects(Obj::SEER_HUT), gen->rand);
+			int randomAppearance = *RandomGeneratorUtil::nextItem(VLC->objtypeh->knownSubObjects(Obj::SEER_HUT), getRand(gen));
 
 			oi.generateObject = [creature, creaturesAmount, randomAppearance, gen, this, generateArtInfo]() -> CGObjectInstance *
 			{
@@ -2753,14 +2725,14 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 				obj->rVal = creaturesAmount;
 
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(gen->getQuestArtsRemaning(), gen->rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(getQuestArtsRemaining(gen), getRand(gen));
 				obj->quest->m5arts.push_back(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
 
-				gen->banQuestArt(artid);
+				banQuestArt(gen, artid);
 
-				this->questArtZone->possibleObjects.push_back (generateArtInfo(artid));
+				addQuestArtInfo(generateArtInfo(artid));
 
 				return obj;
 			};
@@ -2775,7 +2747,7 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 
 		for (int i = 0; i < 4; i++) //seems that code for exp and gold reward is similiar
 		{
-			int randomAppearance = *RandomGeneratorUtil::nextItem(VLC->objtypeh->knownSubObjects(Obj::SEER_HUT), gen->rand);
+			int randomAppearance = *RandomGeneratorUtil::nextItem(VLC->objtypeh->knownSubObjects(Obj::SEER_HUT), getRand(gen));
 
 			oi.setTemplate(Obj::SEER_HUT, randomAppearance, terrainType);
 			oi.value = seerValues[i];
@@ -2791,14 +2763,14 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 				obj->rVal = seerExpGold[i];
 
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(gen->getQuestArtsRemaning(), gen->rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(getQuestArtsRemaining(gen), getRand(gen));
 				obj->quest->m5arts.push_back(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
 
-				gen->banQuestArt(artid);
+				banQuestArt(gen, artid);
 
-				this->questArtZone->possibleObjects.push_back(generateArtInfo(artid));
+				addQuestArtInfo(generateArtInfo(artid));
 
 				return obj;
 			};
@@ -2814,14 +2786,14 @@ void CRmgTemplateZone::addAllPossibleObjects(CMapGenerator* gen)
 				obj->rVal = seerExpGold[i];
 
 				obj->quest->missionType = CQuest::MISSION_ART;
-				ArtifactID artid = *RandomGeneratorUtil::nextItem(gen->getQuestArtsRemaning(), gen->rand);
+				ArtifactID artid = *RandomGeneratorUtil::nextItem(getQuestArtsRemaining(gen), getRand(gen));
 				obj->quest->m5arts.push_back(artid);
 				obj->quest->lastDay = -1;
 				obj->quest->isCustomFirst = obj->quest->isCustomNext = obj->quest->isCustomComplete = false;
 
-				gen->banQuestArt(artid);
+				banQuestArt(gen, artid);
 
-				this->questArtZone->possibleObjects.push_back(generateArtInfo(artid));
+				addQuestArtInfo(generateArtInfo(artid));
 
 				return obj;
 			};
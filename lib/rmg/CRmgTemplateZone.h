@@ -14,6 +14,8 @@
 #include "../GameConstants.h"
 #include "CMapGenerator.h"
 #include "float3.h"
+#include "CTileSet.h"
+#include "CTileDistanceIndex.h"
 #include "../int3.h"
 #include "../ResourceSet.h" //for TResource (?)
 #include "../mapObjects/ObjectTemplate.h"
@@ -24,6 +26,7 @@ class int3;
 class CGObjectInstance;
 class ObjectTemplate;
 class CRmgTemplateZoneConnection;
+class CGridSearch;
 
 namespace ETemplateZoneType
 {
@@ -162,8 +165,8 @@ public:
 
 	void addTile (const int3 &pos);
 	void initFreeTiles (CMapGenerator* gen);
-	std::set<int3> getTileInfo() const;
-	std::set<int3> getPossibleTiles() const;
+	const CTileSet & getTileInfo() const;
+	const CTileSet & getPossibleTiles() const;
 	void discardDistantTiles (CMapGenerator* gen, float distance);
 	void clearTiles();
 
@@ -186,7 +189,7 @@ public:
 	void createTreasures(CMapGenerator* gen);
 	void createObstacles1(CMapGenerator* gen);
 	void createObstacles2(CMapGenerator* gen);
-	bool crunchPath(CMapGenerator* gen, const int3 &src, const int3 &dst, bool onlyStraight, std::set<int3>* clearedTiles = nullptr);
+	bool crunchPath(CMapGenerator* gen, const int3 &src, const int3 &dst, bool onlyStraight, CTileSet* clearedTiles = nullptr);
 	bool connectPath(CMapGenerator* gen, const int3& src, bool onlyStraight);
 	bool connectWithCenter(CMapGenerator* gen, const int3& src, bool onlyStraight);
 
@@ -195,10 +198,11 @@ public:
 
 	void addConnection(TRmgTemplateZoneId otherZone);
 	void setQuestArtZone(CRmgTemplateZone * otherZone);
+	CRmgTemplateZone * getQuestArtZone() const;
 	std::vector<TRmgTemplateZoneId> getConnections() const;
 	void addTreasureInfo(CTreasureInfo & info);
 	std::vector<CTreasureInfo> getTreasureInfo();
-	std::set<int3>* getFreePaths();
+	CTileSet* getFreePaths();
 
 	ObjectInfo getRandomObject (CMapGenerator* gen, CTreasurePileInfo &info, ui32 desiredValue, ui32 maxValue, ui32 currentValue);
 
@@ -209,6 +213,16 @@ public:
 	void addRoadNode(const int3 & node);
 	void connectRoads(CMapGenerator * gen); //fills "roads" according to "roadNodes"
 
+	/// Prepares zone to be filled in parallel with other zones. Zone gets own random generator and path search,
+	/// and takes prison heroes and seer hut artifacts only from the given ones. Placed objects are kept aside until finishParallelFill.
+	void startParallelFill(CMapGenerator* gen, int seed, const std::vector<ui32> & prisonHeroes, int prisonCount, const std::vector<ArtifactID> & questArts);
+	/// adds artifacts required by seer huts of this zone to its quest art zone, which has to be filled later
+	void passQuestArts();
+	/// inserts placed objects into map and bans used heroes and artifacts, zones should be finished in order of their ids
+	void finishParallelFill(CMapGenerator* gen);
+	/// drops parallel fill state after failed generation
+	void abortParallelFill();
+
 private:
 	//template info
 	TRmgTemplateZoneId id;
@@ -240,14 +254,43 @@ private:
 	//placement info
 	int3 pos;
 	float3 center;
-	std::set<int3> tileinfo; //irregular area assined to zone
-	std::set<int3> possibleTiles; //optimization purposes for treasure generation
+	CTileSet tileinfo; //irregular area assined to zone
+	CTileSet possibleTiles; //optimization purposes for treasure generation
+	CTileDistanceIndex distanceIndex; //possible tiles by distance to nearest object
 	std::vector<TRmgTemplateZoneId> connections; //list of adjacent zones
-	std::set<int3> freePaths; //core paths of free tiles that all other objects will be linked to
+	CTileSet freePaths; //core paths of free tiles that all other objects will be linked to
+
+	CTileSet roadNodes; //tiles to be connected with roads
+	CTileSet roads; //all tiles with roads
+	CTileSet tilesToConnectLater; //will be connected after paths are fractalized
+
+	struct ParallelFillState;
+	/// Owns parallel fill state. It belongs to single generation, so copy of zone starts without it.
+	class ParallelFillHolder
+	{
+	public:
+		ParallelFillHolder();
+		ParallelFillHolder(const ParallelFillHolder & other);
+		ParallelFillHolder & operator=(const ParallelFillHolder & other);
+		~ParallelFillHolder(); //state is complete type only in cpp
+
+		void reset(ParallelFillState * value = nullptr);
+		ParallelFillState * operator->() const { return state.get(); }
+		explicit operator bool() const { return state != nullptr; }
 
-	std::set<int3> roadNodes; //tiles to be connected with roads
-	std::set<int3> roads; //all tiles with roads
-	std::set<int3> tilesToConnectLater; //will be connected after paths are fractalized
+	private:
+		std::unique_ptr<ParallelFillState> state;
+	};
+	ParallelFillHolder parallelFill; //empty unless zone is filled in parallel with other zones
+
+	CRandomGenerator & getRand(CMapGenerator* gen);
+	CGridSearch & getGridSearch(CMapGenerator* gen);
+	bool canUseTile(CMapGenerator* gen, const int3 & tile) const; //false for tiles of other zones while zones are filled in parallel
+	int getPrisonsRemaining(CMapGenerator* gen) const;
+	ui32 takePrisonHero(CMapGenerator* gen); //chooses random hero for prison and bans him
+	std::vector<ArtifactID> getQuestArtsRemaining(CMapGenerator* gen) const;
+	void banQuestArt(CMapGenerator* gen, ArtifactID id);
+	void addQuestArtInfo(const ObjectInfo & info); //artifact to be placed in quest art zone
 
 	bool createRoad(CMapGenerator* gen, const int3 &src, const int3 &dst);
 	void drawRoads(CMapGenerator * gen); //actually updates tiles
@@ -0,0 +1,100 @@
+/*
+ * CTileDistanceIndex.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#include "StdInc.h"
+#include "CTileDistanceIndex.h"
+
+#include "CMapGenerator.h"
+#include "../mapping/CMap.h"
+
+void CTileDistanceIndex::reset(const CMapGenerator * gen, const CTileSet & tiles)
+{
+	buckets.clear();
+	for (auto tile : tiles)
+		buckets[gen->getNearestObjectDistance(tile)].insert(tile);
+}
+
+void CTileDistanceIndex::move(const int3 & tile, float from, float to)
+{
+	auto bucket = buckets.find(from);
+	if (bucket != buckets.end())
+	{
+		bucket->second.erase(tile);
+		if (bucket->second.empty())
+			buckets.erase(bucket);
+	}
+	buckets[to].insert(tile);
+}
+
+void CTileDistanceIndex::addObject(CMapGenerator * gen, const CTileSet & tiles, const int3 & pos)
+{
+	if (buckets.empty())
+		return;
+
+	auto update = [this, gen, &pos](int3 tile)
+	{
+		si32 d = pos.dist2dSQ(tile); //optimization, only relative distance is interesting
+		const float oldDistance = gen->getNearestObjectDistance(tile);
+		if (d < oldDistance)
+		{
+			gen->setNearestObjectDistance(tile, d);
+			move(tile, oldDistance, d);
+		}
+	};
+
+	//tile farther from pos than farthest indexed tile is from its nearest object won't get any closer
+	const si64 radius = static_cast<si64>(std::sqrt(buckets.begin()->first)) + 1;
+	const int levels = gen->map->twoLevel ? 2 : 1; //distance ignores level
+	const si64 area = (2 * radius + 1) * (2 * radius + 1) * levels;
+	if (area >= static_cast<si64>(tiles.size())) //e.g. before first object is placed, all tiles are affected
+	{
+		for (auto tile : tiles)
+			update(tile);
+		return;
+	}
+
+	const si32 r = radius;
+	for (int z = 0; z < levels; z++)
+	{
+		for (si32 y = pos.y - r; y <= pos.y + r; y++)
+		{
+			for (si32 x = pos.x - r; x <= pos.x + r; x++)
+			{
+				const int3 tile(x, y, z);
+				if (tiles.contains(tile))
+					update(tile);
+			}
+		}
+	}
+}
+
+bool CTileDistanceIndex::findFarthest(const CTileSet & tiles, float minDistance, const TPredicate & isSuitable, int3 & result)
+{
+	for (auto bucket = buckets.begin(); bucket != buckets.end() && bucket->first >= minDistance;)
+	{
+		auto & bucketTiles = bucket->second;
+		for (auto tile : bucketTiles) //erasing tile doesn't invalidate iterator
+		{
+			if (!tiles.contains(tile))
+				bucketTiles.erase(tile);
+			else if (isSuitable(tile))
+			{
+				result = tile;
+				return true;
+			}
+		}
+
+		if (bucketTiles.empty())
+			bucket = buckets.erase(bucket);
+		else
+			++bucket;
+	}
+	return false;
+}
@@ -0,0 +1,45 @@
+/*
+ * CTileDistanceIndex.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#pragma once
+
+#include "CTileSet.h"
+
+class CMapGenerator;
+
+/// Tiles of zone kept in buckets by (squared) distance to nearest object, as stored in map generator.
+/// Farthest suitable tile is found without checking every tile, and placing object updates
+/// only tiles that are close enough to it to get any closer.
+class CTileDistanceIndex
+{
+public:
+	/// returns true if tile can be chosen
+	typedef std::function<bool(const int3 & tile)> TPredicate;
+
+	/// starts over with given tiles at their current distances
+	void reset(const CMapGenerator * gen, const CTileSet & tiles);
+
+	/// lowers distance of tiles (which have to be indexed) to object placed at pos, in map generator as well as in index
+	void addObject(CMapGenerator * gen, const CTileSet & tiles, const int3 & pos);
+
+	/**
+	 * Finds tile of given set with greatest distance that is at least minDistance (which should be positive),
+	 * ties are broken by tile order (int3::operator<), same as if all tiles were checked in order.
+	 * Indexed tiles which were removed from the set are dropped from index.
+	 *
+	 * @return true if tile was found
+	 */
+	bool findFarthest(const CTileSet & tiles, float minDistance, const TPredicate & isSuitable, int3 & result);
+
+private:
+	std::map<float, CTileSet, std::greater<float>> buckets; //farthest tiles first
+
+	void move(const int3 & tile, float from, float to);
+};
@@ -0,0 +1,234 @@
+/*
+ * CTileSet.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#include "StdInc.h"
+#include "CTileSet.h"
+
+CTileSet::const_iterator::const_iterator() :
+	set(nullptr),
+	index(0)
+{
+}
+
+CTileSet::const_iterator::const_iterator(const CTileSet * set, size_t index) :
+	set(set),
+	index(index)
+{
+}
+
+int3 CTileSet::const_iterator::dereference() const
+{
+	return set->tileAt(index);
+}
+
+bool CTileSet::const_iterator::equal(const const_iterator & other) const
+{
+	return index == other.index;
+}
+
+void CTileSet::const_iterator::increment()
+{
+	index = set->findNext(index + 1);
+}
+
+void CTileSet::const_iterator::decrement()
+{
+	index = set->findPrevious(index);
+}
+
+CTileSet::CTileSet() :
+	origin(0, 0, 0),
+	extent(0, 0, 0),
+	count(0)
+{
+}
+
+size_t CTileSet::bitCount() const
+{
+	return extent.x * extent.y * extent.z;
+}
+
+bool CTileSet::getIndex(const int3 & tile, size_t & index) const
+{
+	const int3 local = tile - origin;
+	if(local.x < 0 || local.y < 0 || local.z < 0 || local.x >= extent.x || local.y >= extent.y || local.z >= extent.z)
+		return false;
+
+	//same order as int3::operator<
+	index = (local.z * extent.y + local.y) * extent.x + local.x;
+	return true;
+}
+
+int3 CTileSet::tileAt(size_t index) const
+{
+	return origin + int3(index % extent.x, (index / extent.x) % extent.y, index / (extent.x * extent.y));
+}
+
+void CTileSet::reset(size_t index)
+{
+	bits[index / 64] &= ~(ui64(1) << (index % 64));
+	count--;
+}
+
+size_t CTileSet::findNext(size_t index) const
+{
+	while(index < bitCount())
+	{
+		ui64 word = bits[index / 64] >> (index % 64);
+		if(word == 0)
+		{
+			index = (index / 64 + 1) * 64;
+			continue;
+		}
+		while(!(word & 1))
+		{
+			word >>= 1;
+			index++;
+		}
+		return index;
+	}
+	return bitCount();
+}
+
+size_t CTileSet::findPrevious(size_t index) const
+{
+	while(index > 0)
+	{
+		size_t last = index - 1;
+		ui64 word = bits[last / 64] << (63 - last % 64); //bit of last tile is now the highest one
+		if(word == 0)
+		{
+			index = last / 64 * 64;
+			continue;
+		}
+		while(!(word >> 63))
+		{
+			word <<= 1;
+			last--;
+		}
+		return last;
+	}
+	return bitCount();
+}
+
+void CTileSet::grow(const int3 & tile)
+{
+	int3 newOrigin, newEnd;
+	if(bitCount() == 0)
+	{
+		newOrigin = tile;
+		newEnd = tile + int3(1, 1, 1);
+	}
+	else
+	{
+		//grow by half of current size at once, as tiles are often added in row by row
+		auto growAxis = [](si32 tilePos, si32 origin, si32 extent, si32 slack, si32 & newOrigin, si32 & newEnd)
+		{
+			newOrigin = origin;
+			newEnd = origin + extent;
+			if(tilePos < newOrigin)
+				newOrigin = std::min(tilePos, origin - slack);
+			if(tilePos >= newEnd)
+				newEnd = std::max(tilePos + 1, origin + extent + slack);
+		};
+		growAxis(tile.x, origin.x, extent.x, extent.x / 2, newOrigin.x, newEnd.x);
+		growAxis(tile.y, origin.y, extent.y, extent.y / 2, newOrigin.y, newEnd.y);
+		growAxis(tile.z, origin.z, extent.z, 0, newOrigin.z, newEnd.z); //there are at most 2 levels
+	}
+
+	CTileSet grown;
+	grown.origin = newOrigin;
+	grown.extent = newEnd - newOrigin;
+	grown.bits.resize((grown.bitCount() + 63) / 64, 0);
+	for(auto tile : *this)
+		grown.insert(tile);
+
+	*this = std::move(grown);
+}
+
+void CTileSet::insert(const int3 & tile)
+{
+	size_t index;
+	if(!getIndex(tile, index))
+	{
+		grow(tile);
+		getIndex(tile, index);
+	}
+
+	ui64 & word = bits[index / 64];
+	const ui64 mask = ui64(1) << (index % 64);
+	if(!(word & mask))
+	{
+		word |= mask;
+		count++;
+	}
+}
+
+void CTileSet::insert(const CTileSet & other)
+{
+	if(other.origin == origin && other.extent == extent)
+	{
+		count = 0;
+		for(size_t i = 0; i < bits.size(); i++)
+		{
+			bits[i] |= other.bits[i];
+			for(ui64 word = bits[i]; word; word &= word - 1)
+				count++;
+		}
+	}
+	else
+	{
+		for(auto tile : other)
+			insert(tile);
+	}
+}
+
+bool CTileSet::erase(const int3 & tile)
+{
+	size_t index;
+	if(!getIndex(tile, index) || !(bits[index / 64] & (ui64(1) << (index % 64))))
+		return false;
+
+	reset(index);
+	return true;
+}
+
+bool CTileSet::contains(const int3 & tile) const
+{
+	size_t index;
+	return getIndex(tile, index) && (bits[index / 64] & (ui64(1) << (index % 64)));
+}
+
+void CTileSet::clear()
+{
+	origin = extent = int3(0, 0, 0);
+	bits.clear();
+	count = 0;
+}
+
+size_t CTileSet::size() const
+{
+	return count;
+}
+
+bool CTileSet::empty() const
+{
+	return count == 0;
+}
+
+CTileSet::const_iterator CTileSet::begin() const
+{
+	return const_iterator(this, findNext(0));
+}
+
+CTileSet::const_iterator CTileSet::end() const
+{
+	return const_iterator(this, bitCount());
+}
@@ -0,0 +1,86 @@
+/*
+ * CTileSet.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#pragma once
+
+#include "../int3.h"
+
+/// Set of map tiles, stored as bitmap over bounding box of its tiles. Box grows when tile outside of it is inserted.
+/// Tiles are iterated in the same order as in std::set<int3>, so random choices made over this set stay the same.
+/// Iterators are invalidated by inserting tile outside of current box, but not by erasing tiles.
+class DLL_LINKAGE CTileSet
+{
+public:
+	typedef int3 value_type;
+
+	class const_iterator : public boost::iterator_facade<const_iterator, const int3, boost::bidirectional_traversal_tag, int3>
+	{
+	public:
+		const_iterator();
+
+	private:
+		friend class boost::iterator_core_access;
+		friend class CTileSet;
+
+		const_iterator(const CTileSet * set, size_t index);
+
+		int3 dereference() const;
+		bool equal(const const_iterator & other) const;
+		void increment();
+		void decrement();
+
+		const CTileSet * set;
+		size_t index;
+	};
+	typedef const_iterator iterator;
+
+	CTileSet();
+
+	void insert(const int3 & tile);
+	void insert(const CTileSet & other);
+	/// returns true if tile was present in set
+	bool erase(const int3 & tile);
+	bool contains(const int3 & tile) const;
+	void clear();
+
+	template<typename Predicate>
+	void eraseIf(Predicate pred)
+	{
+		for(size_t i = findNext(0); i < bitCount(); i = findNext(i + 1))
+		{
+			if(pred(tileAt(i)))
+				reset(i);
+		}
+	}
+
+	size_t size() const;
+	bool empty() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	int3 origin;
+	int3 extent;
+	std::vector<ui64> bits;
+	size_t count;
+
+	size_t bitCount() const;
+	bool getIndex(const int3 & tile, size_t & index) const;
+	int3 tileAt(size_t index) const;
+	void reset(size_t index);
+
+	/// returns index of first tile at or after index, bitCount() if there is none
+	size_t findNext(size_t index) const;
+	/// returns index of last tile before index, bitCount() if there is none
+	size_t findPrevious(size_t index) const;
+
+	void grow(const int3 & tile);
+};
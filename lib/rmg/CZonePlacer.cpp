@@ -479,7 +479,7 @@ void CZonePlacer::assignZones(const CMapGenOptions * mapGenOptions)
 	auto moveZoneToCenterOfMass = [](CRmgTemplateZone * zone) -> void
 	{
 		int3 total(0, 0, 0);
-		auto tiles = zone->getTileInfo();
+		auto & tiles = zone->getTileInfo();
 		for (auto tile : tiles)
 		{
 			total += tile;
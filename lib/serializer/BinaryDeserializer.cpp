@@ -3,6 +3,8 @@
 
 #include "../registerTypes/RegisterTypes.h"
 
+#include <zlib.h>
+
 /*
  * BinaryDeserializer.cpp, part of VCMI engine
  *
@@ -15,8 +17,46 @@
 
 extern template void registerTypes<BinaryDeserializer>(BinaryDeserializer & s);
 
+const CLoadedPointersMap::LoadedPointer * CLoadedPointersMap::find(ui32 pid) const
+{
+	if(pid < dense.size() && dense[pid].ptr)
+		return &dense[pid];
+
+	//vector may have grown over id that was stored as sparse one
+	auto iter = sparse.find(pid);
+	return iter != sparse.end() ? &iter->second : nullptr;
+}
+
+void CLoadedPointersMap::insert(ui32 pid, void * ptr, const std::type_info * type)
+{
+	const LoadedPointer loaded = {ptr, type};
+
+	if(pid < dense.size())
+	{
+		dense[pid] = loaded;
+	}
+	else if(pid - dense.size() <= MAX_DENSE_GAP)
+	{
+		LoadedPointer empty = {nullptr, nullptr};
+		dense.resize(pid + 1, empty);
+		dense[pid] = loaded;
+	}
+	else
+	{
+		sparse[pid] = loaded;
+	}
+}
+
+void CLoadedPointersMap::clear()
+{
+	dense.clear();
+	sparse.clear();
+}
+
+static const int inflateBlockSize = 65536;
+
 CLoadFile::CLoadFile(const boost::filesystem::path & fname, int minimalVersion /*= version*/)
-	: serializer(this)
+	: serializer(this), inflateState(nullptr), compressedRemaining(0)
 {
 	registerTypes(serializer);
 	openNextFile(fname, minimalVersion);
@@ -24,11 +64,40 @@ CLoadFile::CLoadFile(const boost::filesystem::path & fname, int minimalVersion /
 
 CLoadFile::~CLoadFile()
 {
+	clear();
 }
 
 int CLoadFile::read(void * data, unsigned size)
 {
-	sfile->read((char*)data,size);
+	if(!inflateState)
+	{
+		sfile->read((char*)data,size);
+		return size;
+	}
+
+	//only one block of compressed data is kept in memory, so loading huge saves doesn't need much more memory
+	inflateState->next_out = (Bytef *)data;
+	inflateState->avail_out = size;
+	while(inflateState->avail_out)
+	{
+		if(!inflateState->avail_in)
+		{
+			const si64 toRead = std::min<si64>(compressedRemaining, compressedBuffer.size());
+			if(!toRead)
+				THROW_FORMAT("Error: unexpected end of compressed data (%s)!", fName);
+
+			sfile->read((char *)compressedBuffer.data(), toRead);
+			compressedRemaining -= toRead;
+			inflateState->next_in = compressedBuffer.data();
+			inflateState->avail_in = toRead;
+		}
+
+		const int result = inflate(inflateState, Z_NO_FLUSH);
+		if(result == Z_STREAM_END && inflateState->avail_out)
+			THROW_FORMAT("Error: unexpected end of compressed data (%s)!", fName);
+		if(result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+			THROW_FORMAT("Error: cannot decompress %s: %s", fName % (inflateState->msg ? inflateState->msg : "unknown error"));
+	}
 	return size;
 }
 
@@ -39,6 +108,7 @@ void CLoadFile::openNextFile(const boost::filesystem::path & fname, int minimalV
 
 	try
 	{
+		clear();
 		fName = fname.string();
 		sfile = make_unique<FileStream>(fname, std::ios::in | std::ios::binary);
 		sfile->exceptions(std::ifstream::failbit | std::ifstream::badbit); //we throw a lot anyway
@@ -47,9 +117,9 @@ void CLoadFile::openNextFile(const boost::filesystem::path & fname, int minimalV
 			THROW_FORMAT("Error: cannot open to read %s!", fName);
 
 		//we can read
-		char buffer[4];
-		sfile->read(buffer, 4);
-		if(std::memcmp(buffer,"VCMI",4))
+		std::string magic(FILE_MAGIC.length(), '\0');
+		sfile->read(&magic[0], magic.length());
+		if(magic != FILE_MAGIC && magic != COMPRESSED_FILE_MAGIC)
 			THROW_FORMAT("Error: not a VCMI file(%s)!", fName);
 
 		serializer & serializer.fileVersion;
@@ -72,6 +142,27 @@ void CLoadFile::openNextFile(const boost::filesystem::path & fname, int minimalV
 			else
 				THROW_FORMAT("Error: too new file format (%s)!", fName);
 		}
+
+		if(magic == COMPRESSED_FILE_MAGIC)
+		{
+			const auto dataStart = sfile->tellg();
+			sfile->seekg(0, std::ios::end);
+			compressedRemaining = sfile->tellg() - dataStart;
+			sfile->seekg(dataStart);
+
+			compressedBuffer.resize(inflateBlockSize);
+			inflateState = new z_stream;
+			inflateState->zalloc = Z_NULL;
+			inflateState->zfree = Z_NULL;
+			inflateState->opaque = Z_NULL;
+			inflateState->next_in = Z_NULL;
+			inflateState->avail_in = 0;
+			if(inflateInit(inflateState) != Z_OK)
+			{
+				vstd::clear_pointer(inflateState);
+				THROW_FORMAT("Error: cannot initialize decompression for %s!", fName);
+			}
+		}
 	}
 	catch(...)
 	{
@@ -91,6 +182,13 @@ void CLoadFile::reportState(CLogger * out)
 
 void CLoadFile::clear()
 {
+	if(inflateState)
+	{
+		inflateEnd(inflateState);
+		vstd::clear_pointer(inflateState);
+	}
+	compressedBuffer.clear();
+	compressedRemaining = 0;
 	sfile = nullptr;
 	fName.clear();
 	serializer.fileVersion = 0;
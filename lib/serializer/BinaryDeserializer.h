@@ -17,6 +17,7 @@
 #include "../mapObjects/CGHeroInstance.h"
 
 class CStackInstance;
+struct z_stream_s;
 
 class DLL_LINKAGE CLoaderBase
 {
@@ -31,6 +32,29 @@ public:
 	};
 };
 
+/// Lookup table of loaded pointers by their id
+/// Ids are given sequentially on save, so they are kept in a vector; ids far beyond loaded ones
+/// (possible only in damaged or malicious data) go to a map so they cannot make the vector huge
+class DLL_LINKAGE CLoadedPointersMap
+{
+public:
+	struct LoadedPointer
+	{
+		void * ptr;
+		const std::type_info * type;
+	};
+
+	const LoadedPointer * find(ui32 pid) const; //nullptr if pointer with such id was not loaded yet
+	void insert(ui32 pid, void * ptr, const std::type_info * type);
+	void clear();
+
+private:
+	static const ui32 MAX_DENSE_GAP = 1024; //largest jump past last dense id that still grows the vector
+
+	std::vector<LoadedPointer> dense; //indexed by pointer id, unused entries have nullptr
+	std::map<ui32, LoadedPointer> sparse;
+};
+
 /// Main class for deserialization of classes from binary form
 /// Effectively revesed version of BinarySerializer
 class DLL_LINKAGE BinaryDeserializer : public CLoaderBase
@@ -162,8 +186,7 @@ public:
 	bool reverseEndianess; //if source has different endianness than us, we reverse bytes
 	si32 fileVersion;
 
-	std::map<ui32, void*> loadedPointers;
-	std::map<ui32, const std::type_info*> loadedPointersTypes;
+	CLoadedPointersMap loadedPointers;
 	std::map<const void*, boost::any> loadedSharedPointers;
 	bool smartPointerSerialization;
 	bool saving;
@@ -283,14 +306,12 @@ public:
 		if(smartPointerSerialization)
 		{
 			load( pid ); //get the id
-			std::map<ui32, void*>::iterator i = loadedPointers.find(pid); //lookup
 
-			if(i != loadedPointers.end())
+			if(const auto * loaded = loadedPointers.find(pid))
 			{
 				// We already got this pointer
 				// Cast it in case we are loading it to a non-first base pointer
-				assert(loadedPointersTypes.count(pid));
-				data = reinterpret_cast<T>(typeList.castRaw(i->second, loadedPointersTypes.at(pid), &typeid(typename std::remove_const<typename std::remove_pointer<T>::type>::type)));
+				data = reinterpret_cast<T>(typeList.castRaw(loaded->ptr, loaded->type, &typeid(typename std::remove_const<typename std::remove_pointer<T>::type>::type)));
 				return;
 			}
 		}
@@ -326,8 +347,7 @@ public:
 	{
 		if(smartPointerSerialization && pid != 0xffffffff)
 		{
-			loadedPointersTypes[pid] = &typeid(T);
-			loadedPointers[pid] = (void*)ptr; //add loaded pointer to our lookup map; cast is to avoid errors with const T* pt
+			loadedPointers.insert(pid, (void*)ptr, &typeid(T)); //add loaded pointer to our lookup table; cast is to avoid errors with const T* pt
 		}
 	}
 
@@ -516,6 +536,10 @@ public:
 	std::string fName;
 	std::unique_ptr<FileStream> sfile;
 
+	z_stream_s * inflateState; //nullptr if file is not compressed
+	std::vector<ui8> compressedBuffer;
+	si64 compressedRemaining; //bytes of compressed data not read from file yet
+
 	CLoadFile(const boost::filesystem::path & fname, int minimalVersion = SERIALIZATION_VERSION); //throws!
 	~CLoadFile();
 	int read(void * data, unsigned size) override; //throws!
@@ -2,6 +2,9 @@
 #include "BinarySerializer.h"
 
 #include "../registerTypes/RegisterTypes.h"
+#include "../ScopeGuard.h"
+
+#include <zlib.h>
 
 /*
  * BinarySerializer.cpp, part of VCMI engine
@@ -15,25 +18,117 @@
 
 extern template void registerTypes<BinarySerializer>(BinarySerializer & s);
 
-CSaveFile::CSaveFile(const boost::filesystem::path &fname)
-	: serializer(this)
+const ui32 CSavedPointersMap::NOT_FOUND = 0xffffffff;
+
+CSavedPointersMap::CSavedPointersMap() : used(0), hashShift(64)
+{
+}
+
+ui32 CSavedPointersMap::find(const void * ptr) const
+{
+	if(slots.empty())
+		return NOT_FOUND;
+
+	const auto & slot = slots[findSlot(ptr)];
+	return slot.first ? slot.second : NOT_FOUND;
+}
+
+ui32 CSavedPointersMap::insert(const void * ptr)
+{
+	// keep load factor below one half so probe sequences stay short
+	if((used + 1) * 2 > slots.size())
+		grow();
+
+	auto & slot = slots[findSlot(ptr)];
+	assert(!slot.first);
+	slot.first = ptr;
+	slot.second = used++;
+	return slot.second;
+}
+
+size_t CSavedPointersMap::size() const
+{
+	return used;
+}
+
+void CSavedPointersMap::clear()
+{
+	slots.clear();
+	used = 0;
+	hashShift = 64;
+}
+
+size_t CSavedPointersMap::findSlot(const void * ptr) const
+{
+	//Fibonacci hashing: multiplication only carries low bits of address upwards,
+	//so index is taken from top bits of product, which depend on all bits of the pointer
+	const size_t mask = slots.size() - 1;
+	size_t i = (ui64(reinterpret_cast<uintptr_t>(ptr)) * 0x9E3779B97F4A7C15ULL) >> hashShift;
+	while(slots[i].first && slots[i].first != ptr)
+		i = (i + 1) & mask;
+
+	return i;
+}
+
+void CSavedPointersMap::grow()
+{
+	std::vector<std::pair<const void *, ui32>> old(std::max<size_t>(1024, slots.size() * 2), std::make_pair(nullptr, 0));
+	old.swap(slots);
+	hashShift = 64;
+	while((size_t(1) << (64 - hashShift)) < slots.size())
+		hashShift--;
+	for(auto & slot : old)
+	{
+		if(slot.first)
+			slots[findSlot(slot.first)] = slot;
+	}
+}
+
+static const int deflateBlockSize = 65536;
+
+CSaveFile::CSaveFile(const boost::filesystem::path &fname, bool compressed)
+	: serializer(this), deflateState(nullptr)
 {
 	registerTypes(serializer);
-	openNextFile(fname);
+	openNextFile(fname, compressed);
 }
 
 CSaveFile::~CSaveFile()
 {
+	try
+	{
+		clear();
+	}
+	catch(std::exception &e)
+	{
+		logGlobal->errorStream() << "Failed to finish " << fName << ": " << e.what();
+	}
 }
 
 int CSaveFile::write(const void * data, unsigned size)
 {
-	sfile->write((char *)data,size);
+	if(!deflateState)
+	{
+		sfile->write((char *)data,size);
+		return size;
+	}
+
+	deflateState->next_in = (Bytef *)data;
+	deflateState->avail_in = size;
+	while(deflateState->avail_in)
+	{
+		deflateState->next_out = compressedBuffer.data();
+		deflateState->avail_out = compressedBuffer.size();
+		if(deflate(deflateState, Z_NO_FLUSH) != Z_OK) //whole output buffer is free, so no progress means error
+			THROW_FORMAT("Error: cannot compress data of %s!", fName);
+		sfile->write((char *)compressedBuffer.data(), compressedBuffer.size() - deflateState->avail_out);
+	}
 	return size;
 }
 
-void CSaveFile::openNextFile(const boost::filesystem::path &fname)
+void CSaveFile::openNextFile(const boost::filesystem::path &fname, bool compressed)
 {
+	clear();
 	fName = fname;
 	try
 	{
@@ -43,8 +138,23 @@ void CSaveFile::openNextFile(const boost::filesystem::path &fname)
 		if(!(*sfile))
 			THROW_FORMAT("Error: cannot open to write %s!", fname);
 
-		sfile->write("VCMI",4); //write magic identifier
-		serializer & SERIALIZATION_VERSION; //write format version
+		const std::string & magic = compressed ? COMPRESSED_FILE_MAGIC : FILE_MAGIC;
+		sfile->write(magic.c_str(), magic.length()); //write magic identifier
+		serializer & SERIALIZATION_VERSION; //write format version, never compressed
+
+		if(compressed)
+		{
+			compressedBuffer.resize(deflateBlockSize);
+			deflateState = new z_stream;
+			deflateState->zalloc = Z_NULL;
+			deflateState->zfree = Z_NULL;
+			deflateState->opaque = Z_NULL;
+			if(deflateInit(deflateState, Z_DEFAULT_COMPRESSION) != Z_OK)
+			{
+				vstd::clear_pointer(deflateState);
+				THROW_FORMAT("Error: cannot initialize compression for %s!", fname);
+			}
+		}
 	}
 	catch(...)
 	{
@@ -65,6 +175,40 @@ void CSaveFile::reportState(CLogger * out)
 
 void CSaveFile::clear()
 {
+	if(deflateState)
+	{
+		//write everything left in compressor, file is not valid without stream end
+		auto state = deflateState;
+		bool ended = false;
+		auto onExit = vstd::makeScopeGuard([&]
+		{
+			if(!ended)
+				deflateEnd(state);
+			delete state;
+		});
+		deflateState = nullptr;
+
+		int result = Z_STREAM_END;
+		if(sfile)
+		{
+			state->next_in = Z_NULL;
+			state->avail_in = 0;
+			do
+			{
+				state->next_out = compressedBuffer.data();
+				state->avail_out = compressedBuffer.size();
+				result = deflate(state, Z_FINISH);
+				sfile->write((char *)compressedBuffer.data(), compressedBuffer.size() - state->avail_out);
+			}
+			while(result == Z_OK);
+		}
+
+		ended = true;
+		const int endResult = deflateEnd(state);
+		if(sfile && (result != Z_STREAM_END || endResult != Z_OK))
+			THROW_FORMAT("Error: cannot finish compressed data of %s!", fName);
+	}
+	compressedBuffer.clear();
 	fName.clear();
 	sfile = nullptr;
 }
@@ -73,3 +217,38 @@ void CSaveFile::putMagicBytes(const std::string &text)
 {
 	write(text.c_str(), text.length());
 }
+
+CMemorySaveFile::CMemorySaveFile()
+	: serializer(this)
+{
+	registerTypes(serializer);
+}
+
+int CMemorySaveFile::write(const void * data, unsigned size)
+{
+	auto bytes = static_cast<const ui8 *>(data);
+	buffer.insert(buffer.end(), bytes, bytes + size);
+	return size;
+}
+
+void CMemorySaveFile::reportState(CLogger * out)
+{
+	out->debugStream() << "CMemorySaveFile";
+	out->debugStream() << "\tBuffered " << buffer.size() << " bytes";
+}
+
+void CMemorySaveFile::putMagicBytes(const std::string &text)
+{
+	write(text.c_str(), text.length());
+}
+
+void CMemorySaveFile::writeToFile(const boost::filesystem::path &fname, bool compressed) const
+{
+	const boost::filesystem::path tmpName = fname.string() + ".tmp";
+	{
+		CSaveFile file(tmpName, compressed);
+		file.write(buffer.data(), buffer.size());
+		file.clear();
+	}
+	boost::filesystem::rename(tmpName, fname);
+}
@@ -14,6 +14,8 @@
 #include "CTypeList.h"
 #include "../mapObjects/CArmedInstance.h"
 
+struct z_stream_s;
+
 class DLL_LINKAGE CSaverBase
 {
 protected:
@@ -27,6 +29,28 @@ public:
 	};
 };
 
+/// Open addressing hash table with ids of already saved pointers, stored in single array
+class DLL_LINKAGE CSavedPointersMap
+{
+public:
+	static const ui32 NOT_FOUND;
+
+	CSavedPointersMap();
+
+	ui32 find(const void * ptr) const;
+	ui32 insert(const void * ptr); //gives next free id to pointer, pointer must not be in map yet
+	size_t size() const;
+	void clear();
+
+private:
+	std::vector<std::pair<const void *, ui32>> slots; //size is always power of 2, empty slot has nullptr
+	size_t used;
+	int hashShift; //64 - log2(slots.size()), hash takes that many top bits of the product
+
+	size_t findSlot(const void * ptr) const;
+	void grow();
+};
+
 /// Main class for serialization of classes into binary form
 /// Behaviour for various classes is following:
 /// Primitives:    copy memory into underlying stream (defined in CSaverBase)
@@ -109,7 +133,7 @@ class DLL_LINKAGE BinarySerializer : public CSaverBase
 	CApplier<CBasicPointerSaver> applier;
 
 public:
-	std::map<const void*, ui32> savedPointers;
+	CSavedPointersMap savedPointers;
 
 	bool smartPointerSerialization;
 	bool saving;
@@ -208,17 +232,16 @@ public:
 			// We might have an object that has multiple inheritance and store it via the non-first base pointer.
 			// Therefore, all pointers need to be normalized to the actual object address.
 			auto actualPointer = typeList.castToMostDerived(data);
-			std::map<const void*,ui32>::iterator i = savedPointers.find(actualPointer);
-			if(i != savedPointers.end())
+			ui32 pid = savedPointers.find(actualPointer);
+			if(pid != CSavedPointersMap::NOT_FOUND)
 			{
 				//this pointer has been already serialized - write only it's id
-				save(i->second);
+				save(pid);
 				return;
 			}
 
 			//give id to this pointer
-			ui32 pid = (ui32)savedPointers.size();
-			savedPointers[actualPointer] = pid;
+			pid = savedPointers.insert(actualPointer);
 			save(pid);
 		}
 
@@ -354,12 +377,15 @@ public:
 	boost::filesystem::path fName;
 	std::unique_ptr<FileStream> sfile;
 
-	CSaveFile(const boost::filesystem::path &fname); //throws!
+	z_stream_s * deflateState; //nullptr if data is written uncompressed
+	std::vector<ui8> compressedBuffer;
+
+	CSaveFile(const boost::filesystem::path &fname, bool compressed = false); //throws!
 	~CSaveFile();
 	int write(const void * data, unsigned size) override;
 
-	void openNextFile(const boost::filesystem::path &fname); //throws!
-	void clear();
+	void openNextFile(const boost::filesystem::path &fname, bool compressed = false); //throws!
+	void clear(); //finishes compressed stream, if any
 	void reportState(CLogger * out) override;
 
 	void putMagicBytes(const std::string &text);
@@ -371,3 +397,27 @@ public:
 		return * this;
 	}
 };
+
+/// Savegame kept in memory, buffer holds everything CSaveFile would write after file header.
+/// Serialization only touches memory, so slow disk writes can be done later (or by another thread) with writeToFile.
+class DLL_LINKAGE CMemorySaveFile : public IBinaryWriter
+{
+public:
+	BinarySerializer serializer;
+	std::vector<ui8> buffer;
+
+	CMemorySaveFile();
+	int write(const void * data, unsigned size) override;
+	void reportState(CLogger * out) override;
+
+	void putMagicBytes(const std::string &text);
+	/// writes temporary file first and renames it, so existing save is only replaced by complete one
+	void writeToFile(const boost::filesystem::path &fname, bool compressed = false) const; //throws!
+
+	template<class T>
+	CMemorySaveFile & operator<<(const T &t)
+	{
+		serializer & t;
+		return * this;
+	}
+};
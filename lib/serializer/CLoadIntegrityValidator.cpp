@@ -51,7 +51,6 @@ int CLoadIntegrityValidator::read( void * data, unsigned size )
 std::unique_ptr<CLoadFile> CLoadIntegrityValidator::decay()
 {
 	primaryFile->serializer.loadedPointers = this->serializer.loadedPointers;
-	primaryFile->serializer.loadedPointersTypes = this->serializer.loadedPointersTypes;
 	return std::move(primaryFile);
 }
 
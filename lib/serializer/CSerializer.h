@@ -18,6 +18,10 @@ const ui32 SERIALIZATION_VERSION = 761;
 const ui32 MINIMAL_SERIALIZATION_VERSION = 753;
 const std::string SAVEGAME_MAGIC = "VCMISVG";
 
+/// Files written by CSaveFile start with one of these, followed by format version and data
+const std::string FILE_MAGIC = "VCMI"; //uncompressed data
+const std::string COMPRESSED_FILE_MAGIC = "VCMZ"; //data compressed as single zlib stream
+
 class CHero;
 class CGHeroInstance;
 class CGObjectInstance;
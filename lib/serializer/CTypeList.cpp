@@ -22,6 +22,59 @@ CTypeList::CTypeList()
 	registerTypes(*this);
 }
 
+CTypeList::CastOffsetCache::CastOffsetCache()
+{
+	for(auto & slot : slots)
+	{
+		slot.from.store(nullptr);
+		slot.to = nullptr;
+		slot.offset = 0;
+	}
+}
+
+bool CTypeList::CastOffsetCache::find(const std::type_info * from, const std::type_info * to, ptrdiff_t & offset) const
+{
+	for(size_t i = hash(from, to), probes = 0; probes < SLOTS_COUNT; i = (i + 1) % SLOTS_COUNT, probes++)
+	{
+		const std::type_info * slotFrom = slots[i].from.load(std::memory_order_acquire);
+		if(!slotFrom)
+			return false;
+
+		if(slotFrom == from && slots[i].to == to)
+		{
+			offset = slots[i].offset;
+			return true;
+		}
+	}
+	return false;
+}
+
+void CTypeList::CastOffsetCache::insert(const std::type_info * from, const std::type_info * to, ptrdiff_t offset)
+{
+	boost::unique_lock<boost::mutex> lock(insertMx);
+	for(size_t i = hash(from, to), probes = 0; probes < SLOTS_COUNT; i = (i + 1) % SLOTS_COUNT, probes++)
+	{
+		const std::type_info * slotFrom = slots[i].from.load(std::memory_order_relaxed);
+		if(slotFrom == from && slots[i].to == to)
+			return; //other thread was faster
+
+		if(!slotFrom)
+		{
+			slots[i].to = to;
+			slots[i].offset = offset;
+			slots[i].from.store(from, std::memory_order_release);
+			return;
+		}
+	}
+	//table is full, such casts will keep using slow path
+}
+
+size_t CTypeList::CastOffsetCache::hash(const std::type_info * from, const std::type_info * to)
+{
+	const size_t a = reinterpret_cast<size_t>(from) >> 3, b = reinterpret_cast<size_t>(to) >> 3;
+	return (a * 2654435761U ^ b * 40503U) % SLOTS_COUNT;
+}
+
 CTypeList::TypeInfoPtr CTypeList::registerType(const std::type_info *type)
 {
 	if(auto typeDescr = getTypeDescriptor(type, false))
@@ -46,6 +99,22 @@ ui16 CTypeList::getTypeID(const std::type_info *type, bool throws) const
 	return descriptor->typeID;
 }
 
+void * CTypeList::castRaw(void *inputPtr, const std::type_info *from, const std::type_info *to) const
+{
+	if(!inputPtr)
+		return nullptr;
+
+	ptrdiff_t offset;
+	if(!castOffsets.find(from, to, offset))
+	{
+		//first cast between these types, find offset by going through casters chain
+		auto result = boost::any_cast<void*>(castHelper<&IPointerCaster::castRawPtr>(inputPtr, from, to));
+		offset = static_cast<ui8 *>(result) - static_cast<ui8 *>(inputPtr);
+		castOffsets.insert(from, to, offset);
+	}
+	return static_cast<ui8 *>(inputPtr) + offset;
+}
+
 std::vector<CTypeList::TypeInfoPtr> CTypeList::castSequence(TypeInfoPtr from, TypeInfoPtr to) const
 {
 	if(!strcmp(from->name, to->name))
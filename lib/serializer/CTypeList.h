@@ -13,6 +13,8 @@
 
 #include "CSerializer.h"
 
+#include <atomic>
+
 struct IPointerCaster
 {
 	virtual boost::any castRawPtr(const boost::any &ptr) const = 0; // takes From*, returns To*
@@ -76,8 +78,35 @@ class DLL_LINKAGE CTypeList: public boost::noncopyable
 	typedef boost::shared_mutex TMutex;
 	typedef boost::unique_lock<TMutex> TUniqueLock;
 	typedef boost::shared_lock<TMutex> TSharedLock;
+
+	/// Raw pointer cast between two registered types always moves address by the same offset
+	/// (there is no virtual inheritance among them), so offset is found once for every pair of types.
+	/// Fixed size open addressing table, entries are never removed so lookups need no lock.
+	class CastOffsetCache : public boost::noncopyable
+	{
+	public:
+		CastOffsetCache();
+
+		bool find(const std::type_info * from, const std::type_info * to, ptrdiff_t & offset) const;
+		void insert(const std::type_info * from, const std::type_info * to, ptrdiff_t offset);
+
+	private:
+		struct Slot
+		{
+			std::atomic<const std::type_info *> from; //written last, slot is empty while it is nullptr
+			const std::type_info * to;
+			ptrdiff_t offset;
+		};
+		static const size_t SLOTS_COUNT = 4096;
+
+		std::array<Slot, SLOTS_COUNT> slots;
+		boost::mutex insertMx;
+
+		static size_t hash(const std::type_info * from, const std::type_info * to);
+	};
 private:
 	mutable TMutex mx;
+	mutable CastOffsetCache castOffsets;
 
 	std::map<const std::type_info *, TypeInfoPtr, TypeComparer> typeInfos;
 	std::map<std::pair<TypeInfoPtr, TypeInfoPtr>, std::unique_ptr<const IPointerCaster>> casters; //for each pair <Base, Der> we provide a caster (each registered relations creates a single entry here)
@@ -134,6 +163,10 @@ public:
 		auto bti = registerType(bt);
 		auto dti = registerType(dt); //obtain our TypeDescriptor
 
+		//every serializer registers all types again, relation has to be stored only once
+		if(casters.count(std::make_pair(bti, dti)))
+			return;
+
 		// register the relation between classes
 		bti->children.push_back(dti);
 		dti->parents.push_back(bti);
@@ -160,9 +193,7 @@ public:
 			return const_cast<void*>(reinterpret_cast<const void*>(inputPtr));
 		}
 
-		return boost::any_cast<void*>(castHelper<&IPointerCaster::castRawPtr>(
-			const_cast<void*>(reinterpret_cast<const void*>(inputPtr)), &baseType,
-			derivedType));
+		return castRaw(const_cast<void*>(reinterpret_cast<const void*>(inputPtr)), &baseType, derivedType);
 	}
 
 	template<typename TInput>
@@ -177,10 +208,7 @@ public:
 		return castHelper<&IPointerCaster::castSharedPtr>(inputPtr, &baseType, derivedType);
 	}
 
-	void * castRaw(void *inputPtr, const std::type_info *from, const std::type_info *to) const
-	{
-		return boost::any_cast<void*>(castHelper<&IPointerCaster::castRawPtr>(inputPtr, from, to));
-	}
+	void * castRaw(void *inputPtr, const std::type_info *from, const std::type_info *to) const;
 	boost::any castShared(boost::any inputPtr, const std::type_info *from, const std::type_info *to) const
 	{
 		return castHelper<&IPointerCaster::castSharedPtr>(inputPtr, from, to);
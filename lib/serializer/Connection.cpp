@@ -46,9 +46,12 @@ void CConnection::init()
 	myEndianess = false;
 #endif
 	connected = true;
+	readPos = 0;
+	batchDepth = 0;
 	std::string pom;
 	//we got connection
 	oser & std::string("Aiya!\n") & name & myEndianess; //identify ourselves
+	flush();
 	iser & pom & pom & contactEndianess;
 	logNetwork->infoStream() << "Established connection with "<<pom;
 	wmx = new boost::mutex;
@@ -136,12 +139,45 @@ CConnection::CConnection(TAcceptor * acceptor, boost::asio::io_service *Io_servi
 	init();
 }
 int CConnection::write(const void * data, unsigned size)
+{
+	auto bytes = static_cast<const ui8 *>(data);
+	writeBuffer.insert(writeBuffer.end(), bytes, bytes + size);
+	return size;
+}
+int CConnection::read(void * data, unsigned size)
+{
+	auto out = static_cast<ui8 *>(data);
+	unsigned done = 0;
+	while(done < size)
+	{
+		if(readPos == readBuffer.size())
+			receiveFrame();
+
+		const unsigned chunk = std::min<size_t>(size - done, readBuffer.size() - readPos);
+		std::copy_n(readBuffer.data() + readPos, chunk, out + done);
+		readPos += chunk;
+		done += chunk;
+	}
+	return size;
+}
+void CConnection::receiveFrame()
 {
 	try
 	{
-		int ret;
-		ret = asio::write(*socket,asio::const_buffers_1(asio::const_buffer(data,size)));
-		return ret;
+		std::array<ui8, 4> header;
+		asio::read(*socket, asio::buffer(header));
+		const ui32 length = header[0] | (header[1] << 8) | (header[2] << 16) | (header[3] << 24);
+		if(length > MAX_FRAME_SIZE) //length comes from peer, don't let it allocate arbitrary memory
+		{
+			logNetwork->errorStream() << "Received frame of " << length << " bytes, closing connection " << name;
+			system::error_code ec;
+			socket->close(ec);
+			throw std::runtime_error("Frame too big");
+		}
+
+		readBuffer.resize(length);
+		readPos = 0;
+		asio::read(*socket, asio::buffer(readBuffer));
 	}
 	catch(...)
 	{
@@ -150,16 +186,27 @@ int CConnection::write(const void * data, unsigned size)
 		throw;
 	}
 }
-int CConnection::read(void * data, unsigned size)
+void CConnection::flush()
 {
+	if(writeBuffer.empty() || (batchDepth && batchThread == boost::this_thread::get_id()))
+		return; //other threads send right away, taking along packs batched so far
+
 	try
 	{
-		int ret = asio::read(*socket,asio::mutable_buffers_1(asio::mutable_buffer(data,size)));
-		return ret;
+		for(size_t sent = 0; sent < writeBuffer.size();)
+		{
+			const ui32 length = std::min<size_t>(writeBuffer.size() - sent, MAX_FRAME_SIZE);
+			const std::array<ui8, 4> header = {{ui8(length), ui8(length >> 8), ui8(length >> 16), ui8(length >> 24)}};
+			const std::array<asio::const_buffer, 2> frame = {{asio::buffer(header), asio::buffer(writeBuffer.data() + sent, length)}};
+			asio::write(*socket, frame);
+			sent += length;
+		}
+		writeBuffer.clear(); //keep capacity for next frames
 	}
 	catch(...)
 	{
 		//connection has been lost
+		writeBuffer.clear();
 		connected = false;
 		throw;
 	}
@@ -226,6 +273,25 @@ void CConnection::sendPackToServer(const CPack &pack, PlayerColor player, ui32 r
 	boost::unique_lock<boost::mutex> lock(*wmx);
 	logNetwork->traceStream() << "Sending to server a pack of type " << typeid(pack).name();
 	oser & player & requestID & &pack; //packs has to be sent as polymorphic pointers!
+	flush();
+}
+
+bool CConnection::beginBatch()
+{
+	boost::unique_lock<boost::mutex> lock(*wmx);
+	if(batchDepth && batchThread != boost::this_thread::get_id())
+		return false;
+
+	batchThread = boost::this_thread::get_id();
+	batchDepth++;
+	return true;
+}
+
+void CConnection::endBatch()
+{
+	boost::unique_lock<boost::mutex> lock(*wmx);
+	if(--batchDepth == 0)
+		flush();
 }
 
 void CConnection::disableStackSendingByID()
@@ -52,6 +52,18 @@ class DLL_LINKAGE CConnection
 
 	int write(const void * data, unsigned size) override;
 	int read(void * data, unsigned size) override;
+
+	/// Data is sent in frames: 4-byte little endian payload length followed by payload.
+	/// Frames are only chunks of serialized stream, so bigger data is split into several of them.
+	static const ui32 MAX_FRAME_SIZE = 4 * 1024 * 1024;
+	std::vector<ui8> writeBuffer; //serialized data not sent yet
+	std::vector<ui8> readBuffer; //payload of last received frame
+	size_t readPos;
+	int batchDepth;
+	boost::thread::id batchThread; //only packs written by this thread are held back while batching
+
+	void flush(); //sends buffered data, caller has to hold wmx
+	void receiveFrame();
 public:
 	BinaryDeserializer iser;
 	BinarySerializer oser;
@@ -89,6 +101,11 @@ public:
 	void disableSmartVectorMemberSerialization();
 	void enableSmartVectorMemberSerializatoin();
 
+	/// Packs sent by calling thread between beginBatch and matching endBatch are coalesced into a single frame.
+	/// Returns false if other thread is batching already, then nothing is batched and endBatch must not be called.
+	bool beginBatch();
+	void endBatch();
+
 	void prepareForSendingHeroes(); //disables sending vectorized, enables smart pointer serialization, clears saved/loaded ptr cache
 	void enterPregameConnectionMode();
 
@@ -103,6 +120,7 @@ public:
 	CConnection & operator<<(const T &t)
 	{
 		oser & t;
+		flush();
 		return * this;
 	}
 };
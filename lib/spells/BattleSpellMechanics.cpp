@@ -205,7 +205,7 @@ bool CureMechanics::dispellSelector(const Bonus * b)
 ESpellCastProblem::ESpellCastProblem CureMechanics::isImmuneByStack(const ISpellCaster * caster, const CStack * obj) const
 {
 	//Selector method name is ok as cashing string. --AVS
-	if(!obj->canBeHealed() && !canDispell(obj, dispellSelector, "CureMechanics::dispellSelector"))
+	if(!obj->canBeHealed() && !canDispell(obj, dispellSelector, BonusCacheKey(BonusCacheKey::CURE_DISPELLABLE)))
 		return ESpellCastProblem::STACK_IMMUNE_TO_SPELL;
 
 	return DefaultSpellMechanics::isImmuneByStack(caster, obj);
@@ -227,13 +227,11 @@ ESpellCastProblem::ESpellCastProblem DispellMechanics::isImmuneByStack(const ISp
 	//DISPELL ignores all immunities, except specific absolute immunity
 	{
 		//SPELL_IMMUNITY absolute case
-		std::stringstream cachingStr;
-		cachingStr << "type_" << Bonus::SPELL_IMMUNITY << "subtype_" << owner->id.toEnum() << "addInfo_1";
-		if(obj->hasBonus(Selector::typeSubtypeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1), cachingStr.str()))
+		if(obj->hasBonus(Selector::typeSubtypeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1), BonusCacheKey::typeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1)))
 			return ESpellCastProblem::STACK_IMMUNE_TO_SPELL;
 	}
 
-	if(canDispell(obj, Selector::all, "DefaultSpellMechanics::dispellSelector"))
+	if(canDispell(obj, Selector::all, BonusCacheKey(BonusCacheKey::DISPELLABLE)))
 		return ESpellCastProblem::OK;
 	else
 		return ESpellCastProblem::WRONG_SPELL_TARGET;
@@ -782,9 +782,9 @@ void DefaultSpellMechanics::doDispell(BattleInfo * battle, const BattleSpellCast
 	}
 }
 
-bool DefaultSpellMechanics::canDispell(const IBonusBearer * obj, const CSelector & selector, const std::string & cachingStr/* = "" */) const
+bool DefaultSpellMechanics::canDispell(const IBonusBearer * obj, const CSelector & selector, const BonusCacheKey & cachingKey/* = BonusCacheKey() */) const
 {
-	return obj->hasBonus(selector.And(dispellSelector), Selector::all, cachingStr);
+	return obj->hasBonus(selector.And(dispellSelector), Selector::all, cachingKey);
 }
 
 void DefaultSpellMechanics::handleImmunities(const CBattleInfoCallback * cb, const SpellTargetingContext & ctx, std::vector<const CStack*> & stacks) const
@@ -74,7 +74,7 @@ protected:
 
 protected:
 	void doDispell(BattleInfo * battle, const BattleSpellCast * packet, const CSelector & selector) const;
-	bool canDispell(const IBonusBearer * obj, const CSelector & selector, const std::string &cachingStr = "") const;
+	bool canDispell(const IBonusBearer * obj, const CSelector & selector, const BonusCacheKey & cachingKey = BonusCacheKey()) const;
 private:
 	void cast(const SpellCastEnvironment * env, const BattleSpellCastParameters & parameters, std::vector <const CStack*> & reflected) const;
 
@@ -46,9 +46,7 @@ ESpellCastProblem::ESpellCastProblem AcidBreathDamageMechanics::isImmuneByStack(
 	//ignore all immunities, except specific absolute immunity
 	{
 		//SPELL_IMMUNITY absolute case
-		std::stringstream cachingStr;
-		cachingStr << "type_" << Bonus::SPELL_IMMUNITY << "subtype_" << owner->id.toEnum() << "addInfo_1";
-		if(obj->hasBonus(Selector::typeSubtypeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1), cachingStr.str()))
+		if(obj->hasBonus(Selector::typeSubtypeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1), BonusCacheKey::typeInfo(Bonus::SPELL_IMMUNITY, owner->id.toEnum(), 1)))
 			return ESpellCastProblem::STACK_IMMUNE_TO_SPELL;
 	}
 	return ESpellCastProblem::OK;
@@ -88,7 +86,7 @@ void DispellHelpfulMechanics::applyBattle(BattleInfo * battle, const BattleSpell
 
 ESpellCastProblem::ESpellCastProblem DispellHelpfulMechanics::isImmuneByStack(const ISpellCaster * caster,  const CStack * obj) const
 {
-	if(!canDispell(obj, positiveSpellEffects, "DispellHelpfulMechanics::positiveSpellEffects"))
+	if(!canDispell(obj, positiveSpellEffects, BonusCacheKey(BonusCacheKey::HELPFUL_DISPELLABLE)))
 		return ESpellCastProblem::NO_SPELLS_TO_DISPEL;
 
 	//use default algorithm only if there is no mechanics-related problem
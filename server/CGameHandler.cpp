@@ -23,6 +23,7 @@
 #include "../lib/rmg/CMapGenOptions.h"
 #include "../lib/VCMIDirs.h"
 #include "../lib/ScopeGuard.h"
+#include "../lib/CConfigHandler.h"
 #include "../lib/CSoundBase.h"
 #include "CGameHandler.h"
 #include "CVCMIServer.h"
@@ -47,6 +48,7 @@
 #ifndef _MSC_VER
 #include <boost/thread/xtime.hpp>
 #endif
+#include <chrono>
 extern bool end2;
 #ifdef min
 #undef min
@@ -960,6 +962,33 @@ void CGameHandler::handleConnection(std::set<PlayerColor> players, CConnection &
 				boost::unique_lock<boost::mutex> lock(*c.wmx);
 				c << &applied;
 			};
+			//everything this thread sends to clients while handling this request goes out as one frame per connection
+			//conns may change while request is handled, so only connections batched here are flushed at the end
+			std::vector<CConnection *> batched;
+			for(auto connection : conns)
+			{
+				if(connection->beginBatch())
+					batched.push_back(connection);
+			}
+			auto onExit = vstd::makeScopeGuard([&]
+			{
+				for(auto connection : batched)
+				{
+					try
+					{
+						connection->endBatch();
+					}
+					catch(std::exception & e)
+					{
+						logNetwork->error("Failed to send batched packs to %s: %s", connection->name, e.what());
+					}
+					catch(...)
+					{
+						logNetwork->error("Failed to send batched packs to %s", connection->name);
+					}
+				}
+			});
+
 			CBaseForGHApply *apply = applier->getApplier(packType); //and appropriate applier object
 			if(isBlockedByQueries(pack, player))
 			{
@@ -983,6 +1012,7 @@ void CGameHandler::handleConnection(std::set<PlayerColor> players, CConnection &
 			}
 
 			vstd::clear_pointer(pack);
+			reportSaveError();
 		}
 	}
 	catch(boost::system::system_error &e) //for boost errors just log, not crash - probably client shut down connection
@@ -1321,6 +1351,8 @@ CGameHandler::CGameHandler(void)
 
 CGameHandler::~CGameHandler(void)
 {
+	if(saveThread.joinable())
+		saveThread.join();
 	delete spellEnv;
 	delete applier;
 	applier = nullptr;
@@ -2564,6 +2596,7 @@ void CGameHandler::sendAndApply(NewStructures * info)
 
 void CGameHandler::save(const std::string & filename)
 {
+	boost::unique_lock<boost::mutex> lock(saveMx);
 	logGlobal->info("Saving to %s", filename);
 	const auto stem	= FileInfo::GetPathStem(filename);
 	const auto savefname = stem.to_string() + ".vsgm1";
@@ -2575,15 +2608,42 @@ void CGameHandler::save(const std::string & filename)
 		sendToAllClients(&sg);
 	}
 
+	//previous save may still be written, don't let two threads write to same file
+	if(saveThread.joinable())
+		saveThread.join();
+	reportSaveError();
+
 	try
 	{
-		{
-			CSaveFile save(*CResourceHandler::get("local")->getResourceName(ResourceID(stem.to_string(), EResType::SERVER_SAVEGAME)));
-			saveCommonState(save);
-			logGlobal->info("Saving server state");
-			save << *this;
-		}
-		logGlobal->info("Game has been successfully saved!");
+		//game is blocked only while state is serialized into memory, disk is accessed by save thread
+		//wall clock is measured, this is how long players wait
+		const auto start = std::chrono::steady_clock::now();
+		auto save = std::make_shared<CMemorySaveFile>();
+		saveCommonState(*save);
+		logGlobal->info("Saving server state");
+		*save << *this;
+		logGlobal->info("Game state serialized in %d ms (%d KB)", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), save->buffer.size() / 1024);
+
+		const boost::filesystem::path path = *CResourceHandler::get("local")->getResourceName(ResourceID(stem.to_string(), EResType::SERVER_SAVEGAME));
+		const bool compressed = settings["general"]["compressSaves"].Bool();
+		saveThread = boost::thread([this, save, path, compressed]()
+		{
+			setThreadName("CGameHandler::save");
+			try
+			{
+				const auto start = std::chrono::steady_clock::now();
+				save->writeToFile(path, compressed);
+				logGlobal->info("Game has been successfully saved! Writing %s took %d ms", path.string(), std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+			}
+			catch(std::exception &e)
+			{
+				//save request has been answered already, so players have to be told it failed
+				//gamestate and connections belong to game threads, message is passed to them
+				logGlobal->error("Failed to save game: %s", e.what());
+				boost::unique_lock<boost::mutex> lock(saveErrorMx);
+				saveError = std::string("Failed to save game: ") + e.what();
+			}
+		});
 	}
 	catch(std::exception &e)
 	{
@@ -2591,6 +2651,17 @@ void CGameHandler::save(const std::string & filename)
 	}
 }
 
+void CGameHandler::reportSaveError()
+{
+	std::string error;
+	{
+		boost::unique_lock<boost::mutex> lock(saveErrorMx);
+		std::swap(error, saveError);
+	}
+	if(!error.empty())
+		complain(error);
+}
+
 void CGameHandler::close()
 {
 	logGlobal->info("We have been requested to close.");
@@ -5567,6 +5638,9 @@ void CGameHandler::runBattle()
 		}
 	}
 
+	const ui64 bonusAllocations = CBonusPool::allocations();
+	const ui64 bonusHeapAllocations = CBonusPool::heapAllocations();
+
 	//main loop
 	while (!battleResult.get()) //till the end of the battle ;]
 	{
@@ -5814,6 +5888,9 @@ void CGameHandler::runBattle()
 		}
 	}
 
+	logGlobal->debug("Battle took %d rounds: %d bonuses and bonus lists created with %d heap allocations",
+		gs->curB->round, CBonusPool::allocations() - bonusAllocations, CBonusPool::heapAllocations() - bonusHeapAllocations);
+
 	endBattle(gs->curB->tile, gs->curB->battleGetFightingHero(0), gs->curB->battleGetFightingHero(1));
 }
 
@@ -225,6 +225,7 @@ public:
 	bool disbandCreature( ObjectInstanceID id, SlotID pos );
 	bool arrangeStacks( ObjectInstanceID id1, ObjectInstanceID id2, ui8 what, SlotID p1, SlotID p2, si32 val, PlayerColor player);
 	void save(const std::string &fname);
+	void reportSaveError(); //tells players if last background save failed, call only from game threads
 	void close();
 	void handleTimeEvents();
 	void handleTownEvents(CGTownInstance *town, NewTurn &n);
@@ -291,6 +292,10 @@ public:
 
 private:
 	ServerSpellCastEnvironment * spellEnv;
+	boost::thread saveThread; //writes last save to disk
+	boost::mutex saveMx; //saves are requested from connection threads of all clients
+	boost::mutex saveErrorMx;
+	std::string saveError; //set by save thread, reported to players by reportSaveError
 
 	std::list<PlayerColor> generatePlayerTurnOrder() const;
 	void makeStackDoNothing(const CStack * next);
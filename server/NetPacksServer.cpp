@@ -47,8 +47,7 @@ CGameState* CPackForServer::GS(CGameHandler *gh)
 
 bool SaveGame::applyGh( CGameHandler *gh )
 {
-	gh->save(fname);
-	logGlobal->info("Game has been saved as %s", fname);
+	gh->save(fname); //file is written in background, failure is reported to players by game handler
 	return true;
 }
 
@@ -0,0 +1,35 @@
+/*
+ * CBenchmark.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "CBenchmark.h"
+
+CBenchmark::CBenchmark()
+	: last(std::chrono::steady_clock::now())
+{
+}
+
+bool CBenchmark::enabled()
+{
+	const auto & suite = boost::unit_test::framework::master_test_suite();
+	for(int i = 1; i < suite.argc; i++)
+	{
+		if(std::string(suite.argv[i]) == "--benchmark")
+			return true;
+	}
+	return false;
+}
+
+si64 CBenchmark::getDiff()
+{
+	const auto now = std::chrono::steady_clock::now();
+	const si64 ret = std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count();
+	last = now;
+	return ret;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+/*
+ * CBenchmark.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#include <chrono>
+#include <boost/test/unit_test.hpp>
+
+/// Benchmarks are test cases of vcmitest which only run when "--benchmark" is passed on command line
+/// (after "--" separator with newer boost), so regular test run stays short.
+class CBenchmark
+{
+public:
+	CBenchmark();
+
+	static bool enabled();
+
+	/// Wall clock time in milliseconds since construction or previous call
+	si64 getDiff();
+
+private:
+	std::chrono::steady_clock::time_point last;
+};
+
+#define VCMI_BENCHMARK_FIXTURE_CASE(test_name, F) \
+	struct test_name##_body : public F, public CBenchmark \
+	{ \
+		void run(); \
+	}; \
+	BOOST_AUTO_TEST_CASE(test_name) \
+	{ \
+		if(CBenchmark::enabled()) \
+			test_name##_body().run(); \
+		else \
+			BOOST_TEST_MESSAGE(#test_name " skipped, run with --benchmark"); \
+	} \
+	void test_name##_body::run()
+
+struct CBenchmarkNoFixture
+{
+};
+
+#define VCMI_BENCHMARK_CASE(test_name) VCMI_BENCHMARK_FIXTURE_CASE(test_name, CBenchmarkNoFixture)
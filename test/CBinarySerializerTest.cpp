@@ -0,0 +1,267 @@
+/*
+ * CBinarySerializerTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "CBenchmark.h"
+#include "../lib/CRandomGenerator.h"
+#include "../lib/serializer/BinaryDeserializer.h"
+#include "../lib/serializer/BinarySerializer.h"
+#include "../lib/serializer/CMemorySerializer.h"
+#include "../lib/mapObjects/CGTownInstance.h"
+
+/// Object graph with many shared pointers, similar to what gamestate stores in saves
+struct SerializerTestNode
+{
+	si32 value;
+	std::vector<SerializerTestNode *> links; //only to nodes created earlier, so recursion stays shallow
+
+	template <typename Handler> void serialize(Handler &h, const int version)
+	{
+		h & value & links;
+	}
+};
+
+struct CBinarySerializerFixture
+{
+	std::vector<SerializerTestNode *> nodes;
+
+	CBinarySerializerFixture(int nodeCount = 2000)
+	{
+		CRandomGenerator rand;
+		rand.setSeed(42);
+		for(int i = 0; i < nodeCount; i++)
+		{
+			auto node = new SerializerTestNode();
+			node->value = i;
+			for(int j = 0; i && j < 4; j++)
+				node->links.push_back(nodes[rand.nextInt(i - 1)]);
+			nodes.push_back(node);
+		}
+	}
+
+	~CBinarySerializerFixture()
+	{
+		for(auto node : nodes)
+			delete node;
+	}
+};
+
+BOOST_FIXTURE_TEST_CASE(CBinarySerializer_PointerGraph, CBinarySerializerFixture)
+{
+	CMemorySerializer mem;
+	mem.oser & nodes;
+	BOOST_CHECK_EQUAL(nodes.size(), mem.oser.savedPointers.size());
+
+	std::vector<SerializerTestNode *> loaded;
+	mem.iser & loaded;
+	BOOST_REQUIRE_EQUAL(nodes.size(), loaded.size());
+
+	bool linksMatch = true;
+	for(size_t i = 0; i < nodes.size(); i++)
+	{
+		BOOST_REQUIRE(loaded[i] != nodes[i]);
+		for(size_t j = 0; j < nodes[i]->links.size(); j++)
+			linksMatch &= loaded[i]->links[j] == loaded[nodes[i]->links[j]->value]; //same object, not a copy
+	}
+	BOOST_CHECK(linksMatch);
+
+	for(auto node : loaded)
+		delete node;
+}
+
+BOOST_AUTO_TEST_CASE(CLoadedPointersMap_SparseIds)
+{
+	int first = 0, second = 0, third = 0;
+	CLoadedPointersMap loaded;
+	loaded.insert(0, &first, &typeid(int));
+	loaded.insert(0xfffffff0, &second, &typeid(int)); //far beyond loaded ids, must not allocate table for all ids below
+	loaded.insert(1, &third, &typeid(int));
+
+	BOOST_REQUIRE(loaded.find(0xfffffff0));
+	BOOST_CHECK_EQUAL(loaded.find(0xfffffff0)->ptr, &second);
+	BOOST_CHECK_EQUAL(loaded.find(0)->ptr, &first);
+	BOOST_CHECK_EQUAL(loaded.find(1)->ptr, &third);
+	BOOST_CHECK(loaded.find(2) == nullptr);
+
+	loaded.clear();
+	BOOST_CHECK(loaded.find(0) == nullptr);
+	BOOST_CHECK(loaded.find(0xfffffff0) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(CTypeList_CastRaw)
+{
+	//town has several bases, casts to IShipyard and IMarket have to move the pointer
+	CGTownInstance town;
+	void * townPtr = &town;
+	for(int i = 0; i < 2; i++) //second pass uses cached offsets
+	{
+		BOOST_CHECK_EQUAL(typeList.castRaw(townPtr, &typeid(CGTownInstance), &typeid(IShipyard)), static_cast<IShipyard *>(&town));
+		BOOST_CHECK_EQUAL(typeList.castRaw(townPtr, &typeid(CGTownInstance), &typeid(IMarket)), static_cast<IMarket *>(&town));
+		BOOST_CHECK_EQUAL(typeList.castRaw(townPtr, &typeid(CGTownInstance), &typeid(CGObjectInstance)), static_cast<CGObjectInstance *>(&town));
+
+		void * marketPtr = static_cast<IMarket *>(&town);
+		BOOST_CHECK_EQUAL(typeList.castRaw(marketPtr, &typeid(IMarket), &typeid(CGTownInstance)), townPtr);
+		BOOST_CHECK_EQUAL(typeList.castToMostDerived(static_cast<IShipyard *>(&town)), townPtr);
+	}
+	BOOST_CHECK(typeList.castRaw(nullptr, &typeid(IMarket), &typeid(CGTownInstance)) == nullptr);
+}
+
+/// Temporary directory for save files, removed with everything inside
+struct CSaveFileFixture
+{
+	boost::filesystem::path dir;
+	std::vector<si32> numbers;
+	std::string text;
+
+	CSaveFileFixture()
+		: dir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vcmi-test-%%%%-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(dir);
+		CRandomGenerator rand;
+		rand.setSeed(42);
+		for(int i = 0; i < 100000; i++)
+			numbers.push_back(rand.nextInt(1000)); //compressible, but not trivially
+		text = "Saved by unit test";
+	}
+
+	~CSaveFileFixture()
+	{
+		boost::system::error_code ec;
+		boost::filesystem::remove_all(dir, ec);
+	}
+
+	void checkLoad(const boost::filesystem::path & path)
+	{
+		CLoadFile load(path);
+		std::vector<si32> loadedNumbers;
+		std::string loadedText;
+		load >> loadedNumbers >> loadedText;
+		BOOST_CHECK(loadedNumbers == numbers);
+		BOOST_CHECK_EQUAL(loadedText, text);
+	}
+};
+
+BOOST_FIXTURE_TEST_CASE(CMemorySaveFile_WriteToFile, CSaveFileFixture)
+{
+	for(bool compressed : {false, true})
+	{
+		const auto path = dir / (compressed ? "compressed.vsgm1" : "plain.vsgm1");
+		boost::filesystem::ofstream(path) << "previous save";
+
+		CMemorySaveFile save;
+		save << numbers << text;
+		save.writeToFile(path, compressed);
+
+		//old save is replaced and temporary file is gone
+		BOOST_CHECK(!boost::filesystem::exists(path.string() + ".tmp"));
+		checkLoad(path);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(CMemorySaveFile_FailedWriteKeepsOldSave, CSaveFileFixture)
+{
+	const auto path = dir / "save.vsgm1";
+	boost::filesystem::ofstream(path) << "previous save";
+	boost::filesystem::create_directory(path.string() + ".tmp"); //temporary file can't be created
+
+	CMemorySaveFile save;
+	save << numbers;
+	BOOST_CHECK_THROW(save.writeToFile(path, true), std::exception);
+
+	std::string content;
+	boost::filesystem::ifstream(path) >> content;
+	BOOST_CHECK_EQUAL(content, "previous");
+}
+
+BOOST_FIXTURE_TEST_CASE(CSaveFile_RoundTrip, CSaveFileFixture)
+{
+	for(bool compressed : {false, true})
+	{
+		const auto path = dir / (compressed ? "compressed.vsgm1" : "plain.vsgm1");
+		{
+			CSaveFile save(path, compressed);
+			save << numbers << text;
+		}
+		checkLoad(path);
+	}
+	BOOST_CHECK_LT(boost::filesystem::file_size(dir / "compressed.vsgm1"), boost::filesystem::file_size(dir / "plain.vsgm1") / 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(CLoadFile_LegacyFile, CSaveFileFixture)
+{
+	//uncompressed saves of older versions, written byte by byte so test doesn't depend on CSaveFile
+	const auto path = dir / "legacy.vsgm1";
+	{
+		boost::filesystem::ofstream file(path, std::ios::binary);
+		auto put = [&](ui32 value)
+		{
+			for(int i = 0; i < 4; i++)
+				file.put(char(value >> (8 * i))); //little endian
+		};
+		file << "VCMI";
+		put(SERIALIZATION_VERSION);
+		put(numbers.size());
+		for(si32 number : numbers)
+			put(number);
+		put(text.size());
+		file << text;
+	}
+	checkLoad(path);
+}
+
+BOOST_FIXTURE_TEST_CASE(CLoadFile_TruncatedCompressed, CSaveFileFixture)
+{
+	const auto path = dir / "truncated.vsgm1";
+	{
+		CSaveFile save(path, true);
+		save << numbers << text;
+	}
+	//zlib stream ends with 4 byte checksum, loading stops once all requested data is inflated so it is never read
+	//cutting few more bytes always loses data
+	const auto size = boost::filesystem::file_size(path);
+	for(auto truncatedSize : {size - 8, size / 2, uintmax_t(FILE_MAGIC.size() + 4)})
+	{
+		boost::filesystem::resize_file(path, truncatedSize);
+		std::vector<si32> loadedNumbers;
+		std::string loadedText;
+		BOOST_CHECK_THROW(CLoadFile(path) >> loadedNumbers >> loadedText, std::exception);
+	}
+}
+
+/// Graph of size of XL map gamestate
+struct CBinarySerializerBenchmarkFixture : public CBinarySerializerFixture
+{
+	CBinarySerializerBenchmarkFixture() : CBinarySerializerFixture(200000)
+	{
+	}
+};
+
+VCMI_BENCHMARK_FIXTURE_CASE(CBinarySerializer_Benchmark, CBinarySerializerBenchmarkFixture)
+{
+	const size_t references = nodes.size() * 5;
+
+	CMemorySerializer mem;
+	mem.oser & nodes;
+	const si64 saveTime = std::max<si64>(getDiff(), 1);
+
+	std::vector<SerializerTestNode *> loaded;
+	mem.iser & loaded;
+	const si64 loadTime = std::max<si64>(getDiff(), 1);
+
+	BOOST_CHECK_EQUAL(nodes.size(), loaded.size());
+	BOOST_TEST_MESSAGE(nodes.size() << " objects, " << references << " pointers: saved in " << saveTime << " ms ("
+		<< references * 1000 / saveTime << " pointers/s), loaded in " << loadTime << " ms ("
+		<< references * 1000 / loadTime << " pointers/s)");
+
+	for(auto node : loaded)
+		delete node;
+}
@@ -0,0 +1,119 @@
+/*
+ * CBonusSelectorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "CBenchmark.h"
+#include "../lib/HeroBonus.h"
+
+/// Bonus tree similar to the one of battle stack: stack inherits bonuses from its creature and hero
+struct CBonusSelectorFixture
+{
+	CBonusSystemNode creature;
+	CBonusSystemNode hero;
+	CBonusSystemNode stack;
+
+	CBonusSelectorFixture()
+	{
+		creature.setNodeType(CBonusSystemNode::CREATURE);
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::STACKS_SPEED, Bonus::CREATURE_ABILITY, 7, 0, 0, Bonus::BASE_NUMBER));
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::STACK_HEALTH, Bonus::CREATURE_ABILITY, 35, 0, 0, Bonus::BASE_NUMBER));
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::PRIMARY_SKILL, Bonus::CREATURE_ABILITY, 12, 0, PrimarySkill::ATTACK, Bonus::BASE_NUMBER));
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::PRIMARY_SKILL, Bonus::CREATURE_ABILITY, 10, 0, PrimarySkill::DEFENSE, Bonus::BASE_NUMBER));
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::FLYING, Bonus::CREATURE_ABILITY, 0, 0));
+		creature.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::SHOOTER, Bonus::CREATURE_ABILITY, 0, 0));
+
+		for(int i = 0; i < GameConstants::PRIMARY_SKILLS; i++)
+			hero.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::PRIMARY_SKILL, Bonus::HERO_BASE_SKILL, i + 1, 0, i));
+		for(int i = 0; i < 20; i++)
+			hero.addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::SECONDARY_SKILL_PREMY, Bonus::SECONDARY_SKILL, 5, i, i));
+
+		auto haste = std::make_shared<Bonus>(Bonus::N_TURNS, Bonus::STACKS_SPEED, Bonus::SPELL_EFFECT, 3, 53);
+		haste->turnsRemain = 2;
+		stack.addNewBonus(haste);
+		auto bless = std::make_shared<Bonus>(Bonus::N_TURNS, Bonus::ALWAYS_MAXIMUM_DAMAGE, Bonus::SPELL_EFFECT, 0, 41);
+		bless->turnsRemain = 1;
+		stack.addNewBonus(bless);
+
+		stack.attachTo(&creature);
+		stack.attachTo(&hero);
+	}
+};
+
+BOOST_FIXTURE_TEST_CASE(CBonusSelector_MatchesTypeErased, CBonusSelectorFixture)
+{
+	for(int turn = 0; turn < 4; turn++)
+	{
+		auto speed = Selector::type(Bonus::STACKS_SPEED).And(Selector::turns(turn));
+		BOOST_CHECK_EQUAL(stack.valOfBonuses(CSelector(speed)), stack.valOfBonuses(speed));
+
+		auto blessed = Selector::type(Bonus::ALWAYS_MAXIMUM_DAMAGE).And(Selector::turns(turn));
+		BOOST_CHECK_EQUAL(stack.hasBonus(CSelector(blessed)), stack.hasBonus(blessed));
+	}
+
+	auto attack = Selector::typeSubtype(Bonus::PRIMARY_SKILL, PrimarySkill::ATTACK);
+	BOOST_CHECK_EQUAL(13, stack.valOfBonuses(attack));
+	BOOST_CHECK_EQUAL(stack.valOfBonuses(CSelector(attack)), stack.valOfBonuses(attack));
+
+	auto ranged = Selector::type(Bonus::SHOOTER).Or(Selector::type(Bonus::FLYING));
+	BOOST_CHECK(stack.hasBonus(ranged));
+	BOOST_CHECK(!stack.hasBonus(Selector::source(Bonus::SPELL_EFFECT, 1)));
+}
+
+BOOST_AUTO_TEST_CASE(CBonusPool_ReusesMemory)
+{
+	const ui64 objects = CBonusPool::allocations();
+	const ui64 heapBlocks = CBonusPool::heapAllocations();
+
+	//same churn as in battle: bonuses created during round are freed at its end
+	const Bonus prototype(Bonus::ONE_BATTLE, Bonus::STACKS_SPEED, Bonus::SPELL_EFFECT, 3, 53);
+	for(int round = 0; round < 100; round++)
+	{
+		std::vector<std::shared_ptr<Bonus>> bonuses;
+		for(int i = 0; i < 100; i++)
+			bonuses.push_back(CBonusPool::makeBonus(prototype));
+		TBonusListPtr list = CBonusPool::makeList();
+		list->push_back(bonuses.front());
+	}
+
+	BOOST_CHECK_EQUAL(CBonusPool::allocations() - objects, 100 * 101);
+	//later rounds reuse memory freed by previous ones, pools only grow a few times
+	BOOST_CHECK_LT(CBonusPool::heapAllocations() - heapBlocks, 10);
+}
+
+VCMI_BENCHMARK_FIXTURE_CASE(CBonusSelector_Benchmark, CBonusSelectorFixture)
+{
+	const int iterations = 200000;
+	int erasedSum = 0, inlinedSum = 0;
+
+	for(int i = 0; i < iterations; i++)
+	{
+		const int turn = i % 3;
+		//selectors composed the way it was done before selector expressions, every And nests another std::function
+		erasedSum += stack.valOfBonuses(CSelector(Selector::type(Bonus::STACKS_SPEED)).And(Selector::turns(turn)));
+		erasedSum += stack.valOfBonuses(CSelector(Selector::type(Bonus::PRIMARY_SKILL)).And(Selector::subtype(PrimarySkill::ATTACK)));
+		erasedSum += stack.hasBonus(CSelector(Selector::type(Bonus::ALWAYS_MAXIMUM_DAMAGE)).And(Selector::turns(turn)));
+	}
+	const si64 erasedTime = getDiff();
+
+	for(int i = 0; i < iterations; i++)
+	{
+		const int turn = i % 3;
+		inlinedSum += stack.valOfBonuses(Selector::type(Bonus::STACKS_SPEED).And(Selector::turns(turn)));
+		inlinedSum += stack.valOfBonuses(Selector::typeSubtype(Bonus::PRIMARY_SKILL, PrimarySkill::ATTACK));
+		inlinedSum += stack.hasBonus(Selector::type(Bonus::ALWAYS_MAXIMUM_DAMAGE).And(Selector::turns(turn)));
+	}
+	const si64 inlinedTime = getDiff();
+
+	BOOST_CHECK_EQUAL(erasedSum, inlinedSum);
+	BOOST_TEST_MESSAGE("valOfBonuses loop, " << iterations << " iterations: "
+		<< erasedTime << " ms with type erased selectors, " << inlinedTime << " ms with selector expressions");
+}
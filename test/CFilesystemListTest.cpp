@@ -0,0 +1,86 @@
+/*
+ * CFilesystemListTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "../lib/filesystem/AdapterLoaders.h"
+#include "../lib/filesystem/CFilesystemLoader.h"
+#include "../lib/filesystem/CInputStream.h"
+
+/// Filesystem with few text files in temporary directory
+struct CFilesystemListFixture
+{
+	boost::filesystem::path dir;
+	CFilesystemList filesystem;
+
+	CFilesystemListFixture()
+		: dir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("vcmi-test-%%%%-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(dir);
+		for(auto name : {"a", "b", "c"})
+			boost::filesystem::ofstream(dir / (name + std::string(".txt"))) << "content of " << name;
+		filesystem.addLoader(new CFilesystemLoader("DATA/", dir), false);
+	}
+
+	~CFilesystemListFixture()
+	{
+		boost::system::error_code ec;
+		boost::filesystem::remove_all(dir, ec);
+	}
+
+	static ResourceID file(const std::string & name)
+	{
+		return ResourceID("DATA/" + name, EResType::TEXT);
+	}
+
+	/// after removal file can only be loaded if it is prefetched
+	void removeFiles()
+	{
+		for(auto name : {"a", "b", "c"})
+			boost::filesystem::remove(dir / (name + std::string(".txt")));
+	}
+
+	std::string read(const std::string & name)
+	{
+		auto data = filesystem.load(file(name))->readAll();
+		return std::string(reinterpret_cast<char *>(data.first.get()), data.second);
+	}
+};
+
+BOOST_FIXTURE_TEST_CASE(CFilesystemList_PrefetchedLoadedOnce, CFilesystemListFixture)
+{
+	auto handle = filesystem.prefetch({file("a"), file("b"), file("missing")});
+	removeFiles();
+
+	BOOST_CHECK_EQUAL(read("a"), "content of a");
+	BOOST_CHECK_EQUAL(read("b"), "content of b");
+	BOOST_CHECK_THROW(read("a"), std::exception); //taken from memory only once
+	BOOST_CHECK_THROW(read("c"), std::exception);
+}
+
+BOOST_FIXTURE_TEST_CASE(CFilesystemList_HandleDropsOwnResources, CFilesystemListFixture)
+{
+	auto first = filesystem.prefetch({file("a")});
+	auto second = filesystem.prefetch({file("a"), file("b"), file("c")}); //a is owned by first handle already
+	BOOST_CHECK_EQUAL(read("c"), "content of c");
+	removeFiles();
+
+	second.reset();
+	BOOST_CHECK_THROW(read("b"), std::exception);
+	BOOST_CHECK_EQUAL(read("a"), "content of a");
+}
+
+BOOST_FIXTURE_TEST_CASE(CFilesystemList_DroppedResourcesLoadedFromDisk, CFilesystemListFixture)
+{
+	filesystem.prefetch({file("a")}); //handle is destroyed right away
+	boost::filesystem::ofstream(dir / "a.txt") << "changed";
+	BOOST_CHECK_EQUAL(read("a"), "changed");
+}
@@ -0,0 +1,148 @@
+/*
+ * CHierarchicalPathfinderTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "../lib/CGameState.h"
+#include "../lib/CHierarchicalPathfinder.h"
+#include "../lib/CPathfinder.h"
+#include "../lib/CPlayerState.h"
+#include "../lib/mapping/CMap.h"
+#include "../lib/mapObjects/CGHeroInstance.h"
+
+namespace
+{
+
+class CTestGameInfo : public CGameInfoCallback
+{
+public:
+	CTestGameInfo(CGameState * gs) : CGameInfoCallback(gs, boost::optional<PlayerColor>())
+	{
+	}
+};
+
+/// Small grass map without objects and single hero with enough movement points to reach every tile in one turn
+class CPathfinderMap
+{
+public:
+	CGameState gs;
+	CGHeroInstance * hero;
+
+	CPathfinderMap(int size)
+	{
+		gs.map = new CMap();
+		gs.map->width = size;
+		gs.map->height = size;
+		gs.map->twoLevel = false;
+		gs.map->initTerrain();
+		for(int x = 0; x < size; x++)
+		{
+			for(int y = 0; y < size; y++)
+				gs.map->getTile(int3(x, y, 0)).terType = ETerrainType::GRASS;
+		}
+
+		PlayerState & player = gs.players[PlayerColor(0)];
+		player.color = PlayerColor(0);
+		player.team = TeamID(0);
+		TeamState & team = gs.teams[TeamID(0)];
+		team.id = TeamID(0);
+		team.players.insert(PlayerColor(0));
+		team.fogOfWarMap.resize(size, std::vector<std::vector<ui8>>(size, std::vector<ui8>(1, 1)));
+
+		hero = new CGHeroInstance();
+		hero->ID = Obj::HERO;
+		hero->tempOwner = PlayerColor(0);
+		hero->movement = 100000;
+		hero->id = ObjectInstanceID(gs.map->objects.size());
+		gs.map->objects.push_back(hero);
+	}
+
+	void setRock(const int3 & tile)
+	{
+		gs.map->getTile(tile).terType = ETerrainType::ROCK;
+	}
+
+	void check(const int3 & heroPos)
+	{
+		gs.map->initMovementInfo();
+		gs.map->calculateGuardingGreaturePositions();
+		hero->pos = heroPos + int3(1, 0, 0);
+
+		CPathsInfo paths(int3(gs.map->width, gs.map->height, 1));
+		gs.calculatePaths(hero, paths);
+		CTestGameInfo info(&gs);
+		CHierarchicalPathfinder graph(&info, PlayerColor(0));
+
+		int3 tile;
+		for(tile.x = 0; tile.x < gs.map->width; tile.x++)
+		{
+			for(tile.y = 0; tile.y < gs.map->height; tile.y++)
+			{
+				const CGPathNode node = paths.getPathInfo(tile);
+				const int estimation = graph.getDistance(heroPos, tile);
+				BOOST_CHECK_MESSAGE(node.reachable() == (estimation >= 0), "reachability differs on " << tile);
+				if(!node.reachable() || estimation < 0)
+					continue;
+
+				//estimation goes through region centers, so it may only be somewhat longer than exact path
+				const int cost = hero->movement - node.moveRemains;
+				BOOST_CHECK_MESSAGE(estimation >= cost * 9 / 10 && estimation <= cost * 2,
+					"distance to " << tile << " is " << estimation << " but pathfinder needs " << cost);
+			}
+		}
+	}
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(CHierarchicalPathfinder_OpenMap)
+{
+	CPathfinderMap map(CMapHeader::MAP_SIZE_SMALL);
+	map.check(int3(2, 2, 0));
+	map.check(int3(17, 30, 0));
+}
+
+BOOST_AUTO_TEST_CASE(CHierarchicalPathfinder_ClusterBorder)
+{
+	//wall along cluster border with single passage, both sides of passage are in different clusters
+	CPathfinderMap map(CMapHeader::MAP_SIZE_SMALL);
+	for(int y = 0; y < CMapHeader::MAP_SIZE_SMALL; y++)
+	{
+		if(y != 25)
+			map.setRock(int3(CHierarchicalPathfinder::CLUSTER_SIZE, y, 0));
+	}
+	map.check(int3(5, 5, 0));
+	map.check(int3(30, 3, 0));
+}
+
+BOOST_AUTO_TEST_CASE(CHierarchicalPathfinder_BlockedPortal)
+{
+	//passage between clusters is closed by rock so regions on the other side can't be reached at all
+	CPathfinderMap map(CMapHeader::MAP_SIZE_SMALL);
+	for(int y = 0; y < CMapHeader::MAP_SIZE_SMALL; y++)
+		map.setRock(int3(CHierarchicalPathfinder::CLUSTER_SIZE - 1, y, 0));
+	map.check(int3(5, 5, 0));
+}
+
+BOOST_AUTO_TEST_CASE(CHierarchicalPathfinder_CornerPassage)
+{
+	//only way to other clusters is diagonal step through tile in cluster corner
+	CPathfinderMap corner(CMapHeader::MAP_SIZE_SMALL);
+	for(int i = 0; i < CMapHeader::MAP_SIZE_SMALL; i++)
+	{
+		if(i != CHierarchicalPathfinder::CLUSTER_SIZE)
+		{
+			corner.setRock(int3(CHierarchicalPathfinder::CLUSTER_SIZE, i, 0));
+			corner.setRock(int3(i, CHierarchicalPathfinder::CLUSTER_SIZE, 0));
+		}
+	}
+	corner.check(int3(3, 3, 0));
+}
@@ -0,0 +1,164 @@
+/*
+ * CJsonValidatorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "CBenchmark.h"
+#include "../lib/JsonNode.h"
+#include "../lib/JsonDetail.h"
+#include "../lib/filesystem/ResourceID.h"
+
+/// All objects of core game configuration as they are written in config files, each with name of its schema
+/// Objects are not merged with H3 text data, so they are not complete and validation reports missing entries
+struct CJsonValidatorFixture
+{
+	struct Entry
+	{
+		std::string schema;
+		std::string name;
+		JsonNode data;
+	};
+	std::vector<Entry> entries;
+
+	CJsonValidatorFixture()
+	{
+		const JsonNode gameConfig(ResourceID("config/gameConfig.json"));
+
+		addEntries(gameConfig, "heroClasses", "heroClass");
+		addEntries(gameConfig, "artifacts", "artifact");
+		addEntries(gameConfig, "creatures", "creature");
+		addEntries(gameConfig, "factions", "faction");
+		addEntries(gameConfig, "objects", "object");
+		addEntries(gameConfig, "heroes", "hero");
+		addEntries(gameConfig, "spells", "spell");
+	}
+
+	void addEntries(const JsonNode & gameConfig, const std::string & type, const std::string & objectName)
+	{
+		for(auto & file : gameConfig[type].Vector())
+		{
+			JsonNode config(ResourceID(file.String()));
+			config.setMeta("core");
+			for(auto & object : config.Struct())
+				entries.push_back(Entry{"vcmi:" + objectName, object.first, object.second});
+		}
+	}
+
+	std::vector<std::string> checkAll()
+	{
+		std::vector<std::string> results;
+		for(auto & entry : entries)
+			results.push_back(Validation::check(entry.schema, entry.data));
+		return results;
+	}
+};
+
+BOOST_AUTO_TEST_CASE(CJsonValidator_Schema)
+{
+	//schema is kept alive for whole test run, compiled schemas are looked up by address of node
+	static const std::string schemaText = R"({
+		"type" : "object",
+		"required" : [ "name", "level" ],
+		"additionalProperties" : false,
+		"properties" : {
+			"name" : { "type" : "string", "minLength" : 1 },
+			"level" : { "type" : "number", "minimum" : 1, "maximum" : 7 },
+			"kind" : { "enum" : [ "melee", "ranged" ] },
+			"abilities" : { "type" : "array", "maxItems" : 2, "items" : { "type" : "string" } }
+		}
+	})";
+	static const JsonNode schema(schemaText.c_str(), schemaText.size());
+
+	auto check = [&](const std::string & dataText)
+	{
+		Validation::ValidationData validator;
+		validator.usedSchemas.push_back("vcmi:test");
+		return Validation::check(schema, JsonNode(dataText.c_str(), dataText.size()), validator);
+	};
+	auto reports = [](const std::string & errors, const std::string & message)
+	{
+		return errors.find(message) != std::string::npos;
+	};
+
+	//every check is done twice, second time with already compiled schema
+	for(int pass = 0; pass < 2; pass++)
+	{
+		BOOST_CHECK_EQUAL(check(R"({ "name" : "Pikeman", "level" : 1, "kind" : "melee", "abilities" : [ "shield" ] })"), "");
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman" })"), "Required entry level is missing"));
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman", "level" : 8 })"), "Value is bigger than 7"));
+		BOOST_CHECK(reports(check(R"({ "name" : "", "level" : 1 })"), "String is shorter than 1 symbols"));
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman", "level" : 1, "kind" : "flying" })"), "Key must have one of predefined values"));
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman", "level" : 1, "abilities" : [ "a", "b", "c" ] })"), "Length is bigger than 2"));
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman", "level" : 1, "abilities" : [ 1 ] })"), "Type mismatch"));
+		BOOST_CHECK(reports(check(R"({ "name" : "Pikeman", "level" : 1, "cost" : 10 })"), "Unknown entry found: cost"));
+		BOOST_CHECK(reports(check(R"([ "Pikeman" ])"), "Type mismatch"));
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(CJsonValidator_Threads, CJsonValidatorFixture)
+{
+	BOOST_REQUIRE(!entries.empty());
+
+	//several threads compile schemas and resolve references at once, results must match sequential validation
+	const int threadCount = 4;
+	std::vector<std::vector<std::string>> results(threadCount);
+	std::vector<boost::thread> threads;
+	for(int i = 0; i < threadCount; i++)
+		threads.push_back(boost::thread([&, i]()
+		{
+			results[i] = checkAll();
+		}));
+	for(auto & thread : threads)
+		thread.join();
+
+	const std::vector<std::string> expected = checkAll();
+	for(auto & result : results)
+		BOOST_CHECK(result == expected);
+}
+
+BOOST_AUTO_TEST_CASE(CJsonValidator_Errors)
+{
+	JsonNode creature;
+	creature["level"].Float() = 1;
+	creature["unknownField"].Bool() = true;
+
+	//missing faction and unknown field have to be reported
+	const std::string errors = Validation::check("vcmi:creature", creature);
+	BOOST_CHECK(errors.find("Required entry") != std::string::npos);
+	BOOST_CHECK(errors.find("unknownField") != std::string::npos);
+
+	//same node is reported in the same way every time
+	BOOST_CHECK_EQUAL(errors, Validation::check("vcmi:creature", creature));
+}
+
+VCMI_BENCHMARK_FIXTURE_CASE(CJsonValidator_Benchmark, CJsonValidatorFixture)
+{
+	BOOST_REQUIRE(!entries.empty());
+
+	//first pass compiles all schemas, later ones only run compiled validators
+	std::vector<std::string> firstPass;
+	for(auto & entry : entries)
+		firstPass.push_back(Validation::check(entry.schema, entry.data));
+	const si64 firstTime = getDiff();
+
+	const int passes = 10;
+	bool sameResults = true;
+	for(int pass = 0; pass < passes; pass++)
+	{
+		for(size_t i = 0; i < entries.size(); i++)
+			sameResults &= Validation::check(entries[i].schema, entries[i].data) == firstPass[i];
+	}
+	const si64 totalTime = getDiff();
+
+	BOOST_CHECK(sameResults);
+	BOOST_TEST_MESSAGE("Validation of " << entries.size() << " core objects: " << firstTime << " ms on first pass, "
+		<< totalTime / passes << " ms per pass afterwards");
+}
@@ -0,0 +1,153 @@
+/*
+ * CMapGeneratorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "CBenchmark.h"
+#include "MapComparer.h"
+#include "../lib/CRandomGenerator.h"
+#include "../lib/mapping/CMap.h"
+#include "../lib/rmg/CMapGenOptions.h"
+#include "../lib/rmg/CMapGenerator.h"
+#include "../lib/rmg/CRmgTemplate.h"
+
+static void setTestOptions(CMapGenOptions & opt)
+{
+	opt.setWidth(CMapHeader::MAP_SIZE_MIDDLE);
+	opt.setHeight(CMapHeader::MAP_SIZE_MIDDLE);
+	opt.setHasTwoLevels(false); //MapComparer checks surface only
+	opt.setPlayerCount(2);
+}
+
+/// template generator would choose for test options
+static const CRmgTemplate * getTestTemplate()
+{
+	CMapGenOptions opt;
+	setTestOptions(opt);
+	CRandomGenerator rand;
+	rand.setSeed(42);
+	opt.finalize(rand);
+	return opt.getMapTemplate();
+}
+
+/// generates map with fixed seed, zones are filled on given number of threads
+static std::unique_ptr<CMap> generateMap(int zoneFillThreads, const CRmgTemplate * mapTemplate = nullptr)
+{
+	CMapGenOptions opt;
+	setTestOptions(opt);
+	if(mapTemplate)
+		opt.setMapTemplate(mapTemplate);
+	CMapGenerator gen;
+	gen.setZoneFillThreads(zoneFillThreads);
+	auto map = gen.generate(&opt, 42);
+	BOOST_REQUIRE(gen.getError().empty());
+	return map;
+}
+
+static void checkSameObjects(const CMap * first, const CMap * second)
+{
+	BOOST_REQUIRE_EQUAL(first->objects.size(), second->objects.size());
+	for(size_t i = 0; i < first->objects.size(); i++)
+	{
+		BOOST_CHECK_EQUAL(first->objects[i]->ID, second->objects[i]->ID);
+		BOOST_CHECK_EQUAL(first->objects[i]->subID, second->objects[i]->subID);
+		BOOST_CHECK_EQUAL(first->objects[i]->pos, second->objects[i]->pos);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CMapGenerator_SameSeedSameMap)
+{
+	//template zones must not keep state of previous generation
+	auto first = generateMap(1);
+	auto second = generateMap(1);
+	checkSameObjects(first.get(), second.get());
+}
+
+BOOST_AUTO_TEST_CASE(CMapGenerator_SameSeedAndTemplateSameMap)
+{
+	//with template and seed given, everything down to terrain views and roads has to be the same
+	const CRmgTemplate * mapTemplate = getTestTemplate();
+	BOOST_REQUIRE(mapTemplate);
+	BOOST_TEST_MESSAGE("Using template " << mapTemplate->getName());
+
+	auto first = generateMap(1, mapTemplate);
+	auto second = generateMap(1, mapTemplate);
+	MapComparer compare;
+	compare(second, first);
+}
+
+BOOST_AUTO_TEST_CASE(CMapGenerator_ParallelFillSameSeedSameMap)
+{
+	//zones filled at the same time must not depend on each other, whichever thread is faster
+	auto first = generateMap(4);
+	for(int i = 0; i < 3; i++)
+	{
+		auto next = generateMap(4);
+		checkSameObjects(first.get(), next.get());
+	}
+}
+
+VCMI_BENCHMARK_CASE(CMapGenerator_Benchmark)
+{
+	struct Case
+	{
+		std::string templateName; //empty for template chosen by generator
+		si32 size;
+		bool twoLevel;
+		int seed;
+	};
+	const std::vector<Case> cases =
+	{
+		{"", CMapHeader::MAP_SIZE_MIDDLE, false, 1},
+		{"", CMapHeader::MAP_SIZE_LARGE, true, 2},
+		{"", CMapHeader::MAP_SIZE_XLARGE, true, 3},
+		{"Jebus Cross", CMapHeader::MAP_SIZE_XLARGE, false, 4}
+	};
+
+	std::map<std::string, si64> totalTimes;
+	for(auto & c : cases)
+	{
+		CMapGenOptions opt;
+		opt.setWidth(c.size);
+		opt.setHeight(c.size);
+		opt.setHasTwoLevels(c.twoLevel);
+		if(!c.templateName.empty())
+		{
+			auto & templates = opt.getAvailableTemplates();
+			auto it = templates.find(c.templateName);
+			if(it == templates.end())
+			{
+				BOOST_TEST_MESSAGE("Template " << c.templateName << " is not available, skipped");
+				continue;
+			}
+			opt.setMapTemplate(it->second);
+		}
+
+		CMapGenerator gen;
+		auto map = gen.generate(&opt, c.seed);
+		BOOST_REQUIRE(map);
+
+		std::ostringstream report;
+		report << opt.getMapTemplate()->getName() << ", " << c.size << "x" << c.size << (c.twoLevel ? "x2" : "") << ", seed " << c.seed << ":";
+		for(auto & phase : gen.getPhaseTimes())
+		{
+			report << " " << phase.first << " " << phase.second << " ms";
+			totalTimes[phase.first] += phase.second;
+		}
+		BOOST_TEST_MESSAGE(report.str());
+	}
+
+	std::ostringstream report;
+	report << "Total:";
+	for(auto & phase : totalTimes)
+		report << " " << phase.first << " " << phase.second << " ms";
+	BOOST_TEST_MESSAGE(report.str());
+}
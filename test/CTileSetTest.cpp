@@ -0,0 +1,214 @@
+/*
+ * CTileSetTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "CBenchmark.h"
+#include "../lib/CRandomGenerator.h"
+#include "../lib/rmg/CTileSet.h"
+
+/// CTileSet is replacement of std::set<int3>, every operation is done on both and results are compared
+struct CTileSetFixture
+{
+	CTileSet tiles;
+	std::set<int3> expected;
+	CRandomGenerator rand;
+
+	CTileSetFixture()
+	{
+		rand.setSeed(42);
+	}
+
+	int3 randomTile(int size)
+	{
+		return int3(rand.nextInt(size - 1), rand.nextInt(size - 1), rand.nextInt(1));
+	}
+
+	void insert(const int3 & tile)
+	{
+		tiles.insert(tile);
+		expected.insert(tile);
+	}
+
+	void erase(const int3 & tile)
+	{
+		BOOST_CHECK_EQUAL(tiles.erase(tile), expected.erase(tile) != 0);
+	}
+
+	void check()
+	{
+		BOOST_REQUIRE_EQUAL(tiles.size(), expected.size());
+		BOOST_CHECK_EQUAL(tiles.empty(), expected.empty());
+
+		//iteration order is z, y, x, same as int3::operator<
+		const std::vector<int3> forward(tiles.begin(), tiles.end());
+		BOOST_CHECK(forward == std::vector<int3>(expected.begin(), expected.end()));
+
+		std::vector<int3> reverse;
+		for(auto it = tiles.end(); it != tiles.begin();)
+			reverse.push_back(*--it);
+		BOOST_CHECK(reverse == std::vector<int3>(expected.rbegin(), expected.rend()));
+
+		for(auto & tile : expected)
+			BOOST_CHECK_MESSAGE(tiles.contains(tile), "tile " << tile << " is missing");
+	}
+};
+
+BOOST_FIXTURE_TEST_CASE(CTileSet_Empty, CTileSetFixture)
+{
+	check();
+	BOOST_CHECK(tiles.begin() == tiles.end());
+	BOOST_CHECK(!tiles.contains(int3(0, 0, 0)));
+	BOOST_CHECK(!tiles.erase(int3(0, 0, 0)));
+
+	insert(int3(5, 5, 0));
+	erase(int3(5, 5, 0));
+	check();
+	BOOST_CHECK(!tiles.contains(int3(5, 5, 0)));
+}
+
+BOOST_FIXTURE_TEST_CASE(CTileSet_RandomOperations, CTileSetFixture)
+{
+	//set starts in the middle of map and grows to all sides and to underground
+	insert(int3(36, 36, 0));
+	for(int i = 0; i < 5000; i++)
+	{
+		const int3 tile = randomTile(72);
+		if(rand.nextInt(2))
+			erase(tile);
+		else
+			insert(tile);
+		BOOST_CHECK_EQUAL(tiles.contains(tile), expected.count(tile) != 0);
+
+		if(i % 500 == 0)
+			check();
+	}
+	check();
+
+	for(auto tile : std::vector<int3>(expected.begin(), expected.end()))
+		erase(tile);
+	check();
+	BOOST_CHECK(tiles.begin() == tiles.end());
+}
+
+BOOST_FIXTURE_TEST_CASE(CTileSet_WordBoundaries, CTileSetFixture)
+{
+	//row of 64 tiles fills exactly one word, check tiles around every word border
+	insert(int3(0, 0, 0));
+	insert(int3(63, 3, 1));
+	for(auto tile : std::vector<int3>(expected.begin(), expected.end()))
+		erase(tile);
+
+	for(int z = 0; z < 2; z++)
+	{
+		for(int y = 0; y < 4; y++)
+		{
+			insert(int3(0, y, z));
+			insert(int3(62, y, z));
+			insert(int3(63, y, z));
+		}
+	}
+	check();
+
+	//only last bit of some words is left
+	for(int y = 0; y < 4; y++)
+	{
+		erase(int3(0, y, 0));
+		erase(int3(62, y, 0));
+	}
+	check();
+
+	//whole words are empty between tiles
+	for(int y = 1; y < 4; y++)
+		erase(int3(63, y, 0));
+	erase(int3(0, 0, 1));
+	check();
+}
+
+BOOST_FIXTURE_TEST_CASE(CTileSet_EraseIfAndUnion, CTileSetFixture)
+{
+	for(int i = 0; i < 1000; i++)
+		insert(randomTile(40));
+
+	tiles.eraseIf([](const int3 & tile){ return (tile.x + tile.y) % 3 == 0; });
+	vstd::erase_if(expected, [](const int3 & tile){ return (tile.x + tile.y) % 3 == 0; });
+	check();
+
+	//union of sets with same box is done on whole words, other boxes tile by tile
+	CTileSet sameBox = tiles;
+	sameBox.eraseIf([](const int3 & tile){ return true; });
+	sameBox.insert(int3(1, 2, 0));
+	tiles.insert(sameBox);
+	expected.insert(int3(1, 2, 0));
+	check();
+
+	CTileSet otherBox;
+	for(int i = 0; i < 100; i++)
+	{
+		const int3 tile = randomTile(60) + int3(30, 30, 0);
+		otherBox.insert(tile);
+		expected.insert(tile);
+	}
+	tiles.insert(otherBox);
+	check();
+
+	tiles.clear();
+	expected.clear();
+	check();
+}
+
+VCMI_BENCHMARK_FIXTURE_CASE(CTileSet_Benchmark, CTileSetFixture)
+{
+	//zone of XL map: tiles are added, walked through and removed again many times during fill
+	std::vector<int3> zone;
+	for(int i = 0; i < 4000; i++)
+		zone.push_back(randomTile(144));
+
+	const int passes = 200;
+	auto run = [&](std::function<size_t()> pass)
+	{
+		size_t result = 0;
+		for(int i = 0; i < passes; i++)
+			result += pass();
+		return result;
+	};
+
+	getDiff();
+	const size_t setResult = run([&]()
+	{
+		std::set<int3> set(zone.begin(), zone.end());
+		size_t sum = 0;
+		for(auto & tile : set)
+			sum += tile.x;
+		for(auto & tile : zone)
+			set.erase(tile);
+		return sum + set.size();
+	});
+	const si64 setTime = getDiff();
+
+	const size_t tileSetResult = run([&]()
+	{
+		CTileSet set;
+		for(auto & tile : zone)
+			set.insert(tile);
+		size_t sum = 0;
+		for(auto tile : set)
+			sum += tile.x;
+		for(auto & tile : zone)
+			set.erase(tile);
+		return sum + set.size();
+	});
+	const si64 tileSetTime = getDiff();
+
+	BOOST_CHECK_EQUAL(setResult, tileSetResult);
+	BOOST_TEST_MESSAGE(zone.size() << " tiles built, walked and erased " << passes << " times: std::set<int3> "
+		<< setTime << " ms, CTileSet " << tileSetTime << " ms");
+}
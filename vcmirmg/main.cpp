@@ -0,0 +1,463 @@
+/*
+ * main.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+/*
+ * Headless random map generator, generates batch of maps without client or server.
+ *
+ * Batch is described by json file, every combination of listed templates, sizes, player counts and seeds is generated:
+ * {
+ *	"templates" : [ "Jebus Cross" ],	// optional, template is chosen by generator if omitted
+ *	"sizes" : [ { "width" : 144, "height" : 144, "twoLevel" : true } ],	// optional, height defaults to width
+ *	"players" : [ 2, 4 ],	// optional, random count if omitted
+ *	"seeds" : [ { "from" : 1, "to" : 100 }, 500 ]
+ * }
+ *
+ * Every map is saved to output directory as <name>.vmap along with <name>.json report
+ * holding time spent in generation phases and peak memory used.
+ */
+
+#include "StdInc.h"
+
+#include "../lib/CConsoleHandler.h"
+#include "../lib/logging/CBasicLogConfigurator.h"
+#include "../lib/VCMIDirs.h"
+#include "../lib/VCMI_Lib.h"
+#include "../lib/CConfigHandler.h"
+#include "../lib/JsonNode.h"
+#include "../lib/filesystem/Filesystem.h"
+#include "../lib/filesystem/CMemoryBuffer.h"
+#include "../lib/mapping/CMap.h"
+#include "../lib/mapping/MapFormatJson.h"
+#include "../lib/rmg/CMapGenOptions.h"
+#include "../lib/rmg/CMapGenerator.h"
+#include "../lib/rmg/CRmgTemplate.h"
+
+#ifdef VCMI_WINDOWS
+	#include <windows.h>
+	#include <psapi.h>
+	#include <process.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+namespace po = boost::program_options;
+namespace bfs = boost::filesystem;
+
+/// one map of batch
+struct MapJob
+{
+	std::string templateName; //empty for template chosen by generator
+	si32 width;
+	si32 height;
+	bool twoLevel;
+	si8 players;
+	int seed;
+
+	/// unique name in batch, used for map and report files
+	std::string getName() const
+	{
+		std::string name = templateName.empty() ? "random" : templateName;
+		for(auto & c : name)
+		{
+			if(!std::isalnum(static_cast<unsigned char>(c)))
+				c = '_';
+		}
+		std::string playersName = players == CMapGenOptions::RANDOM_SIZE ? "random" : boost::lexical_cast<std::string>(static_cast<int>(players));
+		return boost::str(boost::format("%s_%dx%d%s_p%s_s%d") % name % width % height % (twoLevel ? "x2" : "") % playersName % seed);
+	}
+};
+
+/// returns all maps of batch, in the same order every time
+static std::vector<MapJob> readBatch(const bfs::path & specFile)
+{
+	bfs::ifstream file(specFile, std::ios::binary);
+	if(!file)
+		throw std::runtime_error("Can't open batch file " + specFile.string());
+	const std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	JsonNode spec(data.c_str(), data.size());
+
+	std::vector<std::string> templates;
+	for(auto & node : spec["templates"].Vector())
+		templates.push_back(node.String());
+	if(templates.empty())
+		templates.push_back("");
+
+	struct Size
+	{
+		si32 width, height;
+		bool twoLevel;
+	};
+	std::vector<Size> sizes;
+	for(auto & node : spec["sizes"].Vector())
+	{
+		Size size;
+		size.width = static_cast<si32>(node["width"].Float());
+		size.height = node["height"].isNull() ? size.width : static_cast<si32>(node["height"].Float());
+		size.twoLevel = node["twoLevel"].Bool();
+		if(size.width < 1 || size.height < 1)
+			throw std::runtime_error("Map size has to be positive");
+		sizes.push_back(size);
+	}
+	if(sizes.empty())
+		sizes.push_back(Size{CMapHeader::MAP_SIZE_MIDDLE, CMapHeader::MAP_SIZE_MIDDLE, false});
+
+	std::vector<si8> players;
+	for(auto & node : spec["players"].Vector())
+	{
+		int count = node.Float();
+		if(count < 1 || count > PlayerColor::PLAYER_LIMIT_I)
+			throw std::runtime_error(boost::str(boost::format("Player count %d is out of range") % count));
+		players.push_back(count);
+	}
+	if(players.empty())
+		players.push_back(CMapGenOptions::RANDOM_SIZE);
+
+	std::vector<int> seeds;
+	for(auto & node : spec["seeds"].Vector())
+	{
+		if(node.getType() == JsonNode::DATA_STRUCT)
+		{
+			const int to = node["to"].Float();
+			for(int seed = node["from"].Float(); seed <= to; seed++)
+				seeds.push_back(seed);
+		}
+		else
+			seeds.push_back(node.Float());
+	}
+	if(seeds.empty())
+		throw std::runtime_error("Batch has no seeds");
+
+	std::vector<MapJob> jobs;
+	for(auto & templateName : templates)
+	{
+		for(auto & size : sizes)
+		{
+			for(auto playerCount : players)
+			{
+				for(auto seed : seeds)
+					jobs.push_back(MapJob{templateName, size.width, size.height, size.twoLevel, playerCount, seed});
+			}
+		}
+	}
+	return jobs;
+}
+
+/// starts measuring peak memory of process over again, returns false if it is not supported (only Linux supports it)
+static bool resetPeakMemory()
+{
+#ifdef __linux__
+	bfs::ofstream clearRefs("/proc/self/clear_refs");
+	clearRefs << "5";
+	clearRefs.flush();
+	return clearRefs.good();
+#else
+	return false;
+#endif
+}
+
+/// peak resident memory of process in kB, since start or last reset
+static si64 getPeakMemory()
+{
+#ifdef VCMI_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters;
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	#ifdef __linux__
+	//unlike ru_maxrss, this one is affected by reset
+	bfs::ifstream status("/proc/self/status");
+	std::string line;
+	while(std::getline(status, line))
+	{
+		if(boost::starts_with(line, "VmHWM:"))
+			return boost::lexical_cast<si64>(boost::trim_copy(line.substr(6, line.size() - 6 - 2))); //"VmHWM: <value> kB"
+	}
+	#endif
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	#ifdef VCMI_APPLE
+	return usage.ru_maxrss / 1024; //in bytes
+	#else
+	return usage.ru_maxrss;
+	#endif
+#endif
+}
+
+/// generates and saves map and its report, returns false if generation failed
+static bool generateMap(const MapJob & job, const bfs::path & outputDir, int fillThreads)
+{
+	const std::string name = job.getName();
+	logGlobal->info("Generating map %s", name);
+
+	JsonNode report;
+	report["template"].String() = job.templateName;
+	report["width"].Float() = job.width;
+	report["height"].Float() = job.height;
+	report["twoLevel"].Bool() = job.twoLevel;
+	report["players"].Float() = job.players;
+	report["seed"].Float() = job.seed;
+	report["fillThreads"].Float() = fillThreads;
+
+	report["peakMemoryPerMap"].Bool() = resetPeakMemory();
+	std::string error;
+	try
+	{
+		CMapGenOptions opt;
+		opt.setWidth(job.width);
+		opt.setHeight(job.height);
+		opt.setHasTwoLevels(job.twoLevel);
+		opt.setPlayerCount(job.players);
+		if(!job.templateName.empty())
+		{
+			auto & templates = opt.getAvailableTemplates();
+			auto it = templates.find(job.templateName);
+			if(it == templates.end())
+				throw std::runtime_error("Template " + job.templateName + " is not available");
+			opt.setMapTemplate(it->second);
+		}
+
+		CMapGenerator gen;
+		gen.setZoneFillThreads(fillThreads);
+		auto start = boost::posix_time::microsec_clock::universal_time();
+		auto map = gen.generate(&opt, job.seed);
+		auto generated = boost::posix_time::microsec_clock::universal_time();
+
+		report["template"].String() = opt.getMapTemplate()->getName();
+		report["players"].Float() = opt.getPlayerCount();
+		for(auto & phase : gen.getPhaseTimes())
+			report["phases"][phase.first].Float() = phase.second;
+		report["generateTime"].Float() = (generated - start).total_milliseconds();
+		if(!gen.getError().empty())
+			throw std::runtime_error(gen.getError());
+		report["objects"].Float() = map->objects.size();
+
+		CMemoryBuffer buffer;
+		{
+			CMapSaverJson saver(&buffer);
+			saver.saveMap(map);
+		}
+		bfs::ofstream mapFile(outputDir / (name + ".vmap"), std::ios::binary);
+		mapFile.write(reinterpret_cast<const char *>(buffer.getBuffer().data()), buffer.getSize());
+		if(!mapFile)
+			throw std::runtime_error("Can't write map file");
+		report["saveTime"].Float() = (boost::posix_time::microsec_clock::universal_time() - generated).total_milliseconds();
+	}
+	catch(rmgException & e) //does not derive publicly from std::exception
+	{
+		error = e.what();
+	}
+	catch(std::exception & e)
+	{
+		error = e.what();
+	}
+	report["peakMemory"].Float() = getPeakMemory();
+
+	if(!error.empty())
+	{
+		logGlobal->error("Map %s failed: %s", name, error);
+		report["error"].String() = error;
+	}
+	bfs::ofstream reportFile(outputDir / (name + ".json"));
+	reportFile << report;
+	return error.empty();
+}
+
+/// runs every workerCount-th job of batch starting with worker-th one, one after another
+static int runWorker(const std::vector<MapJob> & jobs, const bfs::path & outputDir, int fillThreads, int worker, int workerCount)
+{
+	int failed = 0;
+	int generated = 0;
+	for(size_t i = worker; i < jobs.size(); i += workerCount)
+	{
+		if(!generateMap(jobs[i], outputDir, fillThreads))
+			failed++;
+		generated++;
+	}
+	logGlobal->info("Worker %d generated %d maps, %d failed", worker, generated, failed);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/// quotes argument of command line, so that started program gets it unchanged whatever characters it contains
+static std::string quoteArgument(const std::string & argument)
+{
+#ifdef VCMI_WINDOWS
+	//rules of CommandLineToArgvW: backslashes are literal unless they are followed by quote
+	std::string result = "\"";
+	size_t backslashes = 0;
+	for(char c : argument)
+	{
+		if(c == '\\')
+		{
+			backslashes++;
+			continue;
+		}
+		result.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+		result += c;
+		backslashes = 0;
+	}
+	result.append(backslashes * 2, '\\'); //closing quote follows
+	return result + "\"";
+#else
+	//nothing is special inside single quotes, quote itself is closed, escaped and opened again
+	return "'" + boost::replace_all_copy(argument, "'", "'\\''") + "'";
+#endif
+}
+
+/// full path of running program, argv[0] may be relative or miss extension and _spawnv doesn't search for program
+static std::string getExecutablePath(const std::string & argv0)
+{
+#ifdef VCMI_WINDOWS
+	std::vector<char> path(MAX_PATH);
+	for(;;)
+	{
+		const DWORD length = GetModuleFileNameA(nullptr, path.data(), path.size());
+		if(length == 0)
+			break;
+		if(length < path.size())
+			return std::string(path.data(), length);
+		path.resize(path.size() * 2); //path was truncated
+	}
+#elif defined(__linux__)
+	boost::system::error_code ec;
+	const bfs::path exe = bfs::read_symlink("/proc/self/exe", ec);
+	if(!ec)
+		return exe.string();
+#endif
+	//program started from PATH has no directory in argv[0] and shell finds it the same way again
+	const bfs::path started(argv0);
+	return started.has_parent_path() ? bfs::absolute(started).string() : argv0;
+}
+
+/// runs program with arguments and waits for it, returns its exit code (non-zero on failure)
+static int runProcess(const std::string & executable, const std::vector<std::string> & arguments)
+{
+	std::vector<std::string> quoted;
+	quoted.push_back(quoteArgument(executable));
+	for(auto & argument : arguments)
+		quoted.push_back(quoteArgument(argument));
+
+#ifdef VCMI_WINDOWS
+	//started directly, as cmd used by std::system expands variables even in quoted arguments
+	std::vector<const char *> argv;
+	for(auto & argument : quoted)
+		argv.push_back(argument.c_str());
+	argv.push_back(nullptr);
+	return _spawnv(_P_WAIT, executable.c_str(), argv.data());
+#else
+	return std::system(boost::algorithm::join(quoted, " ").c_str());
+#endif
+}
+
+/// runs batch in worker processes, which don't share (non thread safe) handlers nor memory usage
+static int runWorkerProcesses(const std::string & executable, const std::vector<std::string> & arguments, int workerCount)
+{
+	std::vector<int> results(workerCount);
+	boost::thread_group workers;
+	for(int i = 0; i < workerCount; i++)
+	{
+		std::vector<std::string> workerArguments = arguments;
+		workerArguments.push_back("--worker");
+		workerArguments.push_back(boost::lexical_cast<std::string>(i));
+		workerArguments.push_back("--worker-count");
+		workerArguments.push_back(boost::lexical_cast<std::string>(workerCount));
+		workers.create_thread([executable, workerArguments, i, &results]()
+		{
+			results[i] = runProcess(executable, workerArguments);
+		});
+	}
+	workers.join_all();
+
+	const int failedWorkers = boost::count_if(results, [](int result){ return result != 0; });
+	if(failedWorkers)
+		logGlobal->error("%d of %d workers failed", failedWorkers, workerCount);
+	return failedWorkers ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char ** argv)
+{
+	po::options_description opts("Allowed options");
+	opts.add_options()
+		("help,h", "display help and exit")
+		("spec,s", po::value<std::string>(), "json file describing batch of maps")
+		("output,o", po::value<std::string>()->default_value("."), "directory for generated maps and their reports")
+		("workers,j", po::value<int>()->default_value(boost::thread::hardware_concurrency()), "number of worker processes generating maps")
+		("fill-threads", po::value<int>()->default_value(1), "number of threads filling zones of single map")
+		("worker", po::value<int>(), "used internally, index of worker process")
+		("worker-count", po::value<int>(), "used internally, number of worker processes");
+
+	po::variables_map options;
+	try
+	{
+		po::store(po::parse_command_line(argc, argv, opts), options);
+		po::notify(options);
+	}
+	catch(std::exception & e)
+	{
+		std::cerr << "Failure during parsing command-line options:\n" << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if(options.count("help") || !options.count("spec"))
+	{
+		std::cout << "Usage: vcmirmg --spec <batch.json> [options]\n";
+		std::cout << opts;
+		return options.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	const bool isWorker = options.count("worker") > 0;
+	const std::string logName = isWorker ? boost::str(boost::format("VCMI_RMG_worker_%d_log.txt") % options["worker"].as<int>()) : "VCMI_RMG_log.txt"; //workers must not share log file
+	console = new CConsoleHandler;
+	CBasicLogConfigurator logConfig(VCMIDirs::get().userCachePath() / logName, console);
+	logConfig.configureDefault();
+
+	const std::string spec = options["spec"].as<std::string>();
+	const bfs::path outputDir = options["output"].as<std::string>();
+	const int worker = isWorker ? options["worker"].as<int>() : 0;
+	const int workerCount = std::max(1, isWorker ? (options.count("worker-count") ? options["worker-count"].as<int>() : 1) : options["workers"].as<int>());
+	const int fillThreads = std::max(1, options["fill-threads"].as<int>());
+
+	std::vector<MapJob> jobs;
+	try
+	{
+		jobs = readBatch(spec);
+		bfs::create_directories(outputDir);
+	}
+	catch(std::exception & e)
+	{
+		logGlobal->error(e.what());
+		return EXIT_FAILURE;
+	}
+
+	if(!isWorker && workerCount > 1)
+	{
+		logGlobal->info("Generating %d maps in %d worker processes", jobs.size(), workerCount);
+		const std::vector<std::string> arguments =
+		{
+			"--spec", spec,
+			"--output", outputDir.string(),
+			"--fill-threads", boost::lexical_cast<std::string>(fillThreads)
+		};
+		return runWorkerProcesses(getExecutablePath(argv[0]), arguments, std::min<int>(workerCount, jobs.size()));
+	}
+
+	preinitDLL(console);
+	settings.init();
+	logConfig.configure();
+	loadDLLClasses();
+
+	int result = runWorker(jobs, outputDir, fillThreads, worker, workerCount);
+
+	delete VLC;
+	VLC = nullptr;
+	CResourceHandler::clear();
+
+	return result;
+}